@@ -16,7 +16,16 @@
 #include "abcgApplication.hpp"
 #include "abcgException.hpp"
 #include "abcgExternal.hpp"
+#include "abcgFrameArena.hpp"
+#include "abcgGpuMemory.hpp"
+#include "abcgInput.hpp"
+#include "abcgJobSystem.hpp"
+#include "abcgLog.hpp"
+#include "abcgMetrics.hpp"
+#include "abcgProfiler.hpp"
+#include "abcgTrace.hpp"
 #include "abcgTrackball.hpp"
+#include "abcgTripleBuffer.hpp"
 #include "abcgUtil.hpp"
 #include "abcgWindow.hpp"
 
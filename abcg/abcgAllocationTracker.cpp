@@ -0,0 +1,384 @@
+/**
+ * @file abcgAllocationTracker.cpp
+ * @brief Definition of abcg::AllocationTracker members and of the replacement
+ * global allocation functions.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgAllocationTracker.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+#include "abcgExternal.hpp"
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <cxxabi.h>
+#include <dlfcn.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define ABCG_RETURN_ADDRESS() _ReturnAddress()
+#else
+#define ABCG_RETURN_ADDRESS() __builtin_return_address(0)
+#endif
+
+namespace {
+// Number of call-site samples kept
+constexpr std::size_t sampleCapacity{256};
+
+// Counters updated by the allocation functions. They must not allocate, and
+// must be usable before main, so they are all constant-initialized.
+struct GlobalCounters {
+  std::atomic<std::uint64_t> allocations{};
+  std::atomic<std::uint64_t> bytes{};
+  std::atomic<std::uint64_t> deallocations{};
+};
+
+struct SampleSlot {
+  std::atomic<void const *> callSite{};
+  std::atomic<std::size_t> size{};
+  std::atomic<std::uint64_t> frameIndex{};
+};
+
+GlobalCounters totals;
+thread_local abcg::AllocationStats threadTotals;
+// Value of threadTotals when the calling thread last called newFrame
+thread_local abcg::AllocationStats threadFrameStart;
+
+std::atomic<std::uint64_t> frameIndex{};
+// Only accessed by the thread that calls newFrame
+abcg::AllocationStats frameStart;
+abcg::AllocationStats lastFrame;
+
+std::array<SampleSlot, sampleCapacity> samples;
+std::atomic<std::uint64_t> sampleCount{};
+std::atomic<std::uint32_t> sampleInterval{16};
+
+abcg::AllocationStats difference(abcg::AllocationStats const &end,
+                                 abcg::AllocationStats const &start) noexcept {
+  return {.allocations = end.allocations - start.allocations,
+          .bytes = end.bytes - start.bytes,
+          .deallocations = end.deallocations - start.deallocations};
+}
+
+#if ABCG_ALLOCATION_TRACKING
+void recordAllocation(std::size_t size, void const *callSite) noexcept {
+  totals.allocations.fetch_add(1, std::memory_order_relaxed);
+  totals.bytes.fetch_add(size, std::memory_order_relaxed);
+  ++threadTotals.allocations;
+  threadTotals.bytes += size;
+
+  if (auto const interval{sampleInterval.load(std::memory_order_relaxed)};
+      interval > 0 && threadTotals.allocations % interval == 0) {
+    auto &slot{samples.at(sampleCount.fetch_add(1, std::memory_order_relaxed) %
+                          sampleCapacity)};
+    slot.callSite.store(callSite, std::memory_order_relaxed);
+    slot.size.store(size, std::memory_order_relaxed);
+    slot.frameIndex.store(frameIndex.load(std::memory_order_relaxed),
+                          std::memory_order_relaxed);
+  }
+}
+
+void recordDeallocation(void const *pointer) noexcept {
+  if (pointer == nullptr)
+    return;
+  totals.deallocations.fetch_add(1, std::memory_order_relaxed);
+  ++threadTotals.deallocations;
+}
+
+void *tryAllocate(std::size_t size, std::size_t alignment) noexcept {
+  size = std::max<std::size_t>(size, 1);
+  if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+    return std::malloc(size);
+#if defined(_MSC_VER)
+  return _aligned_malloc(size, alignment);
+#else
+  // The size must be a multiple of the alignment
+  return std::aligned_alloc(alignment,
+                            (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+// Follows the semantics of the default operator new: calls the new-handler
+// until the allocation succeeds, and throws std::bad_alloc if there is none
+void *allocate(std::size_t size, std::size_t alignment,
+               void const *callSite) {
+  recordAllocation(size, callSite);
+  while (true) {
+    if (auto *const pointer{tryAllocate(size, alignment)})
+      return pointer;
+    auto const handler{std::get_new_handler()};
+    if (handler == nullptr)
+      throw std::bad_alloc{};
+    handler();
+  }
+}
+
+void *allocateNoThrow(std::size_t size, std::size_t alignment,
+                      void const *callSite) noexcept {
+  try {
+    return allocate(size, alignment, callSite);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void deallocate(void *pointer, std::size_t alignment) noexcept {
+  recordDeallocation(pointer);
+#if defined(_MSC_VER)
+  if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+    _aligned_free(pointer);
+    return;
+  }
+#else
+  static_cast<void>(alignment);
+#endif
+  std::free(pointer);
+}
+#endif
+} // namespace
+
+#if ABCG_ALLOCATION_TRACKING
+// Replacement global allocation functions. The return address is taken here,
+// in the function called by the user code.
+
+void *operator new(std::size_t size) {
+  return allocate(size, 0, ABCG_RETURN_ADDRESS());
+}
+
+void *operator new[](std::size_t size) {
+  return allocate(size, 0, ABCG_RETURN_ADDRESS());
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+  return allocate(size, static_cast<std::size_t>(alignment),
+                  ABCG_RETURN_ADDRESS());
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+  return allocate(size, static_cast<std::size_t>(alignment),
+                  ABCG_RETURN_ADDRESS());
+}
+
+void *operator new(std::size_t size, std::nothrow_t const &) noexcept {
+  return allocateNoThrow(size, 0, ABCG_RETURN_ADDRESS());
+}
+
+void *operator new[](std::size_t size, std::nothrow_t const &) noexcept {
+  return allocateNoThrow(size, 0, ABCG_RETURN_ADDRESS());
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment,
+                   std::nothrow_t const &) noexcept {
+  return allocateNoThrow(size, static_cast<std::size_t>(alignment),
+                         ABCG_RETURN_ADDRESS());
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment,
+                     std::nothrow_t const &) noexcept {
+  return allocateNoThrow(size, static_cast<std::size_t>(alignment),
+                         ABCG_RETURN_ADDRESS());
+}
+
+void operator delete(void *pointer) noexcept { deallocate(pointer, 0); }
+
+void operator delete[](void *pointer) noexcept { deallocate(pointer, 0); }
+
+void operator delete(void *pointer, std::size_t) noexcept {
+  deallocate(pointer, 0);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept {
+  deallocate(pointer, 0);
+}
+
+void operator delete(void *pointer, std::align_val_t alignment) noexcept {
+  deallocate(pointer, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void *pointer, std::align_val_t alignment) noexcept {
+  deallocate(pointer, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *pointer, std::size_t,
+                     std::align_val_t alignment) noexcept {
+  deallocate(pointer, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void *pointer, std::size_t,
+                       std::align_val_t alignment) noexcept {
+  deallocate(pointer, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *pointer, std::nothrow_t const &) noexcept {
+  deallocate(pointer, 0);
+}
+
+void operator delete[](void *pointer, std::nothrow_t const &) noexcept {
+  deallocate(pointer, 0);
+}
+
+void operator delete(void *pointer, std::align_val_t alignment,
+                     std::nothrow_t const &) noexcept {
+  deallocate(pointer, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void *pointer, std::align_val_t alignment,
+                       std::nothrow_t const &) noexcept {
+  deallocate(pointer, static_cast<std::size_t>(alignment));
+}
+#endif
+
+/**
+ * @brief Starts a new frame.
+ *
+ * The allocations of all threads since the previous call become the
+ * statistics returned by abcg::AllocationTracker::getLastFrameStats, and the
+ * calling thread's frame statistics are reset.
+ *
+ * @remark This is called by abcg::Window at the start of each frame, on the
+ * main thread. The frame statistics must only be accessed from that thread.
+ */
+void abcg::AllocationTracker::newFrame() noexcept {
+  auto const total{getTotalStats()};
+  lastFrame = difference(total, frameStart);
+  frameStart = total;
+  threadFrameStart = threadTotals;
+  frameIndex.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Returns the number of frames started.
+ *
+ * @return Number of calls to abcg::AllocationTracker::newFrame.
+ */
+std::uint64_t abcg::AllocationTracker::getFrameIndex() noexcept {
+  return frameIndex.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Returns the allocations of all threads since the program started.
+ *
+ * @return Allocation statistics.
+ */
+abcg::AllocationStats abcg::AllocationTracker::getTotalStats() noexcept {
+  return {.allocations = totals.allocations.load(std::memory_order_relaxed),
+          .bytes = totals.bytes.load(std::memory_order_relaxed),
+          .deallocations =
+              totals.deallocations.load(std::memory_order_relaxed)};
+}
+
+/**
+ * @brief Returns the allocations of all threads since the current frame
+ * started.
+ *
+ * @return Allocation statistics.
+ */
+abcg::AllocationStats abcg::AllocationTracker::getFrameStats() noexcept {
+  return difference(getTotalStats(), frameStart);
+}
+
+/**
+ * @brief Returns the allocations of all threads during the last complete
+ * frame.
+ *
+ * @return Allocation statistics.
+ */
+abcg::AllocationStats abcg::AllocationTracker::getLastFrameStats() noexcept {
+  return lastFrame;
+}
+
+/**
+ * @brief Returns the allocations of the calling thread since it started.
+ *
+ * @return Allocation statistics.
+ */
+abcg::AllocationStats abcg::AllocationTracker::getThreadStats() noexcept {
+  return threadTotals;
+}
+
+/**
+ * @brief Returns the allocations of the calling thread since it last called
+ * abcg::AllocationTracker::newFrame.
+ *
+ * On the main thread, these are the allocations of the current frame made by
+ * the main thread only.
+ *
+ * @return Allocation statistics.
+ */
+abcg::AllocationStats
+abcg::AllocationTracker::getThreadFrameStats() noexcept {
+  return difference(threadTotals, threadFrameStart);
+}
+
+/**
+ * @brief Sets how often the call site of an allocation is sampled.
+ *
+ * @param interval Each thread samples one in every `interval` allocations.
+ * Use 1 to sample all allocations, or 0 to disable sampling. The default is
+ * 16.
+ */
+void abcg::AllocationTracker::setSampleInterval(
+    std::uint32_t interval) noexcept {
+  sampleInterval.store(interval, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Returns the most recent call-site samples.
+ *
+ * @return Up to 256 samples, from the oldest to the newest.
+ */
+std::vector<abcg::AllocationSample> abcg::AllocationTracker::getSamples() {
+  auto const count{sampleCount.load(std::memory_order_relaxed)};
+  auto const first{count > sampleCapacity ? count - sampleCapacity : 0};
+
+  std::vector<AllocationSample> result;
+  result.reserve(gsl::narrow<std::size_t>(count - first));
+  for (auto index{first}; index < count; ++index) {
+    auto const &slot{samples.at(index % sampleCapacity)};
+    result.push_back(
+        {.callSite = slot.callSite.load(std::memory_order_relaxed),
+         .size = slot.size.load(std::memory_order_relaxed),
+         .frameIndex = slot.frameIndex.load(std::memory_order_relaxed)});
+  }
+  return result;
+}
+
+/**
+ * @brief Returns a readable description of a call site.
+ *
+ * On Linux and macOS, the address is resolved to the name of the enclosing
+ * function, provided the symbol is exported (executables built with
+ * `enable_abcg` export their symbols when allocation tracking is enabled).
+ * Otherwise, the address is returned in hexadecimal.
+ *
+ * @param callSite Value of abcg::AllocationSample::callSite.
+ *
+ * @return Description of the call site.
+ */
+std::string abcg::AllocationTracker::describeCallSite(void const *callSite) {
+#if defined(__linux__) || defined(__APPLE__)
+  Dl_info info{};
+  if (dladdr(callSite, &info) != 0 && info.dli_sname != nullptr) {
+    auto status{0};
+    std::unique_ptr<char, decltype(&std::free)> const demangled{
+        abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status),
+        &std::free};
+    auto const offset{static_cast<char const *>(callSite) -
+                      static_cast<char const *>(info.dli_saddr)};
+    return fmt::format("{}+{:#x}",
+                       status == 0 ? demangled.get() : info.dli_sname, offset);
+  }
+#endif
+  return fmt::format("{}", callSite);
+}
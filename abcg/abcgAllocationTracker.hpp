@@ -0,0 +1,116 @@
+/**
+ * @file abcgAllocationTracker.hpp
+ * @brief Header file of abcg::AllocationTracker.
+ *
+ * Declaration of abcg::AllocationTracker, abcg::AllocationStats and
+ * abcg::AllocationSample.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_ALLOCATION_TRACKER_HPP_
+#define ABCG_ALLOCATION_TRACKER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Whether the global `operator new` and `operator delete` are replaced
+ * by versions that count heap allocations.
+ *
+ * Set with the `ABCG_ENABLE_ALLOCATION_TRACKING` CMake option. When 0,
+ * abcg::AllocationTracker reports no allocations.
+ */
+#if !defined(ABCG_ALLOCATION_TRACKING)
+#define ABCG_ALLOCATION_TRACKING 0
+#endif
+
+namespace abcg {
+class AllocationTracker;
+struct AllocationStats;
+struct AllocationSample;
+} // namespace abcg
+
+/**
+ * @brief Number of heap allocations and deallocations.
+ */
+struct abcg::AllocationStats {
+  /** @brief Number of calls to `operator new`. */
+  std::uint64_t allocations{};
+  /** @brief Number of bytes requested from `operator new`. */
+  std::uint64_t bytes{};
+  /** @brief Number of calls to `operator delete` with a non-null pointer. */
+  std::uint64_t deallocations{};
+};
+
+/**
+ * @brief Allocation recorded by the call-site sampler of
+ * abcg::AllocationTracker.
+ */
+struct abcg::AllocationSample {
+  /** @brief Return address of `operator new`, i.e., an address inside the
+   * function that requested the allocation. */
+  void const *callSite{};
+  /** @brief Number of bytes requested. */
+  std::size_t size{};
+  /** @brief Frame in which the allocation was made (see
+   * abcg::AllocationTracker::getFrameIndex). */
+  std::uint64_t frameIndex{};
+};
+
+/**
+ * @brief Counts heap allocations per frame and per thread.
+ *
+ * When ABCg is configured with `-DABCG_ENABLE_ALLOCATION_TRACKING=ON`, the
+ * global `operator new` and `operator delete` are replaced by versions that
+ * update the counters returned by this class, and record the call site of
+ * one in every abcg::AllocationTracker::setSampleInterval allocations.
+ *
+ * abcg::Window starts a new frame at the beginning of each frame, shows the
+ * allocations of the last frame in the FPS overlay, and provides
+ * abcg::Window::assertNoAllocationsThisFrame to catch allocations in frame
+ * paths that are expected to be allocation-free:
+ *
+ * @code
+ * void Window::onPaint() {
+ *   // ...
+ *   assertNoAllocationsThisFrame();
+ * }
+ * @endcode
+ *
+ * @remark Allocations made directly with the `malloc` family, e.g., by C
+ * libraries, are not counted.
+ */
+class abcg::AllocationTracker {
+public:
+  AllocationTracker() = delete;
+
+  /**
+   * @brief Returns whether allocations are tracked.
+   *
+   * @return True if ABCg was built with allocation tracking.
+   */
+  [[nodiscard]] static constexpr bool isEnabled() noexcept {
+    return ABCG_ALLOCATION_TRACKING != 0;
+  }
+
+  static void newFrame() noexcept;
+  [[nodiscard]] static std::uint64_t getFrameIndex() noexcept;
+
+  [[nodiscard]] static AllocationStats getTotalStats() noexcept;
+  [[nodiscard]] static AllocationStats getFrameStats() noexcept;
+  [[nodiscard]] static AllocationStats getLastFrameStats() noexcept;
+  [[nodiscard]] static AllocationStats getThreadStats() noexcept;
+  [[nodiscard]] static AllocationStats getThreadFrameStats() noexcept;
+
+  static void setSampleInterval(std::uint32_t interval) noexcept;
+  [[nodiscard]] static std::vector<AllocationSample> getSamples();
+  [[nodiscard]] static std::string describeCallSite(void const *callSite);
+};
+
+#endif
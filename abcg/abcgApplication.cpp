@@ -12,9 +12,16 @@
 
 #include <SDL_image.h>
 
+#include <memory>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
 #include <span>
+#include <string_view>
 
 #include "abcgException.hpp"
+#include "abcgLog.hpp"
 #include "abcgWindow.hpp"
 
 #if defined(__EMSCRIPTEN__)
@@ -44,8 +51,40 @@ void abcg::mainLoopCallback(void *userData) {
  * of which the last one is nullptr and the previous ones, if any, point to
  * null-terminated multibyte strings that represent the arguments passed to the
  * program from the execution environment.
+ *
+ * The following command-line arguments are recognized:
+ *
+ * - `--headless`: forces abcg::WindowSettings::headless to true.
+ * - `--benchmark`: runs the benchmark driver (see abcg::BenchmarkSettings).
+ * - `--benchmark-warmup=<frames>`: number of warm-up frames.
+ * - `--benchmark-frames=<frames>`: number of measured frames.
+ * - `--benchmark-dt=<seconds>`: simulated time step.
+ * - `--benchmark-output=<path>`: path of the CSV or JSON report.
+ * - `--startup-report`: prints the time spent in each startup phase (see
+ *   abcg::StartupProfiler).
+ * - `--startup-report=<path>`: writes the startup report to a file.
+ * - `--record=<path>`: records the input events of each frame (see
+ *   abcg::InputRecorder).
+ * - `--replay=<path>`: replays a recording instead of the live input (see
+ *   abcg::InputReplayer).
+ * - `--metrics=<path>`: exports snapshots of abcg::Metrics to a file or Unix
+ *   domain socket (see abcg::MetricsExporterSettings::path).
+ * - `--metrics-interval=<seconds>`: time between metrics snapshots.
+ * - `--trace=<path>`: captures a trace of the first frames (see abcg::Trace).
+ * - `--trace-frames=<frames>`: number of frames captured.
+ *
+ * Any of the `--benchmark-*` arguments also enables the benchmark driver,
+ * `--metrics-interval` also enables the metrics exporter, and
+ * `--trace-frames` also enables the trace capture.
+ * Unrecognized arguments are ignored, except those that start with
+ * `--benchmark`, `--metrics` or `--trace`, which are rejected.
+ *
+ * @throw abcg::RuntimeError if the value of a `--benchmark-*`,
+ * `--metrics-interval` or `--trace-frames` argument is invalid, if an
+ * argument that starts with `--benchmark`, `--metrics` or `--trace` is not
+ * recognized, or if both `--record` and `--replay` are given.
  */
-abcg::Application::Application([[maybe_unused]] int argc, char **argv) {
+abcg::Application::Application(int argc, char **argv) {
   // Get executable relative path
   std::string const argv_str{*std::span{&argv, 1}[0]};
 #if defined(WIN32)
@@ -61,48 +100,234 @@ abcg::Application::Application([[maybe_unused]] int argc, char **argv) {
 #endif
 
   abcg::Application::m_assetsPath = abcg::Application::m_basePath + "/assets/";
+
+  {
+    auto const phase{m_startupProfiler.measure("Job system")};
+    m_jobSystem = std::make_unique<JobSystem>();
+  }
+
+  // Parse command-line arguments
+  auto const invalidArgument{[](std::string_view arg) {
+    return abcg::RuntimeError(
+        fmt::format("Invalid value in command-line argument {}", arg));
+  }};
+  auto const unknownArgument{[](std::string_view arg) {
+    return abcg::RuntimeError(
+        fmt::format("Unknown command-line argument {}", arg));
+  }};
+  auto const parseInt{[&](std::string_view arg, std::string_view value) {
+    int result{};
+    auto const *const last{value.data() + value.size()};
+    if (auto const [ptr, ec]{std::from_chars(value.data(), last, result)};
+        ec != std::errc{} || ptr != last) {
+      throw invalidArgument(arg);
+    }
+    return result;
+  }};
+  auto const parseDouble{[&](std::string_view arg, std::string_view value) {
+    // value is a suffix of a null-terminated argument
+    char *last{};
+    auto const result{std::strtod(value.data(), &last)};
+    if (value.empty() || last != value.data() + value.size() || result <= 0.0) {
+      throw invalidArgument(arg);
+    }
+    return result;
+  }};
+
+  for (std::string_view const arg :
+       std::span{argv, gsl::narrow<std::size_t>(argc)}.subspan(1)) {
+    auto const valueOf{[&arg](std::string_view option) {
+      return arg.substr(option.size());
+    }};
+
+    if (arg == "--headless") {
+      m_headless = true;
+    } else if (arg == "--startup-report") {
+      m_startupReportPath = "";
+    } else if (arg.starts_with("--startup-report=")) {
+      m_startupReportPath = valueOf("--startup-report=");
+    } else if (arg.starts_with("--record=")) {
+      m_recordPath = valueOf("--record=");
+    } else if (arg.starts_with("--replay=")) {
+      m_replayPath = valueOf("--replay=");
+    } else if (arg == "--metrics" || arg.starts_with("--metrics=") ||
+               arg.starts_with("--metrics-interval=")) {
+      if (!m_metricsSettings.has_value()) {
+        m_metricsSettings.emplace();
+      }
+      if (arg.starts_with("--metrics=")) {
+        m_metricsSettings->path = valueOf("--metrics=");
+      } else if (arg.starts_with("--metrics-interval=")) {
+        m_metricsSettings->interval =
+            parseDouble(arg, valueOf("--metrics-interval="));
+      }
+    } else if (arg.starts_with("--metrics")) {
+      throw unknownArgument(arg);
+    } else if (arg == "--trace" || arg.starts_with("--trace=") ||
+               arg.starts_with("--trace-frames=")) {
+      if (!m_traceSettings.has_value()) {
+        m_traceSettings.emplace();
+      }
+      if (arg.starts_with("--trace=")) {
+        m_traceSettings->path = valueOf("--trace=");
+      } else if (arg.starts_with("--trace-frames=")) {
+        m_traceSettings->frames = parseInt(arg, valueOf("--trace-frames="));
+      }
+    } else if (arg.starts_with("--trace")) {
+      throw unknownArgument(arg);
+    } else if (arg == "--benchmark" ||
+               arg.starts_with("--benchmark-warmup=") ||
+               arg.starts_with("--benchmark-frames=") ||
+               arg.starts_with("--benchmark-dt=") ||
+               arg.starts_with("--benchmark-output=")) {
+      if (!m_benchmarkSettings.has_value()) {
+        m_benchmarkSettings.emplace();
+      }
+      auto &settings{*m_benchmarkSettings};
+      if (arg.starts_with("--benchmark-warmup=")) {
+        settings.warmupFrames = parseInt(arg, valueOf("--benchmark-warmup="));
+      } else if (arg.starts_with("--benchmark-frames=")) {
+        settings.frames = parseInt(arg, valueOf("--benchmark-frames="));
+      } else if (arg.starts_with("--benchmark-dt=")) {
+        settings.fixedDeltaTime = parseDouble(arg, valueOf("--benchmark-dt="));
+      } else if (arg.starts_with("--benchmark-output=")) {
+        settings.outputPath = valueOf("--benchmark-output=");
+      }
+    } else if (arg.starts_with("--benchmark")) {
+      throw unknownArgument(arg);
+    }
+  }
+
+  if (m_recordPath.has_value() && m_replayPath.has_value()) {
+    throw abcg::RuntimeError("--record and --replay cannot be used together");
+  }
 }
 
 /**
  * @brief Runs the application for the given window.
  *
- * Initializes the SDL library and its subsystems, initializes the window and
- * runs the event loop.
+ * Initializes the SDL video subsystem, initializes the window and runs the
+ * event loop. If abcg::WindowSettings::headless is set, SDL is initialized
+ * with the "offscreen" video driver. Other SDL subsystems are initialized on
+ * request with abcg::Application::initSubsystems, and the SDL_image codecs
+ * are initialized when the first image is loaded.
+ *
+ * In benchmark mode, the event loop runs for a fixed number of frames with a
+ * fixed simulated time step, and the frame times are written to the report
+ * file given by abcg::BenchmarkSettings::outputPath.
+ *
+ * With `--record`, the input events and time step of each frame are written
+ * to a file. With `--replay`, the live input is ignored and the recorded
+ * frames are replayed with their time steps; the application quits after the
+ * last frame. With `--metrics`, snapshots of abcg::Metrics are exported
+ * periodically until the window is destroyed. With `--trace`, a trace of the
+ * window creation and the first frames is captured (see abcg::Trace).
  *
  * @param window L-value reference to the window object.
  *
  * @throw abcg::SDLError if `SDL_Init` failed.
- * @throw abcg::SDLImageError if `IMG_Init` failed.
+ * @throw abcg::RuntimeError if the benchmark or startup report, the input
+ * recording or the metrics cannot be written, or if the input recording
+ * cannot be read.
  */
 void abcg::Application::run(Window &window) {
-  if (Uint32 const subsystemMask{SDL_INIT_VIDEO | SDL_INIT_AUDIO |
-                                 SDL_INIT_GAMECONTROLLER};
-      SDL_Init(subsystemMask) != 0) {
-    throw abcg::SDLError("SDL_Init failed");
+#if !defined(__EMSCRIPTEN__)
+  if (m_headless) {
+    window.m_windowSettings.headless = true;
   }
 
-#if !defined(__EMSCRIPTEN__)
-  // Load support for JPEG and PNG image formats
-  auto const imageFlags{IMG_INIT_JPG | IMG_INIT_PNG};
-  if (auto const initialized{IMG_Init(imageFlags)};
-      (initialized & imageFlags) != imageFlags) {
-    throw abcg::SDLImageError("IMG_Init failed");
+  if (window.getWindowSettings().headless) {
+    // Use the EGL-based offscreen video driver so that no display server is
+    // required
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
   }
 #endif
 
+  {
+    auto const phase{m_startupProfiler.measure("SDL_Init")};
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+      throw abcg::SDLError("SDL_Init failed");
+    }
+  }
+
+  Profiler::setThreadName("Main");
+
   m_window = &window;
-  m_window->templateCreate();
+  m_window->m_jobSystem = m_jobSystem.get();
+  m_window->m_startupProfiler = &m_startupProfiler;
+
+#if !defined(__EMSCRIPTEN__)
+  // The fixed time step must be set before creating the window, as it
+  // disables threaded updates
+  std::optional<Benchmark> benchmark;
+  if (m_benchmarkSettings.has_value()) {
+    benchmark.emplace(*m_benchmarkSettings);
+    m_window->m_fixedDeltaTime = benchmark->getSettings().fixedDeltaTime;
+  }
+
+  if (m_metricsSettings.has_value()) {
+    m_metricsExporter = std::make_unique<MetricsExporter>(*m_metricsSettings);
+  }
+#endif
+
+  if (m_recordPath.has_value()) {
+    m_inputRecorder = std::make_unique<InputRecorder>(*m_recordPath);
+    // The recorded time steps must be those of the update calls, which differ
+    // from the frame time steps with threaded updates
+    m_window->m_forceSynchronousUpdate = true;
+  }
+  if (m_replayPath.has_value()) {
+    m_inputReplayer = std::make_unique<InputReplayer>(*m_replayPath);
+    // Replaced by the recorded time step of each frame
+    m_window->m_fixedDeltaTime = 0.0;
+  }
+
+  // Started before the window is created to capture the resources loaded
+  // by the creation handlers
+  if (m_traceSettings.has_value()) {
+    Trace::start(m_traceSettings->path, m_traceSettings->frames);
+  }
+
+  {
+    auto const phase{m_startupProfiler.measure("Window creation")};
+    m_window->templateCreate();
+  }
 
 #if defined(__EMSCRIPTEN__)
   emscripten_set_main_loop_arg(mainLoopCallback, this, 0, true);
 #else
+
   auto done{false};
   while (!done) {
-    mainLoopIterator(done);
+    if (!m_startupProfiler.isFinished()) {
+      {
+        auto const phase{m_startupProfiler.measure("First frame")};
+        mainLoopIterator(done);
+      }
+      m_startupProfiler.finish();
+      writeStartupReport();
+    } else {
+      mainLoopIterator(done);
+    }
+    if (benchmark.has_value()) {
+      benchmark->recordFrame(m_window->getFrameTimes());
+      done = done || benchmark->isFinished();
+    }
+  }
+
+  if (benchmark.has_value()) {
+    benchmark->writeReport();
+    abcg::Log::info("Benchmark report written to {}",
+                    benchmark->getSettings().outputPath);
   }
 #endif
 
   m_window->templateDestroy();
+  // Writes the final snapshot
+  m_metricsExporter.reset();
+  // Writes a capture that is still running
+  Trace::stop();
+  abcg::Log::flush();
 
 #if !defined(__EMSCRIPTEN__)
   IMG_Quit();
@@ -110,6 +335,52 @@ void abcg::Application::run(Window &window) {
   SDL_Quit();
 }
 
+/**
+ * @brief Initializes SDL subsystems that are not initialized by default.
+ *
+ * Only the video and events subsystems are initialized by
+ * abcg::Application::run. Call this function, for instance in
+ * abcg::OpenGLWindow::onCreate, to initialize other subsystems such as
+ * `SDL_INIT_AUDIO` or `SDL_INIT_GAMECONTROLLER`. Subsystems that are already
+ * initialized are left untouched.
+ *
+ * Gamepad navigation in Dear ImGui is enabled when `SDL_INIT_GAMECONTROLLER`
+ * is initialized.
+ *
+ * @param flags Bitwise OR of `SDL_INIT_*` flags.
+ *
+ * @throw abcg::SDLError if `SDL_InitSubSystem` failed.
+ */
+void abcg::Application::initSubsystems(Uint32 flags) {
+  if (auto const missing{flags & ~SDL_WasInit(flags)};
+      missing != 0 && SDL_InitSubSystem(missing) != 0) {
+    throw abcg::SDLError("SDL_InitSubSystem failed");
+  }
+  if ((flags & SDL_INIT_GAMECONTROLLER) != 0U &&
+      ImGui::GetCurrentContext() != nullptr) {
+    ImGui::GetIO().ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;
+  }
+}
+
+// Prints the startup report or writes it to a file, if requested
+void abcg::Application::writeStartupReport() const {
+  if (!m_startupReportPath.has_value())
+    return;
+
+  if (m_startupReportPath->empty()) {
+    m_startupProfiler.writeReport(stdout);
+    return;
+  }
+
+  std::unique_ptr<std::FILE, decltype(&std::fclose)> const file{
+      std::fopen(m_startupReportPath->c_str(), "w"), &std::fclose};
+  if (!file) {
+    throw abcg::RuntimeError(fmt::format(
+        "Failed to open startup report file {}", *m_startupReportPath));
+  }
+  m_startupProfiler.writeReport(file.get());
+}
+
 /**
  * @brief Returns the path to the application's assets directory, relative to
  * the directory the executable is launched from.
@@ -146,13 +417,81 @@ std::string const &abcg::Application::getBasePath() noexcept {
 }
 
 void abcg::Application::mainLoopIterator([[maybe_unused]] bool &done) const {
+  Profiler::newFrame();
+  Trace::newFrame();
+  ABCG_PROFILE_SCOPE("mainLoopIterator");
   SDL_Event event{};
-  while (SDL_PollEvent(&event) != 0) {
+
 #if !defined(__EMSCRIPTEN__)
-    if (event.type == SDL_QUIT)
-      done = true;
+  // Sleep until an event arrives if the window is idle (see
+  // abcg::RenderPolicy)
+  if (auto const timeout{gsl::narrow<int>(m_window->getIdleTimeout())};
+      timeout > 0 && SDL_WaitEventTimeout(&event, timeout) != 0) {
+    dispatchEvent(event, done);
+  }
 #endif
-    m_window->templateHandleEvent(event, done);
+
+  {
+    ABCG_PROFILE_SCOPE("Events");
+    Timer eventsTimer;
+    while (SDL_PollEvent(&event) != 0) {
+      dispatchEvent(event, done);
+    }
+    if (m_inputReplayer) {
+      replayFrame(done);
+      if (done)
+        return;
+    }
+    m_window->addFramePhaseTime(FramePhase::Events, eventsTimer.elapsed());
   }
+
+  if (!m_window->isRedrawPending())
+    return;
+
+#if !defined(__EMSCRIPTEN__)
+  m_window->waitForNextFrame();
+#endif
   m_window->templatePaint();
+
+  if (m_inputRecorder) {
+    m_inputRecorder->endFrame(m_window->getDeltaTime());
+  }
+}
+
+void abcg::Application::dispatchEvent(SDL_Event &event,
+                                      [[maybe_unused]] bool &done) const {
+  if (m_window->getWindowSettings().coalesceInputEvents) {
+    coalesceInputEvent(event);
+  }
+
+  if (InputRecorder::isRecordable(event)) {
+    // Live input is ignored while replaying
+    if (m_inputReplayer)
+      return;
+    if (m_inputRecorder) {
+      m_inputRecorder->recordEvent(event);
+    }
+  }
+
+#if !defined(__EMSCRIPTEN__)
+  if (event.type == SDL_QUIT)
+    done = true;
+#endif
+  m_window->templateHandleEvent(event, done);
+}
+
+// Dispatches the recorded events of the next frame and forces the frame to
+// be painted with its recorded time step
+void abcg::Application::replayFrame(bool &done) const {
+  if (!m_inputReplayer->nextFrame()) {
+    done = true;
+    return;
+  }
+
+  for (auto const &event : m_inputReplayer->getEvents()) {
+    m_window->templateHandleEvent(event, done);
+  }
+  m_window->m_fixedDeltaTime = m_inputReplayer->getDeltaTime();
+  m_window->m_pendingRedrawFrames =
+      std::max(m_window->m_pendingRedrawFrames, 1);
 }
@@ -11,8 +11,17 @@
 #ifndef ABCG_APPLICATION_HPP_
 #define ABCG_APPLICATION_HPP_
 
+#include <memory>
+#include <optional>
 #include <string>
 
+#include "abcgBenchmark.hpp"
+#include "abcgInputRecorder.hpp"
+#include "abcgJobSystem.hpp"
+#include "abcgMetrics.hpp"
+#include "abcgStartupProfiler.hpp"
+#include "abcgTrace.hpp"
+
 #define ABCG_VERSION_MAJOR 3
 #define ABCG_VERSION_MINOR 1
 #define ABCG_VERSION_PATCH 1
@@ -40,14 +49,36 @@ public:
 
   void run(Window &window);
 
+  static void initSubsystems(Uint32 flags);
+
   static std::string const &getAssetsPath() noexcept;
   static std::string const &getBasePath() noexcept;
 
 private:
   void mainLoopIterator(bool &done) const;
+  void dispatchEvent(SDL_Event &event, bool &done) const;
+  void writeStartupReport() const;
+  void replayFrame(bool &done) const;
+
+  // Constructed first to include the rest of the startup in the report
+  StartupProfiler m_startupProfiler;
+  // Empty to print to stdout
+  std::optional<std::string> m_startupReportPath;
 
   Window *m_window{};
 
+  std::optional<BenchmarkSettings> m_benchmarkSettings;
+  bool m_headless{};
+  std::optional<std::string> m_recordPath;
+  std::optional<std::string> m_replayPath;
+  std::unique_ptr<InputRecorder> m_inputRecorder;
+  std::unique_ptr<InputReplayer> m_inputReplayer;
+  std::optional<MetricsExporterSettings> m_metricsSettings;
+  std::unique_ptr<MetricsExporter> m_metricsExporter;
+  std::optional<TraceSettings> m_traceSettings;
+
+  std::unique_ptr<JobSystem> m_jobSystem;
+
 #if defined(__EMSCRIPTEN__)
   friend void mainLoopCallback(void *userData);
 #endif
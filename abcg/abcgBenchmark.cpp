@@ -0,0 +1,119 @@
+/**
+ * @file abcgBenchmark.cpp
+ * @brief Definition of abcg::Benchmark members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgBenchmark.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "abcgException.hpp"
+
+/**
+ * @brief Constructs a benchmark with the given settings.
+ *
+ * @param settings Benchmark settings.
+ */
+abcg::Benchmark::Benchmark(BenchmarkSettings settings)
+    : m_settings(std::move(settings)) {
+  m_settings.warmupFrames = std::max(m_settings.warmupFrames, 0);
+  m_settings.frames = std::max(m_settings.frames, 1);
+  m_frames.reserve(gsl::narrow<std::size_t>(m_settings.frames));
+}
+
+/**
+ * @brief Records the times of a frame.
+ *
+ * Frames rendered during the warm-up period are counted but not stored.
+ *
+ * @param frameTimes CPU times of the last frame.
+ */
+void abcg::Benchmark::recordFrame(FrameTimes const &frameTimes) {
+  if (isFinished())
+    return;
+
+  if (m_frameCount++ >= m_settings.warmupFrames) {
+    m_frames.push_back(frameTimes);
+  }
+}
+
+/**
+ * @brief Returns whether all measured frames have been recorded.
+ *
+ * @return True if the benchmark is finished; false otherwise.
+ */
+bool abcg::Benchmark::isFinished() const noexcept {
+  return m_frameCount >= m_settings.warmupFrames + m_settings.frames;
+}
+
+/**
+ * @brief Returns the benchmark settings.
+ *
+ * @return Reference to the benchmark settings.
+ */
+abcg::BenchmarkSettings const &abcg::Benchmark::getSettings() const noexcept {
+  return m_settings;
+}
+
+/**
+ * @brief Writes the recorded frame times to the output file.
+ *
+ * The format is JSON if abcg::BenchmarkSettings::outputPath ends with `.json`,
+ * and CSV otherwise. Times are written in milliseconds.
+ *
+ * @throw abcg::RuntimeError if the output file cannot be opened.
+ */
+void abcg::Benchmark::writeReport() const {
+  auto const &path{m_settings.outputPath};
+  std::unique_ptr<std::FILE, decltype(&std::fclose)> const file{
+      std::fopen(path.c_str(), "w"), &std::fclose};
+  if (!file) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to open benchmark output file {}", path));
+  }
+
+  if (path.ends_with(".json")) {
+    writeJSON(file.get());
+  } else {
+    writeCSV(file.get());
+  }
+}
+
+void abcg::Benchmark::writeCSV(std::FILE *file) const {
+  fmt::print(file, "frame,events_ms,update_ms,ui_ms,paint_ms,swap_ms,"
+                   "total_ms\n");
+  for (auto const index : iter::range(m_frames.size())) {
+    auto const &frame{m_frames.at(index)};
+    fmt::print(file, "{},{:.4f},{:.4f},{:.4f},{:.4f},{:.4f},{:.4f}\n", index,
+               frame.events * 1000.0, frame.update * 1000.0,
+               frame.ui * 1000.0, frame.paint * 1000.0, frame.swap * 1000.0,
+               frame.total * 1000.0);
+  }
+}
+
+void abcg::Benchmark::writeJSON(std::FILE *file) const {
+  fmt::print(file,
+             "{{\n  \"warmupFrames\": {},\n  \"frames\": {},\n"
+             "  \"fixedDeltaTime\": {},\n  \"samples\": [\n",
+             m_settings.warmupFrames, m_settings.frames,
+             m_settings.fixedDeltaTime);
+  for (auto const index : iter::range(m_frames.size())) {
+    auto const &frame{m_frames.at(index)};
+    fmt::print(file,
+               "    {{\"frame\": {}, \"events_ms\": {:.4f}, "
+               "\"update_ms\": {:.4f}, \"ui_ms\": {:.4f}, "
+               "\"paint_ms\": {:.4f}, \"swap_ms\": {:.4f}, "
+               "\"total_ms\": {:.4f}}}{}\n",
+               index, frame.events * 1000.0, frame.update * 1000.0,
+               frame.ui * 1000.0, frame.paint * 1000.0, frame.swap * 1000.0,
+               frame.total * 1000.0, index + 1 < m_frames.size() ? "," : "");
+  }
+  fmt::print(file, "  ]\n}}\n");
+}
@@ -0,0 +1,74 @@
+/**
+ * @file abcgBenchmark.hpp
+ * @brief Header file of abcg::Benchmark.
+ *
+ * Declaration of abcg::Benchmark and abcg::BenchmarkSettings.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_BENCHMARK_HPP_
+#define ABCG_BENCHMARK_HPP_
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "abcgWindow.hpp"
+
+namespace abcg {
+struct BenchmarkSettings;
+class Benchmark;
+} // namespace abcg
+
+/**
+ * @brief Settings of the benchmark driver.
+ *
+ * The benchmark driver is enabled with the `--benchmark` command-line
+ * argument. The other fields can be set with the arguments
+ * `--benchmark-warmup=<frames>`, `--benchmark-frames=<frames>`,
+ * `--benchmark-dt=<seconds>` and `--benchmark-output=<path>`.
+ *
+ * @sa abcg::Application::Application.
+ */
+struct abcg::BenchmarkSettings {
+  /** @brief Number of frames rendered before measurements start. */
+  int warmupFrames{60};
+  /** @brief Number of measured frames. */
+  int frames{600};
+  /** @brief Simulated time step, in seconds, returned by
+   * abcg::Window::getDeltaTime. */
+  double fixedDeltaTime{1.0 / 60.0};
+  /** @brief Path of the report file. The report is written in JSON if the
+   * path ends with `.json`, and in CSV otherwise. */
+  std::string outputPath{"benchmark.csv"};
+};
+
+/**
+ * @brief Collects per-frame CPU times of a benchmark run.
+ *
+ * @sa abcg::BenchmarkSettings.
+ */
+class abcg::Benchmark {
+public:
+  explicit Benchmark(BenchmarkSettings settings);
+
+  void recordFrame(FrameTimes const &frameTimes);
+  [[nodiscard]] bool isFinished() const noexcept;
+  [[nodiscard]] BenchmarkSettings const &getSettings() const noexcept;
+
+  void writeReport() const;
+
+private:
+  void writeCSV(std::FILE *file) const;
+  void writeJSON(std::FILE *file) const;
+
+  BenchmarkSettings m_settings;
+  std::vector<FrameTimes> m_frames;
+  int m_frameCount{};
+};
+
+#endif
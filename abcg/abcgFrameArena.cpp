@@ -0,0 +1,128 @@
+/**
+ * @file abcgFrameArena.cpp
+ * @brief Definition of abcg::FrameArena members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgFrameArena.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+namespace {
+constexpr std::size_t blockAlignment{alignof(std::max_align_t)};
+} // namespace
+
+/**
+ * @brief Constructs an arena with a block of the given size.
+ *
+ * @param initialSize Size in bytes of the first block.
+ * @param upstream Memory resource used to allocate the blocks.
+ */
+abcg::FrameArena::FrameArena(std::size_t initialSize,
+                             std::pmr::memory_resource *upstream)
+    : m_upstream(upstream) {
+  addBlock(initialSize);
+}
+
+/**
+ * @brief Destroys the arena and releases its blocks to the upstream resource.
+ */
+abcg::FrameArena::~FrameArena() { releaseBlocks(); }
+
+/**
+ * @brief Releases all memory allocated from the arena.
+ *
+ * If the last frame needed more than one block, the blocks are merged into a
+ * single block that can hold all the memory used in that frame.
+ */
+void abcg::FrameArena::reset() {
+  if (m_blocks.size() > 1) {
+    auto const totalSize{getCapacity()};
+    releaseBlocks();
+    addBlock(std::bit_ceil(totalSize));
+  }
+  m_offset = 0;
+  m_usedInFullBlocks = 0;
+}
+
+/**
+ * @brief Returns the number of bytes allocated since the last reset.
+ *
+ * @return Number of bytes, including alignment padding.
+ */
+std::size_t abcg::FrameArena::getBytesUsed() const noexcept {
+  return m_usedInFullBlocks + m_offset;
+}
+
+/**
+ * @brief Returns the largest number of bytes allocated between two resets.
+ *
+ * @return Number of bytes, including alignment padding.
+ */
+std::size_t abcg::FrameArena::getPeakBytesUsed() const noexcept {
+  return m_peakBytesUsed;
+}
+
+/**
+ * @brief Returns the total size of the blocks owned by the arena.
+ *
+ * @return Size in bytes.
+ */
+std::size_t abcg::FrameArena::getCapacity() const noexcept {
+  std::size_t capacity{};
+  for (auto const &block : m_blocks) {
+    capacity += block.size;
+  }
+  return capacity;
+}
+
+void *abcg::FrameArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+  auto const alignOffset = [&](std::size_t offset) {
+    auto const address{
+        reinterpret_cast<std::uintptr_t>(m_blocks.back().data) + offset};
+    return offset + (alignment - address % alignment) % alignment;
+  };
+
+  auto offset{alignOffset(m_offset)};
+  if (offset + bytes > m_blocks.back().size) {
+    m_usedInFullBlocks += m_offset;
+    addBlock(std::max(bytes + alignment, m_blocks.back().size * 2));
+    offset = alignOffset(0);
+  }
+
+  auto *ptr{m_blocks.back().data + offset};
+  m_offset = offset + bytes;
+  m_peakBytesUsed = std::max(m_peakBytesUsed, getBytesUsed());
+  return ptr;
+}
+
+// Memory is only released on reset
+void abcg::FrameArena::do_deallocate(void * /*ptr*/, std::size_t /*bytes*/,
+                                     std::size_t /*alignment*/) {}
+
+bool abcg::FrameArena::do_is_equal(
+    std::pmr::memory_resource const &other) const noexcept {
+  return this == &other;
+}
+
+void abcg::FrameArena::addBlock(std::size_t minSize) {
+  auto const size{std::max(minSize, blockAlignment)};
+  m_blocks.push_back(
+      {.data = static_cast<std::byte *>(
+           m_upstream->allocate(size, blockAlignment)),
+       .size = size});
+  m_offset = 0;
+}
+
+void abcg::FrameArena::releaseBlocks() noexcept {
+  for (auto const &block : m_blocks) {
+    m_upstream->deallocate(block.data, block.size, blockAlignment);
+  }
+  m_blocks.clear();
+}
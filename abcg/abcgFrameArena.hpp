@@ -0,0 +1,105 @@
+/**
+ * @file abcgFrameArena.hpp
+ * @brief Header file of abcg::FrameArena.
+ *
+ * Declaration of abcg::FrameArena.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_FRAME_ARENA_HPP_
+#define ABCG_FRAME_ARENA_HPP_
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace abcg {
+class FrameArena;
+
+/** @brief String allocated from a `std::pmr::memory_resource`. */
+using FrameString = std::pmr::string;
+
+/**
+ * @brief Vector allocated from a `std::pmr::memory_resource`.
+ *
+ * @tparam T Type of the elements.
+ */
+template <typename T> using FrameVector = std::pmr::vector<T>;
+} // namespace abcg
+
+/**
+ * @brief Linear (bump) allocator for memory that lives for a single frame.
+ *
+ * Allocations just advance a pointer into a preallocated block, and
+ * deallocations are no-ops. All memory is released at once when the arena is
+ * reset, which abcg::Window does at the start of each frame, before calling
+ * the update handler.
+ *
+ * When a block runs out of space, a new block is requested from the upstream
+ * resource. On reset, if more than one block was used, the blocks are
+ * replaced by a single block large enough for the whole frame, so that after
+ * a few frames no further upstream allocations are made.
+ *
+ * The arena derives from `std::pmr::memory_resource` and can be used with the
+ * `std::pmr` containers:
+ *
+ * @code
+ * auto &arena{getFrameArena()};
+ * abcg::FrameVector<glm::vec3> positions{&arena};
+ * abcg::FrameString label{&arena};
+ * fmt::format_to(std::back_inserter(label), "{} objects", count);
+ * @endcode
+ *
+ * @remark Memory allocated from the arena must not be used after the frame in
+ * which it was allocated. The arena is not thread-safe.
+ */
+class abcg::FrameArena : public std::pmr::memory_resource {
+public:
+  explicit FrameArena(
+      std::size_t initialSize = m_defaultInitialSize,
+      std::pmr::memory_resource *upstream = std::pmr::get_default_resource());
+  ~FrameArena() override;
+
+  FrameArena(FrameArena const &) = delete;
+  FrameArena(FrameArena &&) = delete;
+  FrameArena &operator=(FrameArena const &) = delete;
+  FrameArena &operator=(FrameArena &&) = delete;
+
+  void reset();
+
+  [[nodiscard]] std::size_t getBytesUsed() const noexcept;
+  [[nodiscard]] std::size_t getPeakBytesUsed() const noexcept;
+  [[nodiscard]] std::size_t getCapacity() const noexcept;
+
+protected:
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+  void do_deallocate(void *ptr, std::size_t bytes,
+                     std::size_t alignment) override;
+  [[nodiscard]] bool
+  do_is_equal(std::pmr::memory_resource const &other) const noexcept override;
+
+private:
+  static constexpr std::size_t m_defaultInitialSize{64 * 1024};
+
+  struct Block {
+    std::byte *data{};
+    std::size_t size{};
+  };
+
+  void addBlock(std::size_t minSize);
+  void releaseBlocks() noexcept;
+
+  std::pmr::memory_resource *m_upstream{};
+  std::vector<Block> m_blocks;
+  std::size_t m_offset{};
+  // Bytes used by the blocks before the current one
+  std::size_t m_usedInFullBlocks{};
+  std::size_t m_peakBytesUsed{};
+};
+
+#endif
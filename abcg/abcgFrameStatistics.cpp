@@ -0,0 +1,245 @@
+/**
+ * @file abcgFrameStatistics.cpp
+ * @brief Definition of abcg::FrameStatistics members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgFrameStatistics.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+
+#include "abcgExternal.hpp"
+
+/**
+ * @brief Constructs an empty window of frame times.
+ *
+ * @param windowSize Maximum number of frames kept. Values smaller than 1 are
+ * clamped to 1.
+ * @param stutterThreshold Multiple of the median frame time above which a
+ * frame is counted as a stutter.
+ */
+abcg::FrameStatistics::FrameStatistics(std::size_t windowSize,
+                                       double stutterThreshold)
+    : m_windowSize(std::max<std::size_t>(windowSize, 1)),
+      m_stutterThreshold(stutterThreshold) {
+  m_frameTimes.reserve(m_windowSize);
+}
+
+/**
+ * @brief Sets the maximum number of frames kept.
+ *
+ * Frames already recorded are discarded if the size changes.
+ *
+ * @param windowSize Maximum number of frames kept. Values smaller than 1 are
+ * clamped to 1.
+ */
+void abcg::FrameStatistics::setWindowSize(std::size_t windowSize) {
+  windowSize = std::max<std::size_t>(windowSize, 1);
+  if (windowSize == m_windowSize)
+    return;
+
+  m_windowSize = windowSize;
+  clear();
+  m_frameTimes.shrink_to_fit();
+  m_frameTimes.reserve(m_windowSize);
+}
+
+/**
+ * @brief Returns the maximum number of frames kept.
+ *
+ * @return Size of the window, in frames.
+ */
+std::size_t abcg::FrameStatistics::getWindowSize() const noexcept {
+  return m_windowSize;
+}
+
+/**
+ * @brief Sets the multiple of the median frame time above which a frame is
+ * counted as a stutter.
+ *
+ * @param stutterThreshold Stutter threshold.
+ */
+void abcg::FrameStatistics::setStutterThreshold(
+    double stutterThreshold) noexcept {
+  m_stutterThreshold = stutterThreshold;
+  m_summaryDirty = true;
+}
+
+/**
+ * @brief Returns the multiple of the median frame time above which a frame
+ * is counted as a stutter.
+ *
+ * @return Stutter threshold.
+ */
+double abcg::FrameStatistics::getStutterThreshold() const noexcept {
+  return m_stutterThreshold;
+}
+
+/**
+ * @brief Adds the time of a frame, replacing the oldest frame if the window
+ * is full.
+ *
+ * @param seconds Frame time, in seconds.
+ */
+void abcg::FrameStatistics::record(double seconds) {
+  if (m_frameTimes.size() < m_windowSize) {
+    m_frameTimes.push_back(seconds);
+  } else {
+    m_frameTimes.at(m_oldest) = seconds;
+    m_oldest = (m_oldest + 1) % m_frameTimes.size();
+  }
+  m_summaryDirty = true;
+}
+
+/**
+ * @brief Discards all recorded frames.
+ */
+void abcg::FrameStatistics::clear() noexcept {
+  m_frameTimes.clear();
+  m_oldest = 0;
+  m_summaryDirty = true;
+}
+
+/**
+ * @brief Returns the number of frames in the window.
+ *
+ * @return Number of recorded frames, up to the window size.
+ */
+std::size_t abcg::FrameStatistics::getFrameCount() const noexcept {
+  return m_frameTimes.size();
+}
+
+/**
+ * @brief Returns the time of a frame in the window.
+ *
+ * @param index Index of the frame, from 0 (oldest) to
+ * abcg::FrameStatistics::getFrameCount - 1 (newest).
+ *
+ * @return Frame time, in seconds.
+ */
+double abcg::FrameStatistics::getFrameTime(std::size_t index) const {
+  return m_frameTimes.at((m_oldest + index) % m_frameTimes.size());
+}
+
+/**
+ * @brief Returns a percentile of the frame times in the window.
+ *
+ * Uses the nearest-rank method, so the result is always one of the recorded
+ * frame times.
+ *
+ * @param percentile Percentile in the range [0, 100].
+ *
+ * @return Frame time, in seconds, or 0 if no frame was recorded.
+ */
+double abcg::FrameStatistics::getPercentile(double percentile) const {
+  updateSummary();
+  if (m_sortedFrameTimes.empty())
+    return 0.0;
+
+  auto const count{gsl::narrow_cast<double>(m_sortedFrameTimes.size())};
+  auto const rank{std::ceil(std::clamp(percentile, 0.0, 100.0) / 100.0 *
+                            count)};
+  auto const index{gsl::narrow_cast<std::size_t>(std::max(rank, 1.0)) - 1};
+  return m_sortedFrameTimes.at(index);
+}
+
+/**
+ * @brief Returns the statistics of the frame times in the window.
+ *
+ * The statistics are recomputed only if frames were recorded since the last
+ * call.
+ *
+ * @return Reference to the summary, valid until the next call to a non-const
+ * member function.
+ */
+abcg::FrameStatisticsSummary const &
+abcg::FrameStatistics::getSummary() const {
+  updateSummary();
+  return m_summary;
+}
+
+/**
+ * @brief Shows the frame times, percentiles, histogram and stutter count in
+ * the current Dear ImGui window.
+ *
+ * @remark This is called by the default implementations of
+ * abcg::OpenGLWindow::onPaintUI and abcg::VulkanWindow::onPaintUI when
+ * abcg::WindowSettings::showFPS is set.
+ */
+void abcg::FrameStatistics::showPlots() const {
+  auto const &summary{getSummary()};
+
+  // Format into a stack buffer to avoid a heap allocation per frame
+  std::array<char, 32> label{};
+  fmt::format_to_n(label.data(), label.size() - 1, "avg {:.1f} FPS",
+                   summary.average > 0.0 ? 1.0 / summary.average : 0.0);
+  ImGui::PlotLines(
+      "",
+      [](void *data, int index) {
+        auto const *statistics{static_cast<FrameStatistics const *>(data)};
+        return gsl::narrow_cast<float>(
+            statistics->getFrameTime(gsl::narrow<std::size_t>(index)) *
+            1000.0);
+      },
+      const_cast<void *>(static_cast<void const *>(this)),
+      gsl::narrow<int>(summary.frameCount), 0, label.data(), 0.0f,
+      gsl::narrow_cast<float>(summary.max * 1000.0) * 1.25f, ImVec2(150, 50));
+
+  ImGui::Text("p50 %.1f p95 %.1f ms", summary.p50 * 1000.0,
+              summary.p95 * 1000.0);
+  ImGui::Text("p99 %.1f max %.1f ms", summary.p99 * 1000.0,
+              summary.max * 1000.0);
+
+  std::array<char, 32> histogramLabel{};
+  fmt::format_to_n(histogramLabel.data(), histogramLabel.size() - 1,
+                   "0-{:.1f} ms", summary.max * 1000.0);
+  ImGui::PlotHistogram("", summary.histogram.data(),
+                       gsl::narrow<int>(summary.histogram.size()), 0,
+                       histogramLabel.data(), 0.0f, FLT_MAX, ImVec2(150, 40));
+  ImGui::Text("%zu stutters in %zu frames", summary.stutterCount,
+              summary.frameCount);
+}
+
+void abcg::FrameStatistics::updateSummary() const {
+  if (!m_summaryDirty)
+    return;
+  m_summaryDirty = false;
+
+  m_sortedFrameTimes.assign(m_frameTimes.begin(), m_frameTimes.end());
+  std::ranges::sort(m_sortedFrameTimes);
+
+  m_summary = {};
+  m_summary.frameCount = m_sortedFrameTimes.size();
+  if (m_sortedFrameTimes.empty())
+    return;
+
+  m_summary.average = std::accumulate(m_sortedFrameTimes.begin(),
+                                      m_sortedFrameTimes.end(), 0.0) /
+                      gsl::narrow_cast<double>(m_summary.frameCount);
+  m_summary.p50 = getPercentile(50.0);
+  m_summary.p95 = getPercentile(95.0);
+  m_summary.p99 = getPercentile(99.0);
+  m_summary.max = m_sortedFrameTimes.back();
+
+  auto const stutterTime{m_summary.p50 * m_stutterThreshold};
+  m_summary.stutterCount = gsl::narrow_cast<std::size_t>(
+      std::ranges::count_if(m_sortedFrameTimes, [stutterTime](double time) {
+        return time > stutterTime;
+      }));
+
+  if (m_summary.max <= 0.0)
+    return;
+  auto const binCount{m_summary.histogram.size()};
+  for (auto const time : m_sortedFrameTimes) {
+    auto const bin{gsl::narrow_cast<std::size_t>(
+        time / m_summary.max * gsl::narrow_cast<double>(binCount))};
+    m_summary.histogram.at(std::min(bin, binCount - 1)) += 1.0f;
+  }
+}
@@ -0,0 +1,115 @@
+/**
+ * @file abcgFrameStatistics.hpp
+ * @brief Header file of abcg::FrameStatistics.
+ *
+ * Declaration of abcg::FrameStatistics and abcg::FrameStatisticsSummary.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_FRAME_STATISTICS_HPP_
+#define ABCG_FRAME_STATISTICS_HPP_
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace abcg {
+class FrameStatistics;
+struct FrameStatisticsSummary;
+} // namespace abcg
+
+/**
+ * @brief Statistics of the frame times kept by abcg::FrameStatistics.
+ *
+ * All times are given in seconds.
+ */
+struct abcg::FrameStatisticsSummary {
+  /** @brief Number of bins of `histogram`. */
+  static constexpr std::size_t histogramBinCount{32};
+
+  /** @brief Number of frames in the window. */
+  std::size_t frameCount{};
+  /** @brief Mean frame time. */
+  double average{};
+  /** @brief Median frame time. */
+  double p50{};
+  /** @brief 95th percentile of the frame times. */
+  double p95{};
+  /** @brief 99th percentile of the frame times. */
+  double p99{};
+  /** @brief Longest frame time. */
+  double max{};
+  /** @brief Number of frames longer than the stutter threshold times the
+   * median. */
+  std::size_t stutterCount{};
+  /** @brief Number of frames in each of `histogramBinCount` bins of equal
+   * width covering the range [0, `max`]. */
+  std::array<float, histogramBinCount> histogram{};
+};
+
+/**
+ * @brief Percentiles, histogram and stutter count of the most recent frame
+ * times.
+ *
+ * The statistics are computed over a sliding window of the last frames, so
+ * that isolated spikes remain visible, unlike in a smoothed frame rate.
+ *
+ * abcg::Window records the total CPU time of each frame (see
+ * abcg::FrameTimes::total) and exposes the statistics with
+ * abcg::Window::getFrameStatistics. The window size and the stutter
+ * threshold are set with abcg::WindowSettings::frameStatisticsWindow and
+ * abcg::WindowSettings::stutterThreshold.
+ *
+ * @code
+ * auto const &summary{getFrameStatistics().getSummary()};
+ * if (summary.p99 > 1.0 / 30.0) {
+ *   abcg::Log::warning("p99 frame time {:.2f} ms", summary.p99 * 1000.0);
+ * }
+ * @endcode
+ */
+class abcg::FrameStatistics {
+public:
+  /** @brief Default number of frames in the window. */
+  static constexpr std::size_t defaultWindowSize{300};
+  /** @brief Default multiple of the median frame time above which a frame is
+   * counted as a stutter. */
+  static constexpr double defaultStutterThreshold{2.0};
+
+  explicit FrameStatistics(std::size_t windowSize = defaultWindowSize,
+                           double stutterThreshold = defaultStutterThreshold);
+
+  void setWindowSize(std::size_t windowSize);
+  [[nodiscard]] std::size_t getWindowSize() const noexcept;
+  void setStutterThreshold(double stutterThreshold) noexcept;
+  [[nodiscard]] double getStutterThreshold() const noexcept;
+
+  void record(double seconds);
+  void clear() noexcept;
+
+  [[nodiscard]] std::size_t getFrameCount() const noexcept;
+  [[nodiscard]] double getFrameTime(std::size_t index) const;
+  [[nodiscard]] double getPercentile(double percentile) const;
+  [[nodiscard]] FrameStatisticsSummary const &getSummary() const;
+
+  void showPlots() const;
+
+private:
+  void updateSummary() const;
+
+  std::size_t m_windowSize{};
+  double m_stutterThreshold{};
+  std::vector<double> m_frameTimes;
+  // Position of the oldest frame once the window is full
+  std::size_t m_oldest{};
+
+  // Computed on demand from m_frameTimes
+  mutable std::vector<double> m_sortedFrameTimes;
+  mutable FrameStatisticsSummary m_summary;
+  mutable bool m_summaryDirty{true};
+};
+
+#endif
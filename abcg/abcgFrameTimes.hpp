@@ -0,0 +1,62 @@
+/**
+ * @file abcgFrameTimes.hpp
+ * @brief Header file of abcg::FrameTimes.
+ *
+ * Declaration of abcg::FrameTimes and abcg::FramePhase.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_FRAME_TIMES_HPP_
+#define ABCG_FRAME_TIMES_HPP_
+
+namespace abcg {
+struct FrameTimes;
+enum class FramePhase;
+} // namespace abcg
+
+/**
+ * @brief Enumeration of the phases of a frame.
+ *
+ * @sa abcg::FrameTimes.
+ */
+enum class abcg::FramePhase {
+  /** @brief Polling and dispatching of SDL events. */
+  Events,
+  /** @brief Frame update handler (e.g., abcg::OpenGLWindow::onUpdate). */
+  Update,
+  /** @brief UI building and rendering (e.g., abcg::OpenGLWindow::onPaintUI).
+   */
+  UI,
+  /** @brief Scene rendering handler (e.g., abcg::OpenGLWindow::onPaint). */
+  Paint,
+  /** @brief Presentation of the frame (e.g., `SDL_GL_SwapWindow`). */
+  Swap
+};
+
+/**
+ * @brief CPU time spent in each phase of a frame.
+ *
+ * All times are given in seconds.
+ *
+ * @sa abcg::Window::getFrameTimes.
+ */
+struct abcg::FrameTimes {
+  /** @brief Time spent polling and dispatching SDL events. */
+  double events{};
+  /** @brief Time spent in the frame update handler. */
+  double update{};
+  /** @brief Time spent building and rendering the UI. */
+  double ui{};
+  /** @brief Time spent in the scene rendering handler. */
+  double paint{};
+  /** @brief Time spent presenting the frame. */
+  double swap{};
+  /** @brief Total frame time, including the phases above. */
+  double total{};
+};
+
+#endif
@@ -0,0 +1,271 @@
+/**
+ * @file abcgGpuMemory.cpp
+ * @brief Definition of abcg::GpuMemory members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgGpuMemory.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "abcgLog.hpp"
+#include "abcgMetrics.hpp"
+
+namespace {
+struct GpuMemoryState {
+  std::mutex mutex;
+  // Allocations keyed by kind and handle
+  std::unordered_map<std::uint64_t, abcg::GpuAllocation> allocations;
+};
+
+GpuMemoryState &state() {
+  static GpuMemoryState instance;
+  return instance;
+}
+
+std::atomic<std::uint64_t> liveBytes{};
+std::atomic<std::uint64_t> peakBytes{};
+
+thread_local std::string currentTag{};
+
+// OpenGL names and Vulkan handles of different kinds may collide, so the
+// kind is folded into the key
+std::uint64_t makeKey(abcg::GpuResourceKind kind,
+                      std::uint64_t handle) noexcept {
+  return (handle * 4U) ^ static_cast<std::uint64_t>(kind);
+}
+
+char const *toString(abcg::GpuResourceKind kind) noexcept {
+  switch (kind) {
+  case abcg::GpuResourceKind::Buffer:
+    return "Buffer";
+  case abcg::GpuResourceKind::Texture:
+    return "Texture";
+  case abcg::GpuResourceKind::Renderbuffer:
+    return "Renderbuffer";
+  }
+  return "Unknown";
+}
+
+// Appends the static format parts of an allocation to its format
+void resolveFormat(abcg::GpuAllocation &allocation) {
+  for (auto const *part : allocation.formatParts) {
+    if (part == nullptr)
+      continue;
+    if (!allocation.format.empty()) {
+      allocation.format += ", ";
+    }
+    allocation.format += part;
+  }
+  allocation.formatParts = {};
+}
+
+void updateGauge() noexcept {
+  static auto &gpuMemoryBytes{abcg::Metrics::gauge("abcg.gpu_memory_bytes")};
+  gpuMemoryBytes.set(static_cast<double>(liveBytes.load()));
+}
+} // namespace
+
+/**
+ * @brief Sets the owner tag of the calling thread.
+ *
+ * @param tag Owner tag.
+ */
+abcg::GpuMemory::TagScope::TagScope(std::string_view tag)
+    : m_previousTag{std::exchange(currentTag, std::string{tag})} {}
+
+/**
+ * @brief Restores the owner tag that was active when the object was
+ * created.
+ */
+abcg::GpuMemory::TagScope::~TagScope() {
+  currentTag = std::move(m_previousTag);
+}
+
+/**
+ * @brief Records a GPU allocation.
+ *
+ * If an allocation of the same kind and handle is already recorded, it is
+ * replaced, e.g., when glBufferData reallocates the storage of a buffer.
+ *
+ * @param allocation Allocation to be recorded. If its owner tag is empty,
+ * the tag of the innermost abcg::GpuMemory::TagScope of the calling thread is
+ * used.
+ */
+void abcg::GpuMemory::track(GpuAllocation allocation) {
+  if (allocation.tag.empty()) {
+    allocation.tag = currentTag;
+  }
+
+  auto &memory{state()};
+  {
+    std::lock_guard const lock{memory.mutex};
+    auto const key{makeKey(allocation.kind, allocation.handle)};
+    if (auto const iter{memory.allocations.find(key)};
+        iter != memory.allocations.end()) {
+      liveBytes -= iter->second.bytes;
+    }
+    auto const bytes{allocation.bytes};
+    memory.allocations.insert_or_assign(key, std::move(allocation));
+    auto const live{liveBytes += bytes};
+    peakBytes.store(std::max(peakBytes.load(), live));
+  }
+  updateGauge();
+}
+
+/**
+ * @brief Removes the record of a GPU allocation.
+ *
+ * Does nothing if the allocation is not recorded.
+ *
+ * @param kind Kind of the resource.
+ * @param handle API handle of the resource.
+ */
+void abcg::GpuMemory::untrack(GpuResourceKind kind, std::uint64_t handle) {
+  auto &memory{state()};
+  {
+    std::lock_guard const lock{memory.mutex};
+    auto const iter{memory.allocations.find(makeKey(kind, handle))};
+    if (iter == memory.allocations.end())
+      return;
+    liveBytes -= iter->second.bytes;
+    memory.allocations.erase(iter);
+  }
+  updateGauge();
+}
+
+/**
+ * @brief Returns the total size of the live allocations.
+ *
+ * @return Size in bytes.
+ */
+std::uint64_t abcg::GpuMemory::getLiveBytes() noexcept {
+  return liveBytes.load();
+}
+
+/**
+ * @brief Returns the highest total size of the live allocations since the
+ * application started.
+ *
+ * @return Size in bytes.
+ */
+std::uint64_t abcg::GpuMemory::getPeakBytes() noexcept {
+  return peakBytes.load();
+}
+
+/**
+ * @brief Returns the number of live allocations.
+ *
+ * @return Number of allocations.
+ */
+std::size_t abcg::GpuMemory::getLiveCount() {
+  auto &memory{state()};
+  std::lock_guard const lock{memory.mutex};
+  return memory.allocations.size();
+}
+
+/**
+ * @brief Returns the live allocations.
+ *
+ * @return Copy of the live allocations, sorted by decreasing size.
+ */
+std::vector<abcg::GpuAllocation> abcg::GpuMemory::getAllocations() {
+  std::vector<GpuAllocation> allocations;
+  {
+    auto &memory{state()};
+    std::lock_guard const lock{memory.mutex};
+    allocations.reserve(memory.allocations.size());
+    for (auto const &[key, allocation] : memory.allocations) {
+      allocations.push_back(allocation);
+    }
+  }
+  for (auto &allocation : allocations) {
+    resolveFormat(allocation);
+  }
+  std::ranges::sort(allocations, std::ranges::greater{},
+                    &GpuAllocation::bytes);
+  return allocations;
+}
+
+/**
+ * @brief Returns the owner tag of the calling thread.
+ *
+ * @return Tag of the innermost abcg::GpuMemory::TagScope of the calling
+ * thread, or an empty string.
+ */
+std::string_view abcg::GpuMemory::getCurrentTag() noexcept {
+  return currentTag;
+}
+
+/**
+ * @brief Returns the number of levels of a full mipmap chain.
+ *
+ * @param width Width of the base level.
+ * @param height Height of the base level.
+ *
+ * @return \f$\lfloor \log_2(\max(w, h)) \rfloor + 1\f$.
+ */
+std::uint32_t abcg::GpuMemory::getMipLevelCount(std::uint32_t width,
+                                                std::uint32_t height) noexcept {
+  std::uint32_t levels{1};
+  for (auto size{std::max(width, height)}; size > 1; size /= 2) {
+    ++levels;
+  }
+  return levels;
+}
+
+/**
+ * @brief Returns the size of a 2D texture.
+ *
+ * @param width Width of the base level.
+ * @param height Height of the base level.
+ * @param bytesPerTexel Number of bytes per texel.
+ * @param mipLevels Number of mipmap levels.
+ *
+ * @return Size in bytes of all mipmap levels.
+ */
+std::uint64_t
+abcg::GpuMemory::getTextureSize(std::uint32_t width, std::uint32_t height,
+                                std::uint32_t bytesPerTexel,
+                                std::uint32_t mipLevels) noexcept {
+  std::uint64_t bytes{};
+  for (std::uint32_t level{}; level < mipLevels; ++level) {
+    bytes += std::uint64_t{std::max(width >> level, 1U)} *
+             std::max(height >> level, 1U) * bytesPerTexel;
+  }
+  return bytes;
+}
+
+/**
+ * @brief Logs a warning for each live allocation.
+ *
+ * @remark This is called by abcg::Window after abcg::Window::onDestroy, when
+ * all resources created by the application are expected to be released.
+ *
+ * @return Number of live allocations.
+ */
+std::size_t abcg::GpuMemory::reportLeaks() {
+  auto const allocations{getAllocations()};
+  if (allocations.empty())
+    return 0;
+
+  abcg::Log::warning("{} GPU allocation(s) of {} bytes were not released",
+                     allocations.size(), getLiveBytes());
+  for (auto const &allocation : allocations) {
+    abcg::Log::warning("  {} {}: {} bytes, {}, {} mip level(s), '{}', tag '{}'",
+                       toString(allocation.kind), allocation.handle,
+                       allocation.bytes, allocation.format,
+                       allocation.mipLevels, allocation.label,
+                       allocation.tag.empty() ? std::string_view{"untagged"}
+                                              : allocation.tag);
+  }
+  return allocations.size();
+}
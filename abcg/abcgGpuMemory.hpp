@@ -0,0 +1,145 @@
+/**
+ * @file abcgGpuMemory.hpp
+ * @brief Header file of abcg::GpuMemory.
+ *
+ * Declaration of abcg::GpuMemory, abcg::GpuAllocation and
+ * abcg::GpuResourceKind.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_GPU_MEMORY_HPP_
+#define ABCG_GPU_MEMORY_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace abcg {
+enum class GpuResourceKind;
+struct GpuAllocation;
+class GpuMemory;
+} // namespace abcg
+
+/**
+ * @brief Kind of a GPU resource tracked by abcg::GpuMemory.
+ */
+enum class abcg::GpuResourceKind {
+  /** @brief Vertex, index, uniform or other buffer object. */
+  Buffer,
+  /** @brief OpenGL texture or Vulkan image. */
+  Texture,
+  /** @brief OpenGL renderbuffer, e.g., of an offscreen render target. */
+  Renderbuffer
+};
+
+/**
+ * @brief GPU allocation tracked by abcg::GpuMemory.
+ */
+struct abcg::GpuAllocation {
+  /** @brief Kind of the resource. */
+  GpuResourceKind kind{};
+  /** @brief API handle of the resource, e.g., the name generated by
+   * glGenBuffers or the value of a vk::Buffer. */
+  std::uint64_t handle{};
+  /** @brief Size in bytes, including all mipmap levels and samples. */
+  std::uint64_t bytes{};
+  /** @brief Pixel format of a texture or renderbuffer, or the target and
+   * usage of a buffer. */
+  std::string format{};
+  /** @brief Static strings appended to the format, separated by commas, when
+   * the allocation is read with abcg::GpuMemory::getAllocations. This avoids
+   * building the format on allocations that happen every frame. */
+  std::array<char const *, 2> formatParts{};
+  /** @brief Number of mipmap levels. */
+  std::uint32_t mipLevels{1};
+  /** @brief Description of the resource, such as the path of the image
+   * file of a texture. */
+  std::string label{};
+  /** @brief Owner tag that was active when the resource was allocated (see
+   * abcg::GpuMemory::TagScope). */
+  std::string tag{};
+};
+
+/**
+ * @brief Accounts for the GPU memory allocated by ABCg.
+ *
+ * The following allocations are tracked, together with their size, format,
+ * number of mipmap levels and owner tag:
+ *
+ * - Textures created by abcg::loadOpenGLTexture and abcg::loadOpenGLCubemap;
+ * - Buffer storage allocated with `abcg::glBufferData`, and released with
+ *   `abcg::glDeleteBuffers`;
+ * - Render targets created by abcg::OpenGLWindow;
+ * - Buffers and images created by abcg::VulkanBuffer and abcg::VulkanImage.
+ *
+ * Sizes of OpenGL resources are estimates, as drivers may pad or compress
+ * the storage. Sizes of Vulkan resources are the sizes of the device memory
+ * allocations.
+ *
+ * The owner tag of an allocation is the innermost abcg::GpuMemory::TagScope
+ * of the calling thread:
+ *
+ * @code
+ * {
+ *   abcg::GpuMemory::TagScope const tag{"Terrain"};
+ *   m_heightMap = abcg::loadOpenGLTexture({.path = heightMapPath});
+ *   // ...
+ * }
+ * @endcode
+ *
+ * The live and peak totals are shown in the FPS overlay, and allocations
+ * that are still alive when the window is destroyed are reported as leaks.
+ *
+ * This class is thread-safe.
+ */
+class abcg::GpuMemory {
+public:
+  GpuMemory() = delete;
+
+  /**
+   * @brief Sets the owner tag of the GPU allocations made by the calling
+   * thread during the lifetime of the object.
+   *
+   * Scopes can be nested. The previous tag is restored on destruction.
+   */
+  class TagScope {
+  public:
+    explicit TagScope(std::string_view tag);
+    ~TagScope();
+
+    TagScope(TagScope const &) = delete;
+    TagScope &operator=(TagScope const &) = delete;
+    TagScope(TagScope &&) = delete;
+    TagScope &operator=(TagScope &&) = delete;
+
+  private:
+    std::string m_previousTag;
+  };
+
+  static void track(GpuAllocation allocation);
+  static void untrack(GpuResourceKind kind, std::uint64_t handle);
+
+  [[nodiscard]] static std::uint64_t getLiveBytes() noexcept;
+  [[nodiscard]] static std::uint64_t getPeakBytes() noexcept;
+  [[nodiscard]] static std::size_t getLiveCount();
+  [[nodiscard]] static std::vector<GpuAllocation> getAllocations();
+  [[nodiscard]] static std::string_view getCurrentTag() noexcept;
+
+  [[nodiscard]] static std::uint32_t
+  getMipLevelCount(std::uint32_t width, std::uint32_t height) noexcept;
+  [[nodiscard]] static std::uint64_t
+  getTextureSize(std::uint32_t width, std::uint32_t height,
+                 std::uint32_t bytesPerTexel,
+                 std::uint32_t mipLevels = 1) noexcept;
+
+  static std::size_t reportLeaks();
+};
+
+#endif
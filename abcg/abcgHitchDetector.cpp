@@ -0,0 +1,195 @@
+/**
+ * @file abcgHitchDetector.cpp
+ * @brief Definition of abcg::HitchDetector members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgHitchDetector.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "abcgException.hpp"
+#include "abcgExternal.hpp"
+#include "abcgLog.hpp"
+#include "abcgTrace.hpp"
+
+namespace {
+// Minimum number of frames in the buffer before hitches are detected
+constexpr std::size_t minFramesForMedian{30};
+// Minimum number of frames between two reports
+constexpr std::uint64_t framesBetweenReports{30};
+// Frames shorter than this are never hitches, regardless of the median
+constexpr double minHitchTime{1.0 / 240.0};
+
+// Notes added since the last recorded frame. Notes can be added from any
+// thread, and are only kept while a detector exists.
+std::atomic<int> numDetectors{};
+std::mutex notesMutex;
+std::vector<std::string> pendingNotes;
+} // namespace
+
+/**
+ * @brief Constructs a hitch detector.
+ *
+ * @param threshold Multiple of the median frame time above which a frame is
+ * considered a hitch.
+ * @param reportPath Path of the text file to which reports are appended.
+ * @param historySize Number of frames kept in the rolling buffer.
+ */
+abcg::HitchDetector::HitchDetector(double threshold, std::string reportPath,
+                                   std::size_t historySize)
+    : m_threshold(threshold), m_reportPath(std::move(reportPath)),
+      m_historySize(std::max(historySize, minFramesForMedian)) {
+  m_history.reserve(m_historySize);
+  m_medianScratch.reserve(m_historySize);
+  ++numDetectors;
+}
+
+/**
+ * @brief Destroys the hitch detector.
+ */
+abcg::HitchDetector::~HitchDetector() {
+  if (--numDetectors == 0) {
+    std::lock_guard const lock{notesMutex};
+    pendingNotes.clear();
+  }
+}
+
+/**
+ * @brief Adds a note to the frame being rendered.
+ *
+ * Notes describe events that may cause a hitch, such as shader compilations
+ * or texture loads, and are listed in the report if the frame turns out to be
+ * a hitch. This function can be called from any thread, and does nothing if
+ * no detector exists.
+ *
+ * Notes are also added to trace captures as instant events (see
+ * abcg::Trace::addEvent).
+ *
+ * @param note Description of the event.
+ */
+void abcg::HitchDetector::addNote(std::string_view note) {
+  Trace::addEvent(note);
+
+  if (numDetectors.load(std::memory_order_relaxed) == 0)
+    return;
+
+  std::lock_guard const lock{notesMutex};
+  pendingNotes.emplace_back(note);
+}
+
+/**
+ * @brief Records the timing breakdown of a frame.
+ *
+ * If the frame is a hitch, a report with the frames in the buffer is
+ * appended to the report file.
+ *
+ * @param times Times of the frame.
+ *
+ * @return True if the frame is a hitch.
+ *
+ * @throw abcg::RuntimeError if the report file cannot be written.
+ */
+bool abcg::HitchDetector::recordFrame(FrameTimes const &times) {
+  Frame frame{.index = m_frameIndex++, .times = times, .notes = {}};
+  {
+    std::lock_guard const lock{notesMutex};
+    frame.notes = std::exchange(pendingNotes, {});
+  }
+
+  // Compare against the previous frames only
+  auto isHitch{false};
+  auto median{0.0};
+  if (m_history.size() >= minFramesForMedian &&
+      m_framesSinceHitch >= framesBetweenReports) {
+    median = computeMedian();
+    isHitch = times.total > minHitchTime && times.total > median * m_threshold;
+  }
+  ++m_framesSinceHitch;
+
+  Frame *stored{};
+  if (m_history.size() < m_historySize) {
+    stored = &m_history.emplace_back(std::move(frame));
+  } else {
+    stored = &m_history.at(m_oldest);
+    *stored = std::move(frame);
+    m_oldest = (m_oldest + 1) % m_historySize;
+  }
+
+  if (isHitch) {
+    m_framesSinceHitch = 0;
+    ++m_hitchCount;
+    writeReport(*stored, median);
+  }
+  return isHitch;
+}
+
+/**
+ * @brief Returns the number of hitches detected so far.
+ *
+ * @return Number of reports written.
+ */
+std::size_t abcg::HitchDetector::getHitchCount() const noexcept {
+  return m_hitchCount;
+}
+
+// Uses a scratch buffer reserved for the whole history, so that no memory is
+// allocated per frame
+double abcg::HitchDetector::computeMedian() {
+  auto &totals{m_medianScratch};
+  totals.clear();
+  for (auto const &frame : m_history) {
+    totals.push_back(frame.times.total);
+  }
+  auto const middle{totals.begin() + gsl::narrow<long>(totals.size() / 2)};
+  std::nth_element(totals.begin(), middle, totals.end());
+  return *middle;
+}
+
+void abcg::HitchDetector::writeReport(Frame const &hitch, double median) const {
+  std::unique_ptr<std::FILE, decltype(&std::fclose)> const file{
+      std::fopen(m_reportPath.c_str(), "a"), &std::fclose};
+  if (!file) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to open hitch report file {}", m_reportPath));
+  }
+
+  fmt::print(file.get(),
+             "Hitch at frame {}: {:.2f} ms (median {:.2f} ms, {:.1f}x)\n",
+             hitch.index, hitch.times.total * 1000.0, median * 1000.0,
+             hitch.times.total / median);
+  for (auto const &note : hitch.notes) {
+    fmt::print(file.get(), "  {}\n", note);
+  }
+  writeFrames(file.get());
+  fmt::print(file.get(), "\n");
+
+  abcg::Log::warning("Hitch at frame {} ({:.2f} ms), report appended to {}",
+                     hitch.index, hitch.times.total * 1000.0, m_reportPath);
+}
+
+// Writes the frames of the buffer, from the oldest to the newest
+void abcg::HitchDetector::writeFrames(std::FILE *file) const {
+  fmt::print(file, "{:>8} {:>8} {:>8} {:>8} {:>8} {:>8} {:>8}  notes\n",
+             "frame", "events", "update", "ui", "paint", "swap", "total");
+  for (auto const offset : iter::range(m_history.size())) {
+    auto const &frame{m_history.at((m_oldest + offset) % m_history.size())};
+    auto const &times{frame.times};
+    fmt::print(file, "{:>8} {:8.2f} {:8.2f} {:8.2f} {:8.2f} {:8.2f} {:8.2f}",
+               frame.index, times.events * 1000.0, times.update * 1000.0,
+               times.ui * 1000.0, times.paint * 1000.0, times.swap * 1000.0,
+               times.total * 1000.0);
+    if (!frame.notes.empty()) {
+      fmt::print(file, "  {} note(s)", frame.notes.size());
+    }
+    fmt::print(file, "\n");
+  }
+}
@@ -0,0 +1,88 @@
+/**
+ * @file abcgHitchDetector.hpp
+ * @brief Header file of abcg::HitchDetector.
+ *
+ * Declaration of abcg::HitchDetector.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_HITCH_DETECTOR_HPP_
+#define ABCG_HITCH_DETECTOR_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "abcgFrameTimes.hpp"
+
+namespace abcg {
+class HitchDetector;
+} // namespace abcg
+
+/**
+ * @brief Detects frames that take much longer than the typical frame.
+ *
+ * The detector keeps the timing breakdown of the last frames in a rolling
+ * buffer. When the total time of a frame exceeds a given multiple of the
+ * median of the buffer, the buffer is appended to a report file, together
+ * with the notes added during the hitch frame (see
+ * abcg::HitchDetector::addNote).
+ *
+ * ABCg adds notes when shader programs are compiled, textures are loaded,
+ * and render targets or swapchains are (re)created, which are typical causes
+ * of one-off spikes.
+ *
+ * abcg::Window creates a detector when abcg::WindowSettings::detectHitches is
+ * set.
+ */
+class abcg::HitchDetector {
+public:
+  explicit HitchDetector(double threshold, std::string reportPath,
+                         std::size_t historySize = m_defaultHistorySize);
+  ~HitchDetector();
+
+  HitchDetector(HitchDetector const &) = delete;
+  HitchDetector(HitchDetector &&) = delete;
+  HitchDetector &operator=(HitchDetector const &) = delete;
+  HitchDetector &operator=(HitchDetector &&) = delete;
+
+  static void addNote(std::string_view note);
+
+  bool recordFrame(FrameTimes const &times);
+
+  [[nodiscard]] std::size_t getHitchCount() const noexcept;
+
+private:
+  static constexpr std::size_t m_defaultHistorySize{300};
+
+  struct Frame {
+    std::uint64_t index{};
+    FrameTimes times{};
+    std::vector<std::string> notes;
+  };
+
+  [[nodiscard]] double computeMedian();
+  void writeReport(Frame const &hitch, double median) const;
+  void writeFrames(std::FILE *file) const;
+
+  double m_threshold{};
+  std::string m_reportPath;
+  std::vector<Frame> m_history;
+  std::size_t m_historySize{};
+  // Frame times sorted partially by computeMedian
+  std::vector<double> m_medianScratch;
+  // Position of the oldest frame once the buffer is full
+  std::size_t m_oldest{};
+  std::uint64_t m_frameIndex{};
+  std::uint64_t m_framesSinceHitch{};
+  std::size_t m_hitchCount{};
+};
+
+#endif
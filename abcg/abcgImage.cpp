@@ -13,9 +13,34 @@
 #include <cppitertools/itertools.hpp>
 #include <gsl/gsl>
 
+#include <mutex>
 #include <span>
 #include <vector>
 
+#include "abcgException.hpp"
+
+/**
+ * @brief Initializes the JPEG and PNG codecs of SDL_image.
+ *
+ * The codecs are initialized on the first call only, so that applications
+ * that do not load images do not pay for loading the codec libraries at
+ * startup. This is called by the ABCg functions that load images before
+ * calling `IMG_Load`.
+ *
+ * @throw abcg::SDLImageError if `IMG_Init` failed.
+ */
+void abcg::initSDLImage() {
+#if !defined(__EMSCRIPTEN__)
+  static std::once_flag initialized;
+  std::call_once(initialized, []() {
+    auto const imageFlags{IMG_INIT_JPG | IMG_INIT_PNG};
+    if ((IMG_Init(imageFlags) & imageFlags) != imageFlags) {
+      throw abcg::SDLImageError("IMG_Init failed");
+    }
+  });
+#endif
+}
+
 /**
  * @brief Flips an image horizontally.
  *
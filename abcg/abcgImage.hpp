@@ -14,6 +14,7 @@
 #include <SDL_image.h>
 
 namespace abcg {
+void initSDLImage();
 void flipHorizontally(SDL_Surface &surface);
 void flipVertically(SDL_Surface &surface);
 } // namespace abcg
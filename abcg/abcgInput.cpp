@@ -0,0 +1,251 @@
+/**
+ * @file abcgInput.cpp
+ * @brief Definition of abcg::InputState members and input event helpers.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgInput.hpp"
+
+namespace {
+template <std::size_t N>
+bool testBit(std::bitset<N> const &bits, int index) noexcept {
+  return index >= 0 && gsl::narrow_cast<std::size_t>(index) < N &&
+         bits.test(gsl::narrow_cast<std::size_t>(index));
+}
+
+template <std::size_t N>
+void setBit(std::bitset<N> &bits, int index, bool value = true) noexcept {
+  if (index >= 0 && gsl::narrow_cast<std::size_t>(index) < N) {
+    bits.set(gsl::narrow_cast<std::size_t>(index), value);
+  }
+}
+
+// Returns true if the event at the head of the queue can be merged into the
+// given mouse motion or mouse wheel event
+bool canMerge(SDL_Event const &event, SDL_Event const &next) noexcept {
+  if (next.type != event.type)
+    return false;
+
+  if (event.type == SDL_MOUSEMOTION) {
+    return next.motion.windowID == event.motion.windowID &&
+           next.motion.which == event.motion.which &&
+           next.motion.state == event.motion.state;
+  }
+
+  return next.wheel.windowID == event.wheel.windowID &&
+         next.wheel.which == event.wheel.which &&
+         next.wheel.direction == event.wheel.direction;
+}
+} // namespace
+
+/**
+ * @brief Merges consecutive queued mouse events into the given event.
+ *
+ * If @a event is a `SDL_MOUSEMOTION` or `SDL_MOUSEWHEEL` event, the events
+ * of the same type that immediately follow it in the SDL event queue are
+ * removed from the queue and merged into @a event: the motion event takes
+ * the position of the last event and the sum of the relative motions; the
+ * wheel event takes the sum of the scroll amounts. The timestamp of
+ * @a event is kept, as it is the time the oldest merged input was received.
+ *
+ * Events are only merged if they refer to the same window and mouse, and have
+ * the same button state (motion) or direction (wheel). Other events are left
+ * untouched, so the relative order of all events is preserved.
+ *
+ * @param event Event just polled from the SDL event queue.
+ *
+ * @return True if at least one event was merged into @a event.
+ */
+bool abcg::coalesceInputEvent(SDL_Event &event) {
+  if (event.type != SDL_MOUSEMOTION && event.type != SDL_MOUSEWHEEL)
+    return false;
+
+  auto merged{false};
+  SDL_Event next{};
+  while (SDL_PeepEvents(&next, 1, SDL_PEEKEVENT, SDL_FIRSTEVENT,
+                        SDL_LASTEVENT) == 1 &&
+         canMerge(event, next)) {
+    SDL_PeepEvents(&next, 1, SDL_GETEVENT, next.type, next.type);
+
+    if (event.type == SDL_MOUSEMOTION) {
+      event.motion.x = next.motion.x;
+      event.motion.y = next.motion.y;
+      event.motion.xrel += next.motion.xrel;
+      event.motion.yrel += next.motion.yrel;
+    } else {
+      event.wheel.x += next.wheel.x;
+      event.wheel.y += next.wheel.y;
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+      event.wheel.preciseX += next.wheel.preciseX;
+      event.wheel.preciseY += next.wheel.preciseY;
+#endif
+    }
+    merged = true;
+  }
+
+  return merged;
+}
+
+/**
+ * @brief Returns whether a key is held down.
+ *
+ * @param scancode SDL scancode of the key.
+ *
+ * @return True if the key is down at the start of the frame.
+ */
+bool abcg::InputState::isKeyDown(SDL_Scancode scancode) const noexcept {
+  return testBit(m_keysDown, scancode);
+}
+
+/**
+ * @brief Returns whether a key was pressed since the last frame.
+ *
+ * Key repeat events are ignored.
+ *
+ * @param scancode SDL scancode of the key.
+ *
+ * @return True if the key was pressed since the last frame.
+ */
+bool abcg::InputState::wasKeyPressed(SDL_Scancode scancode) const noexcept {
+  return testBit(m_keysPressed, scancode);
+}
+
+/**
+ * @brief Returns whether a key was released since the last frame.
+ *
+ * @param scancode SDL scancode of the key.
+ *
+ * @return True if the key was released since the last frame.
+ */
+bool abcg::InputState::wasKeyReleased(SDL_Scancode scancode) const noexcept {
+  return testBit(m_keysReleased, scancode);
+}
+
+/**
+ * @brief Returns whether a mouse button is held down.
+ *
+ * @param button SDL mouse button index (e.g., `SDL_BUTTON_LEFT`).
+ *
+ * @return True if the button is down at the start of the frame.
+ */
+bool abcg::InputState::isMouseButtonDown(int button) const noexcept {
+  return testBit(m_buttonsDown, button);
+}
+
+/**
+ * @brief Returns whether a mouse button was pressed since the last frame.
+ *
+ * @param button SDL mouse button index (e.g., `SDL_BUTTON_LEFT`).
+ *
+ * @return True if the button was pressed since the last frame.
+ */
+bool abcg::InputState::wasMouseButtonPressed(int button) const noexcept {
+  return testBit(m_buttonsPressed, button);
+}
+
+/**
+ * @brief Returns whether a mouse button was released since the last frame.
+ *
+ * @param button SDL mouse button index (e.g., `SDL_BUTTON_LEFT`).
+ *
+ * @return True if the button was released since the last frame.
+ */
+bool abcg::InputState::wasMouseButtonReleased(int button) const noexcept {
+  return testBit(m_buttonsReleased, button);
+}
+
+/**
+ * @brief Returns the mouse position.
+ *
+ * @return Mouse position relative to the window, in screen coordinates.
+ */
+glm::ivec2 abcg::InputState::getMousePosition() const noexcept {
+  return m_mousePosition;
+}
+
+/**
+ * @brief Returns the mouse motion accumulated since the last frame.
+ *
+ * @return Relative mouse motion, in screen coordinates.
+ */
+glm::ivec2 abcg::InputState::getMouseDelta() const noexcept {
+  return m_mouseDelta;
+}
+
+/**
+ * @brief Returns the mouse wheel scroll accumulated since the last frame.
+ *
+ * @return Horizontal (x) and vertical (y) scroll amounts. Positive values are
+ * to the right and away from the user, regardless of the wheel direction
+ * setting of the platform.
+ */
+glm::vec2 abcg::InputState::getMouseWheel() const noexcept {
+  return m_mouseWheel;
+}
+
+void abcg::InputState::accumulate(SDL_Event const &event, bool captured) {
+  switch (event.type) {
+  case SDL_KEYDOWN:
+    if (!captured && event.key.repeat == 0) {
+      setBit(m_keysDown, event.key.keysym.scancode);
+      setBit(m_keysPressed, event.key.keysym.scancode);
+    }
+    break;
+  case SDL_KEYUP:
+    // Releases are always tracked so that keys are not stuck down
+    if (testBit(m_keysDown, event.key.keysym.scancode)) {
+      setBit(m_keysDown, event.key.keysym.scancode, false);
+      setBit(m_keysReleased, event.key.keysym.scancode);
+    }
+    break;
+  case SDL_MOUSEMOTION:
+    m_mousePosition = {event.motion.x, event.motion.y};
+    if (!captured) {
+      m_mouseDelta += glm::ivec2{event.motion.xrel, event.motion.yrel};
+    }
+    break;
+  case SDL_MOUSEBUTTONDOWN:
+    m_mousePosition = {event.button.x, event.button.y};
+    if (!captured) {
+      setBit(m_buttonsDown, event.button.button);
+      setBit(m_buttonsPressed, event.button.button);
+    }
+    break;
+  case SDL_MOUSEBUTTONUP:
+    m_mousePosition = {event.button.x, event.button.y};
+    if (testBit(m_buttonsDown, event.button.button)) {
+      setBit(m_buttonsDown, event.button.button, false);
+      setBit(m_buttonsReleased, event.button.button);
+    }
+    break;
+  case SDL_MOUSEWHEEL:
+    if (!captured) {
+      auto const sign{event.wheel.direction == SDL_MOUSEWHEEL_FLIPPED ? -1.0f
+                                                                      : 1.0f};
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+      m_mouseWheel += sign * glm::vec2{event.wheel.preciseX,
+                                       event.wheel.preciseY};
+#else
+      m_mouseWheel += sign * glm::vec2{event.wheel.x, event.wheel.y};
+#endif
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+// Clears the per-frame transitions and accumulators. Held keys and buttons,
+// and the mouse position, carry over to the next frame.
+void abcg::InputState::beginFrame() noexcept {
+  m_keysPressed.reset();
+  m_keysReleased.reset();
+  m_buttonsPressed.reset();
+  m_buttonsReleased.reset();
+  m_mouseDelta = {};
+  m_mouseWheel = {};
+}
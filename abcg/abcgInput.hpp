@@ -0,0 +1,69 @@
+/**
+ * @file abcgInput.hpp
+ * @brief Header file of abcg::InputState.
+ *
+ * Declaration of abcg::InputState and input event helper functions.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_INPUT_HPP_
+#define ABCG_INPUT_HPP_
+
+#include <bitset>
+
+#include "abcgExternal.hpp"
+
+namespace abcg {
+class InputState;
+class Window;
+bool coalesceInputEvent(SDL_Event &event);
+} // namespace abcg
+
+/**
+ * @brief Snapshot of the keyboard and mouse state for a frame.
+ *
+ * The snapshot is built from the SDL events dispatched before the frame and
+ * does not change while the frame is being updated and painted. Events
+ * captured by Dear ImGui are not taken into account, except for key and
+ * button releases.
+ *
+ * @sa abcg::Window::getInputState.
+ */
+class abcg::InputState {
+public:
+  [[nodiscard]] bool isKeyDown(SDL_Scancode scancode) const noexcept;
+  [[nodiscard]] bool wasKeyPressed(SDL_Scancode scancode) const noexcept;
+  [[nodiscard]] bool wasKeyReleased(SDL_Scancode scancode) const noexcept;
+
+  [[nodiscard]] bool isMouseButtonDown(int button) const noexcept;
+  [[nodiscard]] bool wasMouseButtonPressed(int button) const noexcept;
+  [[nodiscard]] bool wasMouseButtonReleased(int button) const noexcept;
+
+  [[nodiscard]] glm::ivec2 getMousePosition() const noexcept;
+  [[nodiscard]] glm::ivec2 getMouseDelta() const noexcept;
+  [[nodiscard]] glm::vec2 getMouseWheel() const noexcept;
+
+private:
+  void accumulate(SDL_Event const &event, bool captured);
+  void beginFrame() noexcept;
+
+  static constexpr std::size_t m_maxMouseButtons{8};
+
+  std::bitset<SDL_NUM_SCANCODES> m_keysDown;
+  std::bitset<SDL_NUM_SCANCODES> m_keysPressed;
+  std::bitset<SDL_NUM_SCANCODES> m_keysReleased;
+  std::bitset<m_maxMouseButtons> m_buttonsDown;
+  std::bitset<m_maxMouseButtons> m_buttonsPressed;
+  std::bitset<m_maxMouseButtons> m_buttonsReleased;
+  glm::ivec2 m_mousePosition{};
+  glm::ivec2 m_mouseDelta{};
+  glm::vec2 m_mouseWheel{};
+
+  friend Window;
+};
+
+#endif
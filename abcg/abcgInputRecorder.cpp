@@ -0,0 +1,209 @@
+/**
+ * @file abcgInputRecorder.cpp
+ * @brief Definition of abcg::InputRecorder and abcg::InputReplayer members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgInputRecorder.hpp"
+
+#include <array>
+#include <string_view>
+
+#include "abcgException.hpp"
+
+namespace {
+constexpr std::array<char, 8> fileMagic{'A', 'B', 'C', 'G', 'I', 'N', 'P',
+                                        '1'};
+
+// Identifies the layout of the recorded events
+struct FileHeader {
+  std::array<char, 8> magic{};
+  std::uint32_t eventSize{};
+  std::uint8_t sdlMajor{};
+  std::uint8_t sdlMinor{};
+  std::uint8_t sdlPatch{};
+  std::uint8_t reserved{};
+};
+
+struct FrameHeader {
+  std::uint64_t frameIndex{};
+  double deltaTime{};
+  std::uint32_t numEvents{};
+  std::uint32_t reserved{};
+};
+
+FileHeader currentFileHeader() {
+  return {.magic = fileMagic,
+          .eventSize = sizeof(SDL_Event),
+          .sdlMajor = SDL_MAJOR_VERSION,
+          .sdlMinor = SDL_MINOR_VERSION,
+          .sdlPatch = SDL_PATCHLEVEL,
+          .reserved = 0};
+}
+
+template <typename T> void writeValue(std::FILE *file, T const &value) {
+  if (std::fwrite(&value, sizeof(T), 1, file) != 1) {
+    throw abcg::RuntimeError("Failed to write input recording");
+  }
+}
+
+template <typename T> bool readValue(std::FILE *file, T &value) {
+  return std::fread(&value, sizeof(T), 1, file) == 1;
+}
+
+std::unique_ptr<std::FILE, decltype(&std::fclose)>
+openFile(std::string const &path, char const *mode) {
+  std::unique_ptr<std::FILE, decltype(&std::fclose)> file{
+      std::fopen(path.c_str(), mode), &std::fclose};
+  if (!file) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to open input recording {}", path));
+  }
+  return file;
+}
+} // namespace
+
+/**
+ * @brief Creates the recording file and writes its header.
+ *
+ * @param path Path of the recording file.
+ *
+ * @throw abcg::RuntimeError if the file cannot be written.
+ */
+abcg::InputRecorder::InputRecorder(std::string const &path)
+    : m_file(openFile(path, "wb")) {
+  writeValue(m_file.get(), currentFileHeader());
+}
+
+/**
+ * @brief Returns whether an event is recorded.
+ *
+ * @param event SDL event.
+ *
+ * @return True for keyboard, mouse, controller and touch events that hold no
+ * pointers.
+ */
+bool abcg::InputRecorder::isRecordable(SDL_Event const &event) noexcept {
+#if SDL_VERSION_ATLEAST(2, 0, 22)
+  if (event.type == SDL_TEXTEDITING_EXT)
+    return false;
+#endif
+  return event.type >= SDL_KEYDOWN && event.type < SDL_CLIPBOARDUPDATE;
+}
+
+/**
+ * @brief Adds an event to the current frame.
+ *
+ * Events that are not recordable (see abcg::InputRecorder::isRecordable) are
+ * ignored.
+ *
+ * @param event SDL event, as dispatched to the window.
+ */
+void abcg::InputRecorder::recordEvent(SDL_Event const &event) {
+  if (isRecordable(event)) {
+    m_events.push_back(event);
+  }
+}
+
+/**
+ * @brief Writes the record of the current frame and starts a new one.
+ *
+ * @param deltaTime Time step of the frame, in seconds.
+ *
+ * @throw abcg::RuntimeError if the file cannot be written.
+ */
+void abcg::InputRecorder::endFrame(double deltaTime) {
+  auto const numEvents{gsl::narrow<std::uint32_t>(m_events.size())};
+  writeValue(m_file.get(), FrameHeader{.frameIndex = m_frameIndex,
+                                       .deltaTime = deltaTime,
+                                       .numEvents = numEvents,
+                                       .reserved = 0});
+  if (!m_events.empty() &&
+      std::fwrite(m_events.data(), sizeof(SDL_Event), m_events.size(),
+                  m_file.get()) != m_events.size()) {
+    throw abcg::RuntimeError("Failed to write input recording");
+  }
+  m_events.clear();
+  ++m_frameIndex;
+}
+
+/**
+ * @brief Opens a recording file and validates its header.
+ *
+ * @param path Path of the recording file.
+ *
+ * @throw abcg::RuntimeError if the file cannot be read or was recorded with
+ * an incompatible build.
+ */
+abcg::InputReplayer::InputReplayer(std::string const &path)
+    : m_file(openFile(path, "rb")), m_path(path) {
+  FileHeader header{};
+  auto const expected{currentFileHeader()};
+  if (!readValue(m_file.get(), header) || header.magic != expected.magic) {
+    throw abcg::RuntimeError(
+        fmt::format("{} is not an input recording", path));
+  }
+  if (header.eventSize != expected.eventSize ||
+      header.sdlMajor != expected.sdlMajor ||
+      header.sdlMinor != expected.sdlMinor) {
+    throw abcg::RuntimeError(
+        fmt::format("Input recording {} was made with an incompatible build "
+                    "(SDL {}.{}.{})",
+                    path, header.sdlMajor, header.sdlMinor, header.sdlPatch));
+  }
+}
+
+/**
+ * @brief Reads the record of the next frame.
+ *
+ * @return False if there are no more frames.
+ *
+ * @throw abcg::RuntimeError if the record is truncated.
+ */
+bool abcg::InputReplayer::nextFrame() {
+  FrameHeader header{};
+  if (!readValue(m_file.get(), header))
+    return false;
+
+  m_frameIndex = header.frameIndex;
+  m_deltaTime = header.deltaTime;
+  m_events.resize(header.numEvents);
+  if (std::fread(m_events.data(), sizeof(SDL_Event), m_events.size(),
+                 m_file.get()) != m_events.size()) {
+    throw abcg::RuntimeError(
+        fmt::format("Input recording {} is truncated", m_path));
+  }
+  return true;
+}
+
+/**
+ * @brief Returns the index of the current frame.
+ *
+ * @return Zero-based index of the frame in the recorded session.
+ */
+std::uint64_t abcg::InputReplayer::getFrameIndex() const noexcept {
+  return m_frameIndex;
+}
+
+/**
+ * @brief Returns the recorded time step of the current frame.
+ *
+ * @return Time step in seconds.
+ */
+double abcg::InputReplayer::getDeltaTime() const noexcept {
+  return m_deltaTime;
+}
+
+/**
+ * @brief Returns the recorded input events of the current frame.
+ *
+ * @return Events in the order they were dispatched.
+ */
+std::vector<SDL_Event> const &
+abcg::InputReplayer::getEvents() const noexcept {
+  return m_events;
+}
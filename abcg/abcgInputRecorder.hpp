@@ -0,0 +1,90 @@
+/**
+ * @file abcgInputRecorder.hpp
+ * @brief Header file of abcg::InputRecorder and abcg::InputReplayer.
+ *
+ * Declaration of abcg::InputRecorder and abcg::InputReplayer.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_INPUT_RECORDER_HPP_
+#define ABCG_INPUT_RECORDER_HPP_
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "abcgExternal.hpp"
+
+namespace abcg {
+class InputRecorder;
+class InputReplayer;
+} // namespace abcg
+
+/**
+ * @brief Records the input events of each frame to a binary file.
+ *
+ * The file starts with a header identifying the format, followed by one
+ * record per frame with the frame index, the time step of the frame and the
+ * input events dispatched before the frame. Events are stored as raw
+ * `SDL_Event` structures, so a recording can only be replayed by a build with
+ * the same SDL version and architecture.
+ *
+ * Only keyboard, mouse, controller and touch events are recorded. Window
+ * events, and events that hold pointers (e.g., drop and user events), are
+ * not recorded.
+ *
+ * The recorder is enabled with the `--record=<path>` command-line argument.
+ *
+ * @sa abcg::InputReplayer.
+ */
+class abcg::InputRecorder {
+public:
+  explicit InputRecorder(std::string const &path);
+
+  [[nodiscard]] static bool isRecordable(SDL_Event const &event) noexcept;
+
+  void recordEvent(SDL_Event const &event);
+  void endFrame(double deltaTime);
+
+private:
+  std::unique_ptr<std::FILE, decltype(&std::fclose)> m_file;
+  std::vector<SDL_Event> m_events;
+  std::uint64_t m_frameIndex{};
+};
+
+/**
+ * @brief Reads a file written by abcg::InputRecorder, one frame at a time.
+ *
+ * In replay mode, enabled with the `--replay=<path>` command-line argument,
+ * abcg::Application ignores the live input events and dispatches the
+ * recorded events of each frame instead. Each frame uses its recorded time
+ * step, so that the simulation evolves as in the recorded session. The
+ * application quits after the last recorded frame.
+ *
+ * @remark Dear ImGui may still read the live mouse position.
+ */
+class abcg::InputReplayer {
+public:
+  explicit InputReplayer(std::string const &path);
+
+  [[nodiscard]] bool nextFrame();
+
+  [[nodiscard]] std::uint64_t getFrameIndex() const noexcept;
+  [[nodiscard]] double getDeltaTime() const noexcept;
+  [[nodiscard]] std::vector<SDL_Event> const &getEvents() const noexcept;
+
+private:
+  std::unique_ptr<std::FILE, decltype(&std::fclose)> m_file;
+  std::string m_path;
+  std::vector<SDL_Event> m_events;
+  std::uint64_t m_frameIndex{};
+  double m_deltaTime{};
+};
+
+#endif
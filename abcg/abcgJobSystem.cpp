@@ -0,0 +1,284 @@
+/**
+ * @file abcgJobSystem.cpp
+ * @brief Definition of abcg::JobSystem and abcg::TaskGraph members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgJobSystem.hpp"
+
+#include "abcgException.hpp"
+#include "abcgExternal.hpp"
+#include "abcgProfiler.hpp"
+
+namespace {
+// Pool and queue index of the current thread, if it is a worker thread
+thread_local abcg::JobSystem const *currentPool{};
+thread_local std::size_t currentQueueIndex{};
+} // namespace
+
+/**
+ * @brief Adds a task to the graph.
+ *
+ * @param task Function to be called when the task runs.
+ * @param dependencies Identifiers of the tasks that must finish before this
+ * task starts.
+ *
+ * @return Identifier of the new task.
+ *
+ * @throw abcg::RuntimeError if a dependency is not a task of the graph.
+ */
+abcg::TaskGraph::TaskID
+abcg::TaskGraph::addTask(std::function<void()> task,
+                         std::vector<TaskID> const &dependencies) {
+  auto const id{m_nodes.size()};
+  for (auto const dependency : dependencies) {
+    if (dependency >= id) {
+      throw abcg::RuntimeError("Invalid task dependency");
+    }
+    m_nodes.at(dependency).successors.push_back(id);
+  }
+  m_nodes.push_back({.task = std::move(task),
+                     .successors = {},
+                     .numDependencies = dependencies.size()});
+  return id;
+}
+
+/**
+ * @brief Returns the number of tasks in the graph.
+ *
+ * @return Number of tasks.
+ */
+std::size_t abcg::TaskGraph::size() const noexcept { return m_nodes.size(); }
+
+/**
+ * @brief Constructs a job system with the given number of worker threads.
+ *
+ * @param numThreads Number of worker threads. If zero, all jobs run on the
+ * threads that wait for them.
+ */
+abcg::JobSystem::JobSystem(std::size_t numThreads) : m_numThreads(numThreads) {
+#if defined(__EMSCRIPTEN__)
+  m_numThreads = 0;
+#endif
+
+  for (std::size_t index{}; index <= m_numThreads; ++index) {
+    m_queues.push_back(std::make_unique<WorkerQueue>());
+  }
+
+  m_threads.reserve(m_numThreads);
+  for (std::size_t index{}; index < m_numThreads; ++index) {
+    m_threads.emplace_back([this, index]() { workerLoop(index); });
+  }
+}
+
+/**
+ * @brief Destroys the job system.
+ *
+ * Pending jobs are run before the worker threads are joined.
+ */
+abcg::JobSystem::~JobSystem() {
+  {
+    std::lock_guard const lock{m_sleepMutex};
+    m_stopping = true;
+  }
+  m_wakeUp.notify_all();
+  for (auto &thread : m_threads) {
+    thread.join();
+  }
+}
+
+/**
+ * @brief Returns the default number of worker threads.
+ *
+ * @return Number of hardware threads minus one, to account for the main
+ * thread, which also runs jobs while waiting for them.
+ */
+std::size_t abcg::JobSystem::defaultNumThreads() noexcept {
+  auto const hardwareThreads{std::thread::hardware_concurrency()};
+  return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+
+/**
+ * @brief Returns the number of worker threads.
+ *
+ * @return Number of worker threads of the pool.
+ */
+std::size_t abcg::JobSystem::getNumThreads() const noexcept {
+  return m_numThreads;
+}
+
+/**
+ * @brief Runs all tasks of a task graph and waits for them to finish.
+ *
+ * Tasks without pending dependencies run in parallel.
+ *
+ * @param graph Task graph.
+ *
+ * @throw Rethrows the first exception thrown by a task, after all tasks have
+ * finished. The successors of a task that threw are still run.
+ */
+void abcg::JobSystem::run(TaskGraph &graph) {
+  auto &nodes{graph.m_nodes};
+  if (nodes.empty())
+    return;
+
+  std::vector<std::atomic<std::size_t>> remainingDependencies(nodes.size());
+  for (auto const id : iter::range(nodes.size())) {
+    remainingDependencies.at(id) = nodes.at(id).numDependencies;
+  }
+  std::atomic<std::size_t> unfinished{nodes.size()};
+  ExceptionSlot exception;
+
+  std::function<void(TaskGraph::TaskID)> schedule;
+  schedule = [&](TaskGraph::TaskID id) {
+    push([&, id]() {
+      auto &node{nodes.at(id)};
+      try {
+        node.task();
+      } catch (...) {
+        exception.store(std::current_exception());
+      }
+      for (auto const successor : node.successors) {
+        if (remainingDependencies.at(successor).fetch_sub(
+                1, std::memory_order_acq_rel) == 1) {
+          schedule(successor);
+        }
+      }
+      unfinished.fetch_sub(1, std::memory_order_acq_rel);
+    });
+  };
+
+  for (auto const id : iter::range(nodes.size())) {
+    if (nodes.at(id).numDependencies == 0) {
+      schedule(id);
+    }
+  }
+  helpUntil([&unfinished]() {
+    return unfinished.load(std::memory_order_acquire) == 0;
+  });
+  exception.rethrow();
+}
+
+void abcg::JobSystem::ExceptionSlot::store(std::exception_ptr exception) {
+  std::lock_guard const lock{m_mutex};
+  if (!m_exception) {
+    m_exception = std::move(exception);
+  }
+}
+
+void abcg::JobSystem::ExceptionSlot::rethrow() {
+  if (m_exception) {
+    std::rethrow_exception(m_exception);
+  }
+}
+
+void abcg::JobSystem::push(Job job) {
+  if (m_numThreads == 0) {
+    // No workers: run on the calling thread
+    job();
+    return;
+  }
+
+  m_pendingJobs.fetch_add(1, std::memory_order_acq_rel);
+  {
+    auto &queue{*m_queues.at(getQueueIndex())};
+    std::lock_guard const lock{queue.mutex};
+    queue.jobs.push_back(std::move(job));
+  }
+  {
+    // Synchronize with workers that are about to sleep
+    std::lock_guard const lock{m_sleepMutex};
+  }
+  m_wakeUp.notify_one();
+  if (m_numHelpersWaiting.load() > 0) {
+    m_progress.notify_all();
+  }
+}
+
+// Runs a job from the queue of the current thread or, if it is empty, a job
+// stolen from another queue. Returns false if there was no job to run.
+bool abcg::JobSystem::tryRunJob() {
+  if (m_pendingJobs.load(std::memory_order_acquire) == 0)
+    return false;
+
+  auto const self{getQueueIndex()};
+  Job job;
+  {
+    // Own queue: last in, first out
+    auto &queue{*m_queues.at(self)};
+    std::lock_guard const lock{queue.mutex};
+    if (!queue.jobs.empty()) {
+      job = std::move(queue.jobs.back());
+      queue.jobs.pop_back();
+    }
+  }
+  for (std::size_t offset{1}; !job && offset < m_queues.size(); ++offset) {
+    // Other queues: first in, first out
+    auto &queue{*m_queues.at((self + offset) % m_queues.size())};
+    std::lock_guard const lock{queue.mutex};
+    if (!queue.jobs.empty()) {
+      job = std::move(queue.jobs.front());
+      queue.jobs.pop_front();
+    }
+  }
+  if (!job)
+    return false;
+
+  m_pendingJobs.fetch_sub(1, std::memory_order_acq_rel);
+  job();
+
+  // The job may have completed what a thread in helpUntil is waiting for.
+  // Pairs with the fence in helpUntil, so that either the waiting thread
+  // sees the effects of the job or the counter of waiting threads is seen.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (m_numHelpersWaiting.load() > 0) {
+    {
+      std::lock_guard const lock{m_sleepMutex};
+    }
+    m_progress.notify_all();
+  }
+  return true;
+}
+
+// Runs pending jobs until done returns true. When there is no job left to
+// run, blocks until another thread finishes or pushes a job.
+void abcg::JobSystem::helpUntil(std::function<bool()> const &done) {
+  while (!done()) {
+    if (tryRunJob())
+      continue;
+
+    std::unique_lock lock{m_sleepMutex};
+    m_numHelpersWaiting.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    m_progress.wait(lock, [this, &done]() {
+      return done() || m_pendingJobs.load(std::memory_order_acquire) > 0;
+    });
+    m_numHelpersWaiting.fetch_sub(1);
+  }
+}
+
+void abcg::JobSystem::workerLoop(std::size_t index) {
+  currentPool = this;
+  currentQueueIndex = index;
+  Profiler::setThreadName(fmt::format("Worker {}", index));
+
+  while (true) {
+    if (tryRunJob())
+      continue;
+
+    std::unique_lock lock{m_sleepMutex};
+    m_wakeUp.wait(lock, [this]() {
+      return m_stopping || m_pendingJobs.load(std::memory_order_acquire) > 0;
+    });
+    if (m_stopping && m_pendingJobs.load(std::memory_order_acquire) == 0)
+      return;
+  }
+}
+
+std::size_t abcg::JobSystem::getQueueIndex() const noexcept {
+  return currentPool == this ? currentQueueIndex : m_numThreads;
+}
@@ -0,0 +1,232 @@
+/**
+ * @file abcgJobSystem.hpp
+ * @brief Header file of abcg::JobSystem.
+ *
+ * Declaration of abcg::JobSystem and abcg::TaskGraph.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_JOB_SYSTEM_HPP_
+#define ABCG_JOB_SYSTEM_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace abcg {
+class JobSystem;
+class TaskGraph;
+} // namespace abcg
+
+/**
+ * @brief Represents a set of tasks with dependencies between them.
+ *
+ * Tasks are added with abcg::TaskGraph::addTask and run with
+ * abcg::JobSystem::run. A task only starts after all its dependencies have
+ * finished. Since a task can only depend on tasks added before it, the graph
+ * is always acyclic.
+ *
+ * A graph can be run several times.
+ */
+class abcg::TaskGraph {
+public:
+  /** @brief Identifier of a task in the graph. */
+  using TaskID = std::size_t;
+
+  TaskID addTask(std::function<void()> task,
+                 std::vector<TaskID> const &dependencies = {});
+
+  [[nodiscard]] std::size_t size() const noexcept;
+
+private:
+  struct Node {
+    std::function<void()> task;
+    std::vector<TaskID> successors;
+    std::size_t numDependencies{};
+  };
+
+  std::vector<Node> m_nodes;
+
+  friend JobSystem;
+};
+
+/**
+ * @brief Work-stealing thread pool.
+ *
+ * Each worker thread has its own queue of jobs. Workers take jobs from the
+ * back of their own queue and, when it is empty, steal jobs from the front of
+ * the queues of other workers. Jobs submitted from threads that are not
+ * workers of the pool are pushed to a shared queue.
+ *
+ * The functions that wait for jobs (abcg::JobSystem::parallelFor,
+ * abcg::JobSystem::run and abcg::JobSystem::wait) execute pending jobs while
+ * they wait, so they can be safely called from within jobs.
+ *
+ * An instance is owned by abcg::Application and can be accessed with
+ * abcg::Window::getJobSystem.
+ *
+ * @remark On WebAssembly, the pool has no worker threads and all jobs run on
+ * the calling thread.
+ */
+class abcg::JobSystem {
+public:
+  explicit JobSystem(std::size_t numThreads = defaultNumThreads());
+  ~JobSystem();
+
+  JobSystem(JobSystem const &) = delete;
+  JobSystem(JobSystem &&) = delete;
+  JobSystem &operator=(JobSystem const &) = delete;
+  JobSystem &operator=(JobSystem &&) = delete;
+
+  [[nodiscard]] static std::size_t defaultNumThreads() noexcept;
+  [[nodiscard]] std::size_t getNumThreads() const noexcept;
+
+  /**
+   * @brief Submits a function to be run asynchronously.
+   *
+   * @param function Function to be called with no arguments.
+   *
+   * @return Future that holds the value returned by @a function, or the
+   * exception thrown by it.
+   *
+   * @sa abcg::JobSystem::wait.
+   */
+  template <typename TFun>
+  [[nodiscard]] auto submit(TFun &&function)
+      -> std::future<std::invoke_result_t<std::decay_t<TFun>>> {
+    using Result = std::invoke_result_t<std::decay_t<TFun>>;
+    auto task{std::make_shared<std::packaged_task<Result()>>(
+        std::forward<TFun>(function))};
+    auto future{task->get_future()};
+    push([task]() { (*task)(); });
+    return future;
+  }
+
+  /**
+   * @brief Waits for a future while running pending jobs.
+   *
+   * Prefer this over `std::future::wait` when waiting from within a job, as
+   * blocking a worker thread may starve the pool.
+   *
+   * @param future Future returned by abcg::JobSystem::submit.
+   */
+  template <typename T> void wait(std::future<T> const &future) {
+    helpUntil([&future]() {
+      return future.wait_for(std::chrono::seconds::zero()) ==
+             std::future_status::ready;
+    });
+  }
+
+  /**
+   * @brief Calls a function for each index of a range, in parallel.
+   *
+   * The range is split into chunks of at least @a grainSize indices, which are
+   * run as jobs. The calling thread also runs chunks and returns when all of
+   * them have finished.
+   *
+   * @param first First index of the range.
+   * @param last One past the last index of the range.
+   * @param function Function to be called with each index of the range.
+   * @param grainSize Minimum number of indices per chunk. If zero, the range
+   * is split into about four chunks per thread.
+   *
+   * @throw Rethrows the first exception thrown by @a function, after all
+   * chunks have finished.
+   */
+  template <typename TFun>
+  void parallelFor(std::size_t first, std::size_t last, TFun &&function,
+                   std::size_t grainSize = 0) {
+    if (first >= last)
+      return;
+
+    auto const count{last - first};
+    if (grainSize == 0) {
+      grainSize = std::max<std::size_t>(1, count / ((m_numThreads + 1) * 4));
+    }
+    auto const numChunks{(count + grainSize - 1) / grainSize};
+    if (numChunks == 1 || m_numThreads == 0) {
+      for (auto index{first}; index < last; ++index) {
+        function(index);
+      }
+      return;
+    }
+
+    std::atomic<std::size_t> remaining{numChunks};
+    ExceptionSlot exception;
+    for (std::size_t chunk{}; chunk < numChunks; ++chunk) {
+      auto const chunkFirst{first + chunk * grainSize};
+      auto const chunkLast{std::min(chunkFirst + grainSize, last)};
+      push([&, chunkFirst, chunkLast]() {
+        try {
+          for (auto index{chunkFirst}; index < chunkLast; ++index) {
+            function(index);
+          }
+        } catch (...) {
+          exception.store(std::current_exception());
+        }
+        remaining.fetch_sub(1, std::memory_order_acq_rel);
+      });
+    }
+    helpUntil([&remaining]() {
+      return remaining.load(std::memory_order_acquire) == 0;
+    });
+    exception.rethrow();
+  }
+
+  void run(TaskGraph &graph);
+
+private:
+  using Job = std::function<void()>;
+
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<Job> jobs;
+  };
+
+  // Keeps the first exception thrown by concurrent jobs
+  class ExceptionSlot {
+  public:
+    void store(std::exception_ptr exception);
+    void rethrow();
+
+  private:
+    std::mutex m_mutex;
+    std::exception_ptr m_exception;
+  };
+
+  void push(Job job);
+  bool tryRunJob();
+  void helpUntil(std::function<bool()> const &done);
+  void workerLoop(std::size_t index);
+  [[nodiscard]] std::size_t getQueueIndex() const noexcept;
+
+  std::size_t m_numThreads{};
+  // One queue per worker, plus a shared queue for external threads (last)
+  std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+  std::vector<std::thread> m_threads;
+
+  std::atomic<std::size_t> m_pendingJobs{};
+  std::atomic<bool> m_stopping{};
+  std::mutex m_sleepMutex;
+  std::condition_variable m_wakeUp;
+  // Threads blocked in helpUntil, woken up when a job finishes or is pushed
+  std::atomic<std::size_t> m_numHelpersWaiting{};
+  std::condition_variable m_progress;
+};
+
+#endif
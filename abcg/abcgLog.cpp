@@ -0,0 +1,225 @@
+/**
+ * @file abcgLog.cpp
+ * @brief Definition of abcg::Log members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgLog.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "abcgExternal.hpp"
+#include "abcgUtil.hpp"
+
+namespace {
+// Log level set at runtime
+std::atomic<abcg::LogLevel> runtimeLevel{abcg::Log::compileTimeLevel};
+
+// Writes a message to the standard output or error, depending on its level
+void writeMessage(abcg::LogLevel level, std::string_view message) {
+  switch (level) {
+  case abcg::LogLevel::Warning:
+    fmt::print(stderr, "{}: {}\n", abcg::toYellowString("Warning"), message);
+    break;
+  case abcg::LogLevel::Error:
+    fmt::print(stderr, "{}: {}\n", abcg::toRedString("Error"), message);
+    break;
+  default:
+    fmt::print("{}\n", message);
+    break;
+  }
+}
+
+#if !defined(__EMSCRIPTEN__)
+// Bounded multi-producer single-consumer ring buffer of messages, based on
+// Dmitry Vyukov's bounded MPMC queue. Each slot holds a chunk of a message;
+// longer messages are split across consecutive slots reserved at once, so
+// that chunks of different messages never interleave.
+class LogRing {
+public:
+  LogRing() : m_slots(numSlots) {
+    for (auto const index : iter::range(numSlots)) {
+      m_slots.at(index).sequence.store(index, std::memory_order_relaxed);
+    }
+    m_thread = std::thread([this]() { drainLoop(); });
+  }
+
+  ~LogRing() {
+    m_stop = true;
+    m_wakeUp.notify_one();
+    m_thread.join();
+  }
+
+  LogRing(LogRing const &) = delete;
+  LogRing(LogRing &&) = delete;
+  LogRing &operator=(LogRing const &) = delete;
+  LogRing &operator=(LogRing &&) = delete;
+
+  void push(abcg::LogLevel level, std::string_view message) {
+    message = message.substr(0, numSlots * slotTextSize);
+    auto const count{
+        std::max<std::size_t>(1, (message.size() + slotTextSize - 1) /
+                                     slotTextSize)};
+
+    // Reserve `count` consecutive slots. Slots are released in order, so the
+    // last one being free implies that the others are free too.
+    auto position{m_enqueuePosition.load(std::memory_order_relaxed)};
+    while (true) {
+      auto const lastPosition{position + count - 1};
+      auto const sequence{
+          slotAt(lastPosition).sequence.load(std::memory_order_acquire)};
+      if (sequence == lastPosition) {
+        if (m_enqueuePosition.compare_exchange_weak(
+                position, position + count, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (sequence < lastPosition) {
+        // Full: wait for the drain thread
+        std::this_thread::yield();
+        position = m_enqueuePosition.load(std::memory_order_relaxed);
+      } else {
+        position = m_enqueuePosition.load(std::memory_order_relaxed);
+      }
+    }
+
+    for (auto const chunk : iter::range(count)) {
+      auto &slot{slotAt(position + chunk)};
+      auto const text{message.substr(chunk * slotTextSize, slotTextSize)};
+      slot.level = level;
+      slot.size = text.size();
+      slot.last = chunk + 1 == count;
+      std::copy(text.begin(), text.end(), slot.text.begin());
+      slot.sequence.store(position + chunk + 1, std::memory_order_release);
+    }
+  }
+
+  void flush() {
+    auto const target{m_enqueuePosition.load(std::memory_order_acquire)};
+    m_wakeUp.notify_one();
+    while (m_dequeuePosition.load(std::memory_order_acquire) < target) {
+      std::this_thread::yield();
+    }
+  }
+
+private:
+  static constexpr std::size_t numSlots{1024};
+  static constexpr std::size_t slotTextSize{240};
+
+  struct Slot {
+    std::atomic<std::size_t> sequence{};
+    abcg::LogLevel level{};
+    std::size_t size{};
+    bool last{};
+    std::array<char, slotTextSize> text{};
+  };
+
+  Slot &slotAt(std::size_t position) {
+    return m_slots.at(position % numSlots);
+  }
+
+  // Consumes the next chunk, if available. Returns false if the ring is empty.
+  bool drainChunk() {
+    auto const position{m_dequeuePosition.load(std::memory_order_relaxed)};
+    auto &slot{slotAt(position)};
+    if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+      return false;
+
+    m_message.append(slot.text.data(), slot.size);
+    auto const level{slot.level};
+    auto const last{slot.last};
+    slot.sequence.store(position + numSlots, std::memory_order_release);
+
+    if (last) {
+      writeMessage(level, m_message);
+      m_message.clear();
+    }
+    m_dequeuePosition.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  void drainLoop() {
+    using namespace std::chrono_literals;
+    while (true) {
+      auto drained{false};
+      while (drainChunk()) {
+        drained = true;
+      }
+      if (drained) {
+        std::fflush(stdout);
+      }
+      if (m_stop)
+        return;
+
+      // Producers do not notify, to keep logging free of system calls; poll
+      // at a rate that is fine for diagnostics instead
+      std::unique_lock lock{m_wakeMutex};
+      m_wakeUp.wait_for(lock, 5ms);
+    }
+  }
+
+  std::vector<Slot> m_slots;
+  std::atomic<std::size_t> m_enqueuePosition{};
+  std::atomic<std::size_t> m_dequeuePosition{};
+  // Message being assembled from chunks by the drain thread
+  std::string m_message;
+
+  std::atomic<bool> m_stop{};
+  std::mutex m_wakeMutex;
+  std::condition_variable m_wakeUp;
+  std::thread m_thread;
+};
+
+LogRing &getLogRing() {
+  static LogRing ring;
+  return ring;
+}
+#endif
+} // namespace
+
+/**
+ * @brief Sets the minimum severity level of the messages that are logged.
+ *
+ * Messages below abcg::Log::compileTimeLevel are never logged, regardless of
+ * this setting.
+ *
+ * @param level Minimum severity level.
+ */
+void abcg::Log::setLevel(LogLevel level) noexcept { runtimeLevel = level; }
+
+/**
+ * @brief Returns the minimum severity level of the messages that are logged.
+ *
+ * @return Minimum severity level set with abcg::Log::setLevel.
+ */
+abcg::LogLevel abcg::Log::getLevel() noexcept { return runtimeLevel; }
+
+/**
+ * @brief Waits until all messages logged so far are written.
+ */
+void abcg::Log::flush() {
+#if !defined(__EMSCRIPTEN__)
+  getLogRing().flush();
+#endif
+  std::fflush(stdout);
+}
+
+void abcg::Log::push(LogLevel level, std::string_view message) {
+#if defined(__EMSCRIPTEN__)
+  writeMessage(level, message);
+#else
+  getLogRing().push(level, message);
+#endif
+}
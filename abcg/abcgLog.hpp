@@ -0,0 +1,151 @@
+/**
+ * @file abcgLog.hpp
+ * @brief Header file of abcg::Log.
+ *
+ * Declaration of abcg::Log and abcg::LogLevel.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_LOG_HPP_
+#define ABCG_LOG_HPP_
+
+#include <iterator>
+#include <string_view>
+#include <utility>
+
+#include <fmt/format.h>
+
+/**
+ * @brief Minimum severity level of the messages compiled into the program.
+ *
+ * Messages of lower severity are removed at compile time. The value is an
+ * integer corresponding to an abcg::LogLevel enumerator. Defaults to
+ * abcg::LogLevel::Info in release builds and abcg::LogLevel::Debug otherwise.
+ */
+#if !defined(ABCG_LOG_LEVEL)
+#if defined(NDEBUG)
+#define ABCG_LOG_LEVEL 2
+#else
+#define ABCG_LOG_LEVEL 1
+#endif
+#endif
+
+namespace abcg {
+class Log;
+
+/**
+ * @brief Severity level of a log message.
+ */
+enum class LogLevel { Trace, Debug, Info, Warning, Error, Off };
+} // namespace abcg
+
+/**
+ * @brief Asynchronous logger.
+ *
+ * Messages are formatted on the calling thread with the `fmt` library and
+ * pushed to a lock-free ring buffer, which is drained by a background thread
+ * that writes them to the standard output (abcg::LogLevel::Info and below) or
+ * to the standard error (abcg::LogLevel::Warning and above). Logging from the
+ * render loop or from worker threads therefore does not wait for terminal
+ * I/O, unless the ring buffer is full.
+ *
+ * Call abcg::Log::flush before throwing an exception whose message should
+ * appear after the messages already logged.
+ *
+ * @code
+ * abcg::Log::info("Loaded {} vertices", vertices.size());
+ * abcg::Log::warning("Texture {} not found", path);
+ * @endcode
+ *
+ * @remark On WebAssembly, messages are written synchronously.
+ */
+class abcg::Log {
+public:
+  /** @brief Minimum severity level compiled into the program. */
+  static constexpr LogLevel compileTimeLevel{
+      static_cast<LogLevel>(ABCG_LOG_LEVEL)};
+
+  Log() = delete;
+
+  /**
+   * @brief Logs a message of abcg::LogLevel::Trace severity.
+   *
+   * @param format Format string in the `fmt` syntax.
+   * @param args Arguments to be formatted.
+   */
+  template <typename... Args>
+  static void trace(fmt::format_string<Args...> format, Args &&...args) {
+    write<LogLevel::Trace>(format, std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief Logs a message of abcg::LogLevel::Debug severity.
+   *
+   * @param format Format string in the `fmt` syntax.
+   * @param args Arguments to be formatted.
+   */
+  template <typename... Args>
+  static void debug(fmt::format_string<Args...> format, Args &&...args) {
+    write<LogLevel::Debug>(format, std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief Logs a message of abcg::LogLevel::Info severity.
+   *
+   * @param format Format string in the `fmt` syntax.
+   * @param args Arguments to be formatted.
+   */
+  template <typename... Args>
+  static void info(fmt::format_string<Args...> format, Args &&...args) {
+    write<LogLevel::Info>(format, std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief Logs a message of abcg::LogLevel::Warning severity.
+   *
+   * @param format Format string in the `fmt` syntax.
+   * @param args Arguments to be formatted.
+   */
+  template <typename... Args>
+  static void warning(fmt::format_string<Args...> format, Args &&...args) {
+    write<LogLevel::Warning>(format, std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief Logs a message of abcg::LogLevel::Error severity.
+   *
+   * @param format Format string in the `fmt` syntax.
+   * @param args Arguments to be formatted.
+   */
+  template <typename... Args>
+  static void error(fmt::format_string<Args...> format, Args &&...args) {
+    write<LogLevel::Error>(format, std::forward<Args>(args)...);
+  }
+
+  static void setLevel(LogLevel level) noexcept;
+  [[nodiscard]] static LogLevel getLevel() noexcept;
+  static void flush();
+
+private:
+  template <LogLevel level, typename... Args>
+  static void write(fmt::format_string<Args...> format, Args &&...args) {
+    if constexpr (level >= compileTimeLevel && level != LogLevel::Off) {
+      if (level < getLevel())
+        return;
+
+      // Short messages are formatted without heap allocations
+      fmt::memory_buffer buffer;
+      fmt::format_to(std::back_inserter(buffer), format,
+                     std::forward<Args>(args)...);
+      push(level, std::string_view{buffer.data(), buffer.size()});
+    }
+  }
+
+  static void push(LogLevel level, std::string_view message);
+};
+
+#endif
@@ -0,0 +1,493 @@
+/**
+ * @file abcgMetrics.cpp
+ * @brief Definition of abcg::Metrics and abcg::MetricsExporter members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgMetrics.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <utility>
+
+#if !defined(WIN32) && !defined(__EMSCRIPTEN__)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "abcgException.hpp"
+#include "abcgExternal.hpp"
+#include "abcgLog.hpp"
+
+namespace {
+template <typename T>
+using MetricMap = std::map<std::string, std::unique_ptr<T>, std::less<>>;
+
+struct Registry {
+  std::mutex mutex;
+  MetricMap<abcg::Metrics::Counter> counters;
+  MetricMap<abcg::Metrics::Gauge> gauges;
+  MetricMap<abcg::Metrics::Histogram> histograms;
+};
+
+Registry &registry() {
+  static Registry instance;
+  return instance;
+}
+
+// Returns the metric with the given name, creating it if needed
+template <typename T, typename... Args>
+T &findOrCreate(MetricMap<T> &map, std::string_view name, Args &&...args) {
+  std::lock_guard const lock{registry().mutex};
+  auto iter{map.find(name)};
+  if (iter == map.end()) {
+    iter = map.emplace(std::string{name},
+                       std::make_unique<T>(std::forward<Args>(args)...))
+               .first;
+  }
+  return *iter->second;
+}
+
+void atomicAdd(std::atomic<double> &target, double value) noexcept {
+  auto current{target.load(std::memory_order_relaxed)};
+  while (!target.compare_exchange_weak(current, current + value,
+                                       std::memory_order_relaxed)) {
+  }
+}
+
+// JSON has no representation for infinities and NaNs
+void formatJSONNumber(std::string &output, double value) {
+  if (std::isfinite(value)) {
+    fmt::format_to(std::back_inserter(output), "{}", value);
+  } else {
+    output += "null";
+  }
+}
+
+double unixTime() {
+  return std::chrono::duration<double>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+// Samples the resident set size of the process, where supported
+void sampleResidentBytes() {
+#if defined(__linux__)
+  static auto &residentBytes{abcg::Metrics::gauge("process.resident_bytes")};
+  std::ifstream statm{"/proc/self/statm"};
+  std::size_t totalPages{};
+  std::size_t residentPages{};
+  if (statm >> totalPages >> residentPages) {
+    residentBytes.set(static_cast<double>(residentPages) *
+                      static_cast<double>(sysconf(_SC_PAGESIZE)));
+  }
+#endif
+}
+
+#if !defined(WIN32) && !defined(__EMSCRIPTEN__)
+#if defined(MSG_NOSIGNAL)
+// Do not raise SIGPIPE if the peer closes the connection
+constexpr int sendFlags{MSG_NOSIGNAL};
+#else
+constexpr int sendFlags{0};
+#endif
+#endif
+
+constexpr std::string_view socketPrefix{"unix:"};
+} // namespace
+
+/**
+ * @brief Adds a value to the counter.
+ *
+ * @param value Value to add.
+ */
+void abcg::Metrics::Counter::add(std::uint64_t value) noexcept {
+  m_value.fetch_add(value, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Returns the value of the counter.
+ *
+ * @return Sum of the added values.
+ */
+std::uint64_t abcg::Metrics::Counter::get() const noexcept {
+  return m_value.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Sets the value of the gauge.
+ *
+ * @param value New value.
+ */
+void abcg::Metrics::Gauge::set(double value) noexcept {
+  m_value.store(value, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Adds a value, possibly negative, to the gauge.
+ *
+ * @param value Value to add.
+ */
+void abcg::Metrics::Gauge::add(double value) noexcept {
+  atomicAdd(m_value, value);
+}
+
+/**
+ * @brief Returns the value of the gauge.
+ *
+ * @return Last value set.
+ */
+double abcg::Metrics::Gauge::get() const noexcept {
+  return m_value.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Constructs a histogram with the given buckets.
+ *
+ * @param bounds Upper bounds, in increasing order, of the buckets. Values
+ * greater than the last bound are counted in an extra bucket.
+ */
+abcg::Metrics::Histogram::Histogram(std::span<double const> bounds)
+    : m_bounds(bounds.begin(), bounds.end()), m_buckets(bounds.size() + 1) {}
+
+/**
+ * @brief Adds a value to the distribution.
+ *
+ * @param value Value to add.
+ */
+void abcg::Metrics::Histogram::record(double value) noexcept {
+  auto const bucket{std::ranges::lower_bound(m_bounds, value) -
+                    m_bounds.begin()};
+  m_buckets[gsl::narrow_cast<std::size_t>(bucket)].fetch_add(
+      1, std::memory_order_relaxed);
+  m_count.fetch_add(1, std::memory_order_relaxed);
+  atomicAdd(m_sum, value);
+}
+
+/**
+ * @brief Returns the upper bounds of the buckets.
+ *
+ * @return Bounds given at construction.
+ */
+std::span<double const> abcg::Metrics::Histogram::getBounds() const noexcept {
+  return m_bounds;
+}
+
+/**
+ * @brief Returns the number of values in each bucket.
+ *
+ * @return Counts of the buckets, plus the count of values above the last
+ * bound.
+ */
+std::vector<std::uint64_t> abcg::Metrics::Histogram::getBucketCounts() const {
+  std::vector<std::uint64_t> counts;
+  counts.reserve(m_buckets.size());
+  for (auto const &bucket : m_buckets) {
+    counts.push_back(bucket.load(std::memory_order_relaxed));
+  }
+  return counts;
+}
+
+/**
+ * @brief Returns the number of recorded values.
+ *
+ * @return Number of calls to abcg::Metrics::Histogram::record.
+ */
+std::uint64_t abcg::Metrics::Histogram::getCount() const noexcept {
+  return m_count.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Returns the sum of the recorded values.
+ *
+ * @return Sum of the values.
+ */
+double abcg::Metrics::Histogram::getSum() const noexcept {
+  return m_sum.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Returns the counter with the given name, creating it if needed.
+ *
+ * @param name Name of the counter.
+ *
+ * @return Reference to the counter, valid until the program ends.
+ */
+abcg::Metrics::Counter &abcg::Metrics::counter(std::string_view name) {
+  return findOrCreate(registry().counters, name);
+}
+
+/**
+ * @brief Returns the gauge with the given name, creating it if needed.
+ *
+ * @param name Name of the gauge.
+ *
+ * @return Reference to the gauge, valid until the program ends.
+ */
+abcg::Metrics::Gauge &abcg::Metrics::gauge(std::string_view name) {
+  return findOrCreate(registry().gauges, name);
+}
+
+/**
+ * @brief Returns the histogram with the given name, creating it if needed.
+ *
+ * @param name Name of the histogram.
+ * @param bounds Upper bounds, in increasing order, of the buckets. Ignored if
+ * the histogram already exists.
+ *
+ * @return Reference to the histogram, valid until the program ends.
+ */
+abcg::Metrics::Histogram &
+abcg::Metrics::histogram(std::string_view name,
+                         std::span<double const> bounds) {
+  return findOrCreate(registry().histograms, name, bounds);
+}
+
+/**
+ * @brief Appends a snapshot of all metrics as a single line of JSON.
+ *
+ * @param output String to which the snapshot is appended.
+ * @param timestamp Time of the snapshot, in seconds since the Unix epoch.
+ */
+void abcg::Metrics::formatJSON(std::string &output, double timestamp) {
+  auto &metrics{registry()};
+  std::lock_guard const lock{metrics.mutex};
+  auto const out{std::back_inserter(output)};
+
+  fmt::format_to(out, R"({{"timestamp":{:.3f},"counters":{{)", timestamp);
+  std::string_view separator;
+  for (auto const &[name, counter] : metrics.counters) {
+    fmt::format_to(out, "{}{:?}:{}", separator, name, counter->get());
+    separator = ",";
+  }
+
+  output += R"(},"gauges":{)";
+  separator = "";
+  for (auto const &[name, gauge] : metrics.gauges) {
+    fmt::format_to(out, "{}{:?}:", separator, name);
+    formatJSONNumber(output, gauge->get());
+    separator = ",";
+  }
+
+  output += R"(},"histograms":{)";
+  separator = "";
+  for (auto const &[name, histogram] : metrics.histograms) {
+    fmt::format_to(out, R"({}{:?}:{{"count":{},"sum":)", separator, name,
+                   histogram->getCount());
+    formatJSONNumber(output, histogram->getSum());
+    output += R"(,"bounds":[)";
+    for (auto const [index, bound] : iter::enumerate(histogram->getBounds())) {
+      output += index == 0 ? "" : ",";
+      formatJSONNumber(output, bound);
+    }
+    output += R"(],"counts":[)";
+    for (auto const [index, count] :
+         iter::enumerate(histogram->getBucketCounts())) {
+      fmt::format_to(out, "{}{}", index == 0 ? "" : ",", count);
+    }
+    output += "]}";
+    separator = ",";
+  }
+  output += "}}\n";
+}
+
+/**
+ * @brief Appends a snapshot of all metrics as CSV rows.
+ *
+ * Each row has the format `timestamp,type,name,value`. Histograms produce one
+ * row for the count (`<name>.count`), one for the sum (`<name>.sum`) and one
+ * for each bucket (`<name>.le_<bound>`, and `<name>.le_inf` for the values
+ * above the last bound).
+ *
+ * @param output String to which the snapshot is appended.
+ * @param timestamp Time of the snapshot, in seconds since the Unix epoch.
+ */
+void abcg::Metrics::formatCSV(std::string &output, double timestamp) {
+  auto &metrics{registry()};
+  std::lock_guard const lock{metrics.mutex};
+  auto const out{std::back_inserter(output)};
+
+  for (auto const &[name, counter] : metrics.counters) {
+    fmt::format_to(out, "{:.3f},counter,{},{}\n", timestamp, name,
+                   counter->get());
+  }
+  for (auto const &[name, gauge] : metrics.gauges) {
+    fmt::format_to(out, "{:.3f},gauge,{},{}\n", timestamp, name, gauge->get());
+  }
+  for (auto const &[name, histogram] : metrics.histograms) {
+    fmt::format_to(out, "{:.3f},histogram,{}.count,{}\n", timestamp, name,
+                   histogram->getCount());
+    fmt::format_to(out, "{:.3f},histogram,{}.sum,{}\n", timestamp, name,
+                   histogram->getSum());
+    auto const bounds{histogram->getBounds()};
+    for (auto const [index, count] :
+         iter::enumerate(histogram->getBucketCounts())) {
+      if (index < bounds.size()) {
+        fmt::format_to(out, "{:.3f},histogram,{}.le_{},{}\n", timestamp, name,
+                       bounds[index], count);
+      } else {
+        fmt::format_to(out, "{:.3f},histogram,{}.le_inf,{}\n", timestamp, name,
+                       count);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Opens the destination and starts the export thread.
+ *
+ * @param settings Exporter settings.
+ *
+ * @throw abcg::RuntimeError if the file cannot be opened, if the socket
+ * cannot be connected, or if Unix domain sockets are not supported.
+ */
+abcg::MetricsExporter::MetricsExporter(MetricsExporterSettings settings)
+    : m_settings(std::move(settings)) {
+  auto const &path{m_settings.path};
+  if (path.starts_with(socketPrefix)) {
+#if defined(WIN32) || defined(__EMSCRIPTEN__)
+    throw abcg::RuntimeError(
+        "Unix domain sockets are not supported on this platform");
+#else
+    auto const socketPath{std::string_view{path}.substr(socketPrefix.size())};
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+      throw abcg::RuntimeError(
+          fmt::format("Metrics socket path {} is too long", socketPath));
+    }
+    std::ranges::copy(socketPath, std::begin(address.sun_path));
+
+    m_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    auto const *const socketAddress{reinterpret_cast<sockaddr *>(&address)};
+    if (m_socket < 0 ||
+        connect(m_socket, socketAddress, sizeof(address)) != 0) {
+      if (m_socket >= 0) {
+        close(m_socket);
+      }
+      throw abcg::RuntimeError(
+          fmt::format("Failed to connect to metrics socket {}", socketPath));
+    }
+#if defined(SO_NOSIGPIPE)
+    int const noSigPipe{1};
+    setsockopt(m_socket, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe,
+               sizeof(noSigPipe));
+#endif
+#endif
+  } else {
+    m_file.reset(std::fopen(path.c_str(), "w"));
+    if (!m_file) {
+      throw abcg::RuntimeError(
+          fmt::format("Failed to open metrics file {}", path));
+    }
+    m_isCSV = path.ends_with(".csv");
+    if (m_isCSV) {
+      writeData("timestamp,type,name,value\n");
+    }
+  }
+
+  m_thread = std::thread([this]() { exportLoop(); });
+}
+
+/**
+ * @brief Stops the export thread, writes a final snapshot and closes the
+ * destination.
+ */
+abcg::MetricsExporter::~MetricsExporter() {
+  {
+    std::lock_guard const lock{m_mutex};
+    m_stop = true;
+  }
+  m_wakeUp.notify_one();
+  m_thread.join();
+
+  if (!m_failed) {
+    writeSnapshot();
+  }
+#if !defined(WIN32) && !defined(__EMSCRIPTEN__)
+  if (m_socket >= 0) {
+    close(m_socket);
+  }
+#endif
+}
+
+/**
+ * @brief Returns the settings used to create the exporter.
+ *
+ * @return Reference to the settings.
+ */
+abcg::MetricsExporterSettings const &
+abcg::MetricsExporter::getSettings() const noexcept {
+  return m_settings;
+}
+
+void abcg::MetricsExporter::exportLoop() {
+  auto const interval{
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(m_settings.interval))};
+  auto nextSnapshot{std::chrono::steady_clock::now()};
+
+  std::unique_lock lock{m_mutex};
+  while (true) {
+    nextSnapshot += interval;
+    if (m_wakeUp.wait_until(lock, nextSnapshot, [this] { return m_stop; }))
+      return;
+
+    lock.unlock();
+    auto const written{writeSnapshot()};
+    lock.lock();
+    if (!written) {
+      m_failed = true;
+      return;
+    }
+  }
+}
+
+// Formats and writes a snapshot of the metrics. Returns false on failure.
+bool abcg::MetricsExporter::writeSnapshot() {
+  sampleResidentBytes();
+
+  m_buffer.clear();
+  if (m_isCSV) {
+    Metrics::formatCSV(m_buffer, unixTime());
+  } else {
+    Metrics::formatJSON(m_buffer, unixTime());
+  }
+
+  if (writeData(m_buffer))
+    return true;
+
+  abcg::Log::warning("Failed to write metrics to {}, export stopped",
+                     m_settings.path);
+  return false;
+}
+
+bool abcg::MetricsExporter::writeData(std::string_view data) {
+  if (m_file) {
+    // Flushed so that the file can be followed while the program runs
+    return std::fwrite(data.data(), 1, data.size(), m_file.get()) ==
+               data.size() &&
+           std::fflush(m_file.get()) == 0;
+  }
+
+#if !defined(WIN32) && !defined(__EMSCRIPTEN__)
+  while (!data.empty()) {
+    auto const sent{send(m_socket, data.data(), data.size(), sendFlags)};
+    if (sent <= 0)
+      return false;
+    data.remove_prefix(gsl::narrow<std::size_t>(sent));
+  }
+#endif
+  return true;
+}
@@ -0,0 +1,209 @@
+/**
+ * @file abcgMetrics.hpp
+ * @brief Header file of abcg::Metrics and abcg::MetricsExporter.
+ *
+ * Declaration of abcg::Metrics, abcg::MetricsExporterSettings and
+ * abcg::MetricsExporter.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_METRICS_HPP_
+#define ABCG_METRICS_HPP_
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace abcg {
+class Metrics;
+struct MetricsExporterSettings;
+class MetricsExporter;
+} // namespace abcg
+
+/**
+ * @brief Process-wide registry of named counters, gauges and histograms.
+ *
+ * Metrics are created on first use and live until the program ends, so the
+ * returned references can be cached, e.g., in function-local static
+ * variables. Updating a metric is a lock-free atomic operation that can be
+ * done from any thread.
+ *
+ * @code
+ * static auto &meshesLoaded{abcg::Metrics::counter("app.meshes_loaded")};
+ * meshesLoaded.add();
+ * @endcode
+ *
+ * ABCg updates the following metrics:
+ *
+ * - `abcg.textures_loaded` (counter): textures and cube maps loaded from
+ *   image files.
+ * - `abcg.texture_bytes_uploaded` (counter): size of the texture data uploaded
+ *   to the GPU.
+ * - `abcg.programs_linked` (counter): shader programs linked, or shader
+ *   modules created with Vulkan.
+ * - `abcg.swapchain_rebuilds` (counter): Vulkan swapchains (re)created.
+ * - `abcg.render_target_rebuilds` (counter): OpenGL render targets
+ *   (re)created, including those of dynamic resolution.
+ * - `abcg.frame_time_ms` (histogram): CPU time of each frame.
+ * - `abcg.frame_arena_bytes` (gauge): capacity of the frame arena.
+ * - `abcg.frame_allocations` (gauge): heap allocations of the last frame,
+ *   if ABCg was built with allocation tracking (see
+ *   abcg::AllocationTracker).
+ * - `abcg.gpu_memory_bytes` (gauge): size of the live GPU allocations (see
+ *   abcg::GpuMemory).
+ * - `process.resident_bytes` (gauge): resident set size of the process,
+ *   sampled by abcg::MetricsExporter on Linux.
+ *
+ * @sa abcg::MetricsExporter.
+ */
+class abcg::Metrics {
+public:
+  /**
+   * @brief Monotonically increasing count of events.
+   */
+  class Counter {
+  public:
+    void add(std::uint64_t value = 1) noexcept;
+    [[nodiscard]] std::uint64_t get() const noexcept;
+
+  private:
+    std::atomic<std::uint64_t> m_value{};
+  };
+
+  /**
+   * @brief Value that can go up and down.
+   */
+  class Gauge {
+  public:
+    void set(double value) noexcept;
+    void add(double value) noexcept;
+    [[nodiscard]] double get() const noexcept;
+
+  private:
+    std::atomic<double> m_value{};
+  };
+
+  /**
+   * @brief Distribution of values over fixed buckets.
+   */
+  class Histogram {
+  public:
+    explicit Histogram(std::span<double const> bounds);
+
+    void record(double value) noexcept;
+
+    [[nodiscard]] std::span<double const> getBounds() const noexcept;
+    [[nodiscard]] std::vector<std::uint64_t> getBucketCounts() const;
+    [[nodiscard]] std::uint64_t getCount() const noexcept;
+    [[nodiscard]] double getSum() const noexcept;
+
+  private:
+    std::vector<double> m_bounds;
+    // One more bucket than bounds, for values above the last bound
+    std::vector<std::atomic<std::uint64_t>> m_buckets;
+    std::atomic<std::uint64_t> m_count{};
+    std::atomic<double> m_sum{};
+  };
+
+  /** @brief Default upper bounds of the histogram buckets, suited to frame
+   * times in milliseconds. */
+  static constexpr std::array defaultBounds{
+      1.0, 2.0, 4.0, 8.0, 12.0, 16.7, 33.3, 50.0, 100.0, 250.0, 500.0, 1000.0};
+
+  Metrics() = delete;
+
+  [[nodiscard]] static Counter &counter(std::string_view name);
+  [[nodiscard]] static Gauge &gauge(std::string_view name);
+  [[nodiscard]] static Histogram &
+  histogram(std::string_view name,
+            std::span<double const> bounds = defaultBounds);
+
+  static void formatJSON(std::string &output, double timestamp);
+  static void formatCSV(std::string &output, double timestamp);
+};
+
+/**
+ * @brief Settings of abcg::MetricsExporter.
+ *
+ * The exporter is also enabled with the `--metrics=<path>` and
+ * `--metrics-interval=<seconds>` command-line arguments.
+ */
+struct abcg::MetricsExporterSettings {
+  /** @brief Destination of the snapshots. Paths starting with `unix:` name a
+   * Unix domain socket to connect to, e.g., `unix:/tmp/metrics.sock`. Other
+   * paths name a file, written in CSV if the path ends with `.csv` and in
+   * JSON Lines otherwise. Snapshots sent to a socket are in JSON Lines. */
+  std::string path{"metrics.jsonl"};
+  /** @brief Time between snapshots, in seconds. */
+  double interval{1.0};
+};
+
+/**
+ * @brief Writes snapshots of abcg::Metrics at a fixed interval.
+ *
+ * Snapshots are formatted and written by a background thread, so that a slow
+ * destination does not stall the render loop. A final snapshot is written
+ * when the exporter is destroyed. If writing fails, e.g., because the socket
+ * was closed by the peer, a warning is logged and the export stops.
+ *
+ * Each JSON snapshot is a single line with the Unix time and all metrics:
+ *
+ * @code{.json}
+ * {"timestamp":1700000000.250,"counters":{"abcg.textures_loaded":4},
+ *  "gauges":{...},"histograms":{"abcg.frame_time_ms":{"count":60,
+ *  "sum":1002.5,"bounds":[1,2,...],"counts":[0,0,...]}}}
+ * @endcode
+ *
+ * (Shown wrapped here.) The `counts` array has one more element than
+ * `bounds`, with the number of values above the last bound. CSV snapshots
+ * have one `timestamp,type,name,value` row per counter, gauge, histogram
+ * count, histogram sum and histogram bucket.
+ *
+ * @remark Not available on WebAssembly.
+ */
+class abcg::MetricsExporter {
+public:
+  explicit MetricsExporter(MetricsExporterSettings settings);
+  ~MetricsExporter();
+
+  MetricsExporter(MetricsExporter const &) = delete;
+  MetricsExporter(MetricsExporter &&) = delete;
+  MetricsExporter &operator=(MetricsExporter const &) = delete;
+  MetricsExporter &operator=(MetricsExporter &&) = delete;
+
+  [[nodiscard]] MetricsExporterSettings const &getSettings() const noexcept;
+
+private:
+  void exportLoop();
+  bool writeSnapshot();
+  bool writeData(std::string_view data);
+
+  MetricsExporterSettings m_settings;
+  bool m_isCSV{};
+  // Destination: a file, or the descriptor of a connected socket
+  std::unique_ptr<std::FILE, decltype(&std::fclose)> m_file{nullptr,
+                                                             &std::fclose};
+  int m_socket{-1};
+  std::string m_buffer;
+
+  std::mutex m_mutex;
+  std::condition_variable m_wakeUp;
+  bool m_stop{};
+  bool m_failed{};
+  std::thread m_thread;
+};
+
+#endif
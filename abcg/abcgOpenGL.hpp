@@ -14,8 +14,15 @@
 #define ABCG_OPENGL_HPP_
 
 #include "abcg.hpp"
+#include "abcgOpenGLCapture.hpp"
+#include "abcgOpenGLCounters.hpp"
+#include "abcgOpenGLGpuTimer.hpp"
 #include "abcgOpenGLImage.hpp"
+#include "abcgOpenGLProgram.hpp"
+#include "abcgOpenGLReplayer.hpp"
 #include "abcgOpenGLShader.hpp"
+#include "abcgOpenGLStateCache.hpp"
+#include "abcgOpenGLValidation.hpp"
 #include "abcgOpenGLWindow.hpp"
 
 #endif
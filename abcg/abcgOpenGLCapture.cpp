@@ -0,0 +1,531 @@
+/**
+ * @file abcgOpenGLCapture.cpp
+ * @brief Definition of abcg::OpenGLCapture members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgOpenGLCapture.hpp"
+
+#include <algorithm>
+#include <cppitertools/itertools.hpp>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "abcgException.hpp"
+#include "abcgLog.hpp"
+#include "abcgOpenGLCounters.hpp"
+
+namespace {
+using Command = abcg::OpenGLCommand;
+
+constexpr std::array<char, 8> fileMagic{'A', 'B', 'C', 'G', 'G', 'L', 'C',
+                                        '1'};
+
+// Size of the write buffer that triggers a write to the file
+constexpr std::size_t flushThreshold{1U << 20U};
+
+// Alignment of the payloads in the file
+constexpr std::size_t payloadAlignment{8};
+
+// GL_TEXTURE_BORDER_COLOR, which is not defined by OpenGL ES 3.0
+constexpr GLenum textureBorderColor{0x1004};
+
+struct CaptureState {
+  std::unique_ptr<std::FILE, decltype(&std::fclose)> file{nullptr,
+                                                          &std::fclose};
+  std::string path;
+  std::vector<std::uint8_t> buffer;
+  std::unordered_map<void const *, Command> commands;
+  int firstFrame{};
+  int endFrame{};
+  int frameIndex{-1};
+  std::uint64_t calls{};
+  std::uint64_t bytesWritten{};
+  bool warnedClientArrays{};
+  bool warnedMappedBuffers{};
+};
+
+// Only accessed from the thread that owns the OpenGL context
+CaptureState &state() {
+  static CaptureState instance;
+  return instance;
+}
+
+void writeVarint(std::vector<std::uint8_t> &buffer, std::uint64_t value) {
+  while (value >= 0x80U) {
+    buffer.push_back(static_cast<std::uint8_t>(value | 0x80U));
+    value >>= 7U;
+  }
+  buffer.push_back(static_cast<std::uint8_t>(value));
+}
+
+void writeBytes(std::vector<std::uint8_t> &buffer, void const *data,
+                std::size_t size) {
+  auto const *const bytes{static_cast<std::uint8_t const *>(data)};
+  buffer.insert(buffer.end(), bytes,
+                std::next(bytes, static_cast<std::ptrdiff_t>(size)));
+}
+
+// Writes a pointer argument. Pointers with a payload are written as the
+// payload size plus one, followed by the payload if it is read by the call.
+// Payloads start at a multiple of 8 bytes from the start of the file, so that
+// the replayer can use them in place. Other pointers, such as offsets into
+// buffer objects, are written as 0 followed by their value.
+void writePointer(CaptureState &capture, std::uint64_t word,
+                  std::optional<std::size_t> size, bool writeData = true) {
+  auto &buffer{capture.buffer};
+  if (word == 0 || !size.has_value()) {
+    writeVarint(buffer, 0);
+    writeVarint(buffer, word);
+    return;
+  }
+  writeVarint(buffer, *size + 1);
+  if (writeData) {
+    while ((capture.bytesWritten + buffer.size()) % payloadAlignment != 0) {
+      buffer.push_back(0);
+    }
+    writeBytes(buffer, abcg::decodeOpenGLArgument<void const *>(word), *size);
+  }
+}
+
+void flush(CaptureState &capture) {
+  if (capture.buffer.empty())
+    return;
+  if (std::fwrite(capture.buffer.data(), 1, capture.buffer.size(),
+                  capture.file.get()) != capture.buffer.size()) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to write OpenGL capture {}", capture.path));
+  }
+  capture.bytesWritten += capture.buffer.size();
+  capture.buffer.clear();
+}
+
+template <typename T>
+T argument(std::span<std::uint64_t const> arguments, std::size_t index) {
+  return abcg::decodeOpenGLArgument<T>(arguments[index]);
+}
+
+GLint getInteger(GLenum name) {
+  GLint value{};
+  ::glGetIntegerv(name, &value);
+  return value;
+}
+
+std::size_t toSize(std::int64_t value) {
+  return static_cast<std::size_t>(std::max<std::int64_t>(value, 0));
+}
+
+// Size of the pixel data read or written by a texture or pixel transfer
+// function, taking the row alignment into account. The row length and skip
+// parameters are assumed to be 0.
+std::size_t getPixelDataSize(GLsizei width, GLsizei height, GLsizei depth,
+                             GLenum format, GLenum type,
+                             GLenum alignmentName) {
+  auto const rowSize{
+      abcg::OpenGLCounters::getUploadSize(width, 1, 1, format, type)};
+  auto const rows{static_cast<std::uint64_t>(std::max(height, 0)) *
+                  static_cast<std::uint64_t>(std::max(depth, 0))};
+  if (rowSize == 0 || rows == 0)
+    return 0;
+  auto const alignment{
+      static_cast<std::uint64_t>(std::max(getInteger(alignmentName), 1))};
+  auto const rowPitch{(rowSize + alignment - 1) / alignment * alignment};
+  return gsl::narrow_cast<std::size_t>(rowPitch * (rows - 1) + rowSize);
+}
+
+std::size_t getIndexSize(GLenum type) {
+  switch (type) {
+  case GL_UNSIGNED_BYTE:
+    return 1;
+  case GL_UNSIGNED_SHORT:
+    return 2;
+  default:
+    return 4;
+  }
+}
+
+// Size of the data pointed to by the '*' or 'o' argument of a command, or
+// nullopt if the pointer is an offset into a buffer object
+std::optional<std::size_t>
+getPayloadSize(Command command, std::span<std::uint64_t const> arguments) {
+  auto const size{[&](std::size_t index) {
+    return toSize(argument<GLsizeiptr>(arguments, index));
+  }};
+  auto const count{[&](std::size_t index) {
+    return toSize(argument<GLsizei>(arguments, index));
+  }};
+  auto const unpackImage{[&](std::size_t width, std::size_t height,
+                             std::optional<std::size_t> depth,
+                             std::size_t format)
+                             -> std::optional<std::size_t> {
+    if (getInteger(GL_PIXEL_UNPACK_BUFFER_BINDING) != 0)
+      return std::nullopt;
+    return getPixelDataSize(
+        argument<GLsizei>(arguments, width),
+        argument<GLsizei>(arguments, height),
+        depth ? argument<GLsizei>(arguments, *depth) : 1,
+        argument<GLenum>(arguments, format),
+        argument<GLenum>(arguments, format + 1), GL_UNPACK_ALIGNMENT);
+  }};
+  auto const compressedImage{
+      [&](std::size_t imageSize) -> std::optional<std::size_t> {
+        if (getInteger(GL_PIXEL_UNPACK_BUFFER_BINDING) != 0)
+          return std::nullopt;
+        return count(imageSize);
+      }};
+  auto const indices{[&](std::size_t indexCount,
+                         std::size_t type) -> std::optional<std::size_t> {
+    if (getInteger(GL_ELEMENT_ARRAY_BUFFER_BINDING) != 0)
+      return std::nullopt;
+    return count(indexCount) * getIndexSize(argument<GLenum>(arguments, type));
+  }};
+  auto const uniform{[&](std::size_t components) {
+    return count(1) * components * sizeof(GLfloat);
+  }};
+  auto const parameters{[&](bool borderColor) {
+    return (borderColor ? 4 : 1) * sizeof(GLint);
+  }};
+
+  switch (command) {
+  case Command::BufferData:
+    return size(1);
+  case Command::BufferSubData:
+    return size(2);
+  case Command::TexImage2D:
+    return unpackImage(3, 4, std::nullopt, 6);
+  case Command::TexSubImage2D:
+    return unpackImage(4, 5, std::nullopt, 6);
+  case Command::TexImage3D:
+    return unpackImage(3, 4, 5, 7);
+  case Command::TexSubImage3D:
+    return unpackImage(5, 6, 7, 8);
+  case Command::CompressedTexImage2D:
+    return compressedImage(6);
+  case Command::CompressedTexSubImage2D:
+  case Command::CompressedTexImage3D:
+    return compressedImage(7);
+  case Command::CompressedTexSubImage3D:
+    return compressedImage(9);
+  case Command::ReadPixels:
+    if (getInteger(GL_PIXEL_PACK_BUFFER_BINDING) != 0)
+      return std::nullopt;
+    return getPixelDataSize(argument<GLsizei>(arguments, 2),
+                            argument<GLsizei>(arguments, 3), 1,
+                            argument<GLenum>(arguments, 4),
+                            argument<GLenum>(arguments, 5), GL_PACK_ALIGNMENT);
+  case Command::DrawElements:
+  case Command::DrawElementsInstanced:
+    return indices(1, 2);
+  case Command::DrawRangeElements:
+    return indices(3, 4);
+  case Command::VertexAttribPointer:
+  case Command::VertexAttribIPointer:
+    if (getInteger(GL_ARRAY_BUFFER_BINDING) == 0 &&
+        !state().warnedClientArrays) {
+      abcg::Log::warning("Client-side vertex arrays are not captured");
+      state().warnedClientArrays = true;
+    }
+    return std::nullopt;
+  case Command::Uniform1fv:
+  case Command::Uniform1iv:
+  case Command::Uniform1uiv:
+    return uniform(1);
+  case Command::Uniform2fv:
+  case Command::Uniform2iv:
+  case Command::Uniform2uiv:
+    return uniform(2);
+  case Command::Uniform3fv:
+  case Command::Uniform3iv:
+  case Command::Uniform3uiv:
+    return uniform(3);
+  case Command::Uniform4fv:
+  case Command::Uniform4iv:
+  case Command::Uniform4uiv:
+  case Command::UniformMatrix2fv:
+    return uniform(4);
+  case Command::UniformMatrix2x3fv:
+  case Command::UniformMatrix3x2fv:
+    return uniform(6);
+  case Command::UniformMatrix2x4fv:
+  case Command::UniformMatrix4x2fv:
+    return uniform(8);
+  case Command::UniformMatrix3fv:
+    return uniform(9);
+  case Command::UniformMatrix3x4fv:
+  case Command::UniformMatrix4x3fv:
+    return uniform(12);
+  case Command::UniformMatrix4fv:
+    return uniform(16);
+  case Command::VertexAttrib1fv:
+    return sizeof(GLfloat);
+  case Command::VertexAttrib2fv:
+    return 2 * sizeof(GLfloat);
+  case Command::VertexAttrib3fv:
+    return 3 * sizeof(GLfloat);
+  case Command::VertexAttrib4fv:
+  case Command::VertexAttribI4iv:
+  case Command::VertexAttribI4uiv:
+    return 4 * sizeof(GLfloat);
+  case Command::TexParameterfv:
+  case Command::TexParameteriv:
+  case Command::SamplerParameterfv:
+  case Command::SamplerParameteriv:
+    return parameters(argument<GLenum>(arguments, 1) == textureBorderColor);
+  case Command::ClearBufferfv:
+  case Command::ClearBufferiv:
+  case Command::ClearBufferuiv:
+    return parameters(argument<GLenum>(arguments, 0) == GL_COLOR);
+  case Command::DrawBuffers:
+    return count(0) * sizeof(GLenum);
+  case Command::InvalidateFramebuffer:
+  case Command::InvalidateSubFramebuffer:
+    return count(1) * sizeof(GLenum);
+  case Command::ProgramBinary:
+    return count(3);
+  case Command::ShaderBinary:
+    return count(4);
+  default:
+    return std::nullopt;
+  }
+}
+
+// Commands skipped before the first captured frame, as they only change the
+// contents of framebuffers
+bool isDrawCommand(Command command) {
+  switch (command) {
+  case Command::Clear:
+  case Command::ClearBufferfv:
+  case Command::ClearBufferiv:
+  case Command::ClearBufferuiv:
+  case Command::ClearBufferfi:
+  case Command::DrawArrays:
+  case Command::DrawArraysInstanced:
+  case Command::DrawElements:
+  case Command::DrawElementsInstanced:
+  case Command::DrawRangeElements:
+  case Command::BlitFramebuffer:
+  case Command::ReadPixels:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Writes an array of strings as the number of strings followed by each
+// null-terminated string
+void writeStrings(std::vector<std::uint8_t> &buffer,
+                  std::span<std::uint64_t const> arguments,
+                  std::size_t stringsIndex,
+                  std::optional<std::size_t> lengthsIndex) {
+  auto const count{toSize(argument<GLsizei>(arguments, 1))};
+  auto const *const strings{
+      argument<GLchar const *const *>(arguments, stringsIndex)};
+  auto const *const lengths{
+      lengthsIndex ? argument<GLint const *>(arguments, *lengthsIndex)
+                   : nullptr};
+
+  writeVarint(buffer, count);
+  for (auto const index : iter::range(count)) {
+    auto const *const string{strings[index]};
+    auto const length{lengths != nullptr && lengths[index] >= 0
+                          ? static_cast<std::size_t>(lengths[index])
+                          : std::strlen(string)};
+    writeVarint(buffer, length + 1);
+    writeBytes(buffer, string, length);
+    buffer.push_back(0);
+  }
+}
+
+template <typename TFun>
+void addCommand(std::unordered_map<void const *, Command> &commands,
+                TFun const &function, Command command) {
+  std::decay_t<TFun> const pointer{function};
+  if constexpr (std::is_pointer_v<TFun>) {
+    // Not supported by the context
+    if (pointer == nullptr)
+      return;
+  }
+  commands.emplace(reinterpret_cast<void const *>(pointer), command);
+}
+} // namespace
+
+/**
+ * @brief Starts a capture.
+ *
+ * The calls made before the first captured frame form the setup of the
+ * capture. The capture stops after the last captured frame, or when
+ * abcg::OpenGLCapture::stop is called.
+ *
+ * @param path Path of the capture file.
+ * @param info Description of the context and of the frames to capture.
+ *
+ * @throw abcg::RuntimeError if the file cannot be written.
+ *
+ * @remark This is called by abcg::OpenGLWindow after the OpenGL context is
+ * created if abcg::OpenGLSettings::capture has a path.
+ */
+void abcg::OpenGLCapture::start(std::string const &path,
+                                OpenGLCaptureInfo const &info) {
+  stop();
+
+  auto &capture{state()};
+  capture.file.reset(std::fopen(path.c_str(), "wb"));
+  if (!capture.file) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to open OpenGL capture {}", path));
+  }
+  capture.path = path;
+  capture.buffer.clear();
+  capture.firstFrame = std::max(info.firstFrame, 0);
+  capture.endFrame = capture.firstFrame + std::max(info.frames, 1);
+  capture.frameIndex = -1;
+  capture.calls = 0;
+  capture.bytesWritten = 0;
+
+  // Function addresses are only known once the OpenGL loader is initialized
+  capture.commands.clear();
+#define ABCG_OPENGL_COMMAND_ENTRY(name, signature)                             \
+  addCommand(capture.commands, ::gl##name, Command::name);
+  ABCG_OPENGL_COMMANDS(ABCG_OPENGL_COMMAND_ENTRY)
+  ABCG_OPENGL_DESKTOP_COMMANDS(ABCG_OPENGL_COMMAND_ENTRY)
+#undef ABCG_OPENGL_COMMAND_ENTRY
+
+  writeBytes(capture.buffer, fileMagic.data(), fileMagic.size());
+  auto const frames{capture.endFrame - capture.firstFrame};
+  for (auto const value :
+       {info.es ? 1 : 0, info.majorVersion, info.minorVersion, info.width,
+        info.height, capture.firstFrame, frames}) {
+    writeVarint(capture.buffer, static_cast<std::uint64_t>(std::max(value, 0)));
+  }
+  flush(capture);
+
+  m_recording = true;
+  abcg::Log::info("Capturing OpenGL frames {} to {} to {}", capture.firstFrame,
+                  capture.endFrame - 1, path);
+}
+
+/**
+ * @brief Stops the capture and closes the capture file.
+ *
+ * Does nothing if no capture is running.
+ *
+ * @throw abcg::RuntimeError if the file cannot be written.
+ */
+void abcg::OpenGLCapture::stop() {
+  if (!m_recording)
+    return;
+  m_recording = false;
+
+  auto &capture{state()};
+  flush(capture);
+  capture.file.reset();
+  capture.commands.clear();
+  abcg::Log::info("OpenGL capture written to {} ({} calls, {:.1f} KiB)",
+                  capture.path, capture.calls,
+                  static_cast<double>(capture.bytesWritten) / 1024.0);
+}
+
+/**
+ * @brief Starts a new frame.
+ *
+ * Marks the start of a captured frame, or stops the capture after the last
+ * captured frame.
+ *
+ * @throw abcg::RuntimeError if the file cannot be written.
+ *
+ * @remark This is called by abcg::OpenGLWindow at the beginning of each
+ * frame.
+ */
+void abcg::OpenGLCapture::newFrame() {
+  if (!m_recording)
+    return;
+
+  auto &capture{state()};
+  ++capture.frameIndex;
+  if (capture.frameIndex >= capture.endFrame) {
+    stop();
+    return;
+  }
+  if (capture.frameIndex >= capture.firstFrame) {
+    writeVarint(capture.buffer, static_cast<std::uint64_t>(Command::Frame));
+    writeVarint(capture.buffer,
+                static_cast<std::uint64_t>(capture.frameIndex));
+  }
+}
+
+// Writes a call in the format read by abcg::OpenGLReplayer
+void abcg::OpenGLCapture::recordCall(void const *function,
+                                     std::span<std::uint64_t const> arguments,
+                                     std::uint64_t result) {
+  auto &capture{state()};
+  auto const it{capture.commands.find(function)};
+  if (it == capture.commands.end())
+    return;
+  auto const command{it->second};
+  auto const signature{getOpenGLCommandSignature(command)};
+  if (signature.front() == '?')
+    return;
+  if (capture.frameIndex < capture.firstFrame && isDrawCommand(command))
+    return;
+  if (command == Command::MapBufferRange && !capture.warnedMappedBuffers) {
+    abcg::Log::warning("Writes to mapped buffers are not captured");
+    capture.warnedMappedBuffers = true;
+  }
+
+  auto &buffer{capture.buffer};
+  writeVarint(buffer, static_cast<std::uint64_t>(command));
+  auto const lengthsIndex{signature.find('n')};
+  for (auto const index : iter::range(arguments.size())) {
+    auto const word{arguments[index]};
+    switch (auto const kind{signature[index + 1]}; kind) {
+    case '*':
+      writePointer(capture, word, getPayloadSize(command, arguments));
+      break;
+    case 'o':
+      // The size is recorded so that the replayer can allocate the output
+      writePointer(capture, word, getPayloadSize(command, arguments), false);
+      break;
+    case 'c':
+      if (auto const *const string{decodeOpenGLArgument<char const *>(word)};
+          string != nullptr) {
+        writePointer(capture, word, std::strlen(string) + 1);
+      } else {
+        writePointer(capture, word, std::nullopt);
+      }
+      break;
+    case '&':
+      writeStrings(buffer, arguments, index,
+                   lengthsIndex == std::string_view::npos
+                       ? std::nullopt
+                       : std::optional{lengthsIndex - 1});
+      break;
+    case 'n':
+      break;
+    default:
+      if (kind >= 'A' && kind <= 'Z') {
+        // Array of object names. The names created by glGen* are written
+        // after the call.
+        writePointer(capture, word,
+                     toSize(argument<GLsizei>(arguments, 0)) * sizeof(GLuint));
+      } else {
+        writeVarint(buffer, word);
+      }
+    }
+  }
+  if (signature.front() != '-') {
+    writeVarint(buffer, result);
+  }
+
+  ++capture.calls;
+  if (buffer.size() >= flushThreshold) {
+    flush(capture);
+  }
+}
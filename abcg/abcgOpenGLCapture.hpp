@@ -0,0 +1,161 @@
+/**
+ * @file abcgOpenGLCapture.hpp
+ * @brief Header file of abcg::OpenGLCapture.
+ *
+ * Declaration of abcg::OpenGLCapture, abcg::OpenGLCaptureInfo and
+ * abcg::OpenGLCaptureSettings.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_CAPTURE_HPP_
+#define ABCG_OPENGL_CAPTURE_HPP_
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "abcgOpenGLCommand.hpp"
+
+/**
+ * @brief Whether the `abcg::gl*` wrappers can be captured by
+ * abcg::OpenGLCapture.
+ *
+ * Define as 0 to remove the capture from the wrappers.
+ */
+#if !defined(ABCG_OPENGL_CAPTURE)
+#define ABCG_OPENGL_CAPTURE 1
+#endif
+
+namespace abcg {
+class OpenGLCapture;
+struct OpenGLCaptureInfo;
+struct OpenGLCaptureSettings;
+} // namespace abcg
+
+/**
+ * @brief Configuration settings of an OpenGL capture.
+ *
+ * @sa abcg::OpenGLSettings::capture.
+ */
+struct abcg::OpenGLCaptureSettings {
+  /** @brief Path of the capture file. Nothing is captured if empty. */
+  std::string path{};
+  /** @brief Index of the first captured frame. */
+  int firstFrame{};
+  /** @brief Number of captured frames. */
+  int frames{1};
+};
+
+/**
+ * @brief Description of the context and frames of an OpenGL capture.
+ */
+struct abcg::OpenGLCaptureInfo {
+  /** @brief Whether the context uses the OpenGL ES profile. */
+  bool es{};
+  /** @brief OpenGL context major version. */
+  int majorVersion{};
+  /** @brief OpenGL context minor version. */
+  int minorVersion{};
+  /** @brief Width of the window, in pixels. */
+  int width{};
+  /** @brief Height of the window, in pixels. */
+  int height{};
+  /** @brief Index of the first captured frame in the captured session. */
+  int firstFrame{};
+  /** @brief Number of captured frames. */
+  int frames{};
+};
+
+/**
+ * @brief Captures the calls made through the `abcg::gl*` wrappers to a
+ * binary file that can be replayed without the application.
+ *
+ * A capture starts when the OpenGL context is created, so that the resources
+ * created in abcg::OpenGLWindow::onCreate are included, and stops after the
+ * last captured frame. Calls made before the first captured frame are
+ * recorded without their draw calls, clears and blits; they form the setup of
+ * the capture. The file records, for each call, its arguments, the contents
+ * of the buffers, textures, uniform arrays and shader sources it reads, and
+ * the names of the objects it creates, so that abcg::OpenGLReplayer can map
+ * them to the names of the replayed objects.
+ *
+ * Arguments are stored as variable-length integers, so most calls take a few
+ * bytes. Queries (`glGet*`, `glIs*`, `glCheckFramebufferStatus`) are not
+ * captured.
+ *
+ * A capture is configured with abcg::OpenGLSettings::capture, and replayed
+ * with the `glreplay` tool.
+ *
+ * @remark Calls that do not go through the wrappers, such as the calls made
+ * by Dear ImGui, are not captured. Client-side vertex arrays and writes to
+ * mapped buffers are not captured either; a warning is logged if they are
+ * used.
+ */
+class abcg::OpenGLCapture {
+public:
+  OpenGLCapture() = delete;
+
+  static void start(std::string const &path, OpenGLCaptureInfo const &info);
+  static void stop();
+  static void newFrame();
+
+  /**
+   * @brief Returns whether a capture is running.
+   *
+   * @return True if the calls made through the wrappers are being recorded.
+   */
+  [[nodiscard]] static bool isRecording() noexcept {
+    if constexpr (ABCG_OPENGL_CAPTURE != 0) {
+      return m_recording;
+    } else {
+      return false;
+    }
+  }
+
+  /**
+   * @brief Records a call made through a wrapper.
+   *
+   * @tparam TFun Type of the OpenGL function.
+   * @tparam TArgs Types of the arguments.
+   *
+   * @param function OpenGL function that was called.
+   * @param result Value returned by the function, encoded with
+   * abcg::encodeOpenGLArgument, or 0 if the function returns void.
+   * @param args Arguments of the call.
+   */
+  template <typename TFun, typename... TArgs>
+  static void record(TFun const &function, std::uint64_t result,
+                     TArgs const &...args) {
+    using Function = std::decay_t<TFun>;
+    Function const pointer{function};
+    auto const arguments{encode<Function>(
+        std::index_sequence_for<TArgs...>{}, args...)};
+    recordCall(reinterpret_cast<void const *>(pointer), arguments, result);
+  }
+
+private:
+  // Encodes the arguments with the parameter types of the function
+  template <typename TFun, std::size_t... Indices, typename... TArgs>
+  static std::array<std::uint64_t, sizeof...(TArgs)>
+  encode(std::index_sequence<Indices...> /*indices*/,
+         TArgs const &...args) noexcept {
+    using Traits = OpenGLFunctionTraits<TFun>;
+    return {encodeOpenGLArgument(
+        static_cast<typename Traits::template Argument<Indices>>(args))...};
+  }
+
+  static void recordCall(void const *function,
+                         std::span<std::uint64_t const> arguments,
+                         std::uint64_t result);
+
+  static inline bool m_recording{};
+};
+
+#endif
@@ -0,0 +1,467 @@
+/**
+ * @file abcgOpenGLCommand.hpp
+ * @brief Header file of abcg::OpenGLCommand.
+ *
+ * Declaration of abcg::OpenGLCommand and of the table of OpenGL functions
+ * wrapped by ABCg.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_COMMAND_HPP_
+#define ABCG_OPENGL_COMMAND_HPP_
+
+#include <bit>
+#include <cstdint>
+#include <gsl/gsl>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+#include "abcgOpenGLExternal.hpp"
+
+/**
+ * @brief Table of the OpenGL functions wrapped by the `abcg::gl*` functions.
+ *
+ * Each entry is `X(name, signature)`, where `name` is the function name
+ * without the `gl` prefix, and `signature` describes how abcg::OpenGLCapture
+ * and abcg::OpenGLReplayer handle the return value (first character) and
+ * each argument (remaining characters):
+ *
+ * - `-`: no return value;
+ * - `?`: query without side effects. It is neither captured nor replayed;
+ * - `v`: value, such as an enum, an integer, or a buffer offset;
+ * - `b`, `t`, `a`, `f`, `r`, `p`, `s`, `q`, `m`, `x`: name of a buffer,
+ *   texture, vertex array, framebuffer, renderbuffer, program, shader,
+ *   query, sampler or transform feedback object;
+ * - `B`, `T`, `A`, `F`, `R`, `S`, `Q`, `M`, `X`: array of object names,
+ *   whose length is given by the first argument;
+ * - `l`: uniform location;
+ * - `y`: sync object;
+ * - `*`: pointer to input data;
+ * - `o`: pointer to output data;
+ * - `c`: null-terminated string;
+ * - `&`: array of strings, whose length is given by the second argument;
+ * - `n`: array of string lengths, which is null when replayed.
+ *
+ * The table is used with the X macro pattern. New entries must be appended,
+ * as the position of an entry identifies the command in capture files.
+ */
+#define ABCG_OPENGL_COMMANDS(X)                                                \
+  X(ActiveTexture, "-v")                                                       \
+  X(AttachShader, "-ps")                                                       \
+  X(BindAttribLocation, "-pvc")                                                \
+  X(BindBuffer, "-vb")                                                         \
+  X(BindFramebuffer, "-vf")                                                    \
+  X(BindRenderbuffer, "-vr")                                                   \
+  X(BindTexture, "-vt")                                                        \
+  X(BlendColor, "-vvvv")                                                       \
+  X(BlendEquation, "-v")                                                       \
+  X(BlendEquationSeparate, "-vv")                                              \
+  X(BlendFunc, "-vv")                                                          \
+  X(BlendFuncSeparate, "-vvvv")                                                \
+  X(BufferData, "-vv*v")                                                       \
+  X(BufferSubData, "-vvv*")                                                    \
+  X(CheckFramebufferStatus, "?v")                                              \
+  X(Clear, "-v")                                                               \
+  X(ClearColor, "-vvvv")                                                       \
+  X(ClearDepthf, "-v")                                                         \
+  X(ClearStencil, "-v")                                                        \
+  X(ColorMask, "-vvvv")                                                        \
+  X(CompileShader, "-s")                                                       \
+  X(CompressedTexImage2D, "-vvvvvvv*")                                         \
+  X(CompressedTexSubImage2D, "-vvvvvvvv*")                                     \
+  X(CopyTexImage2D, "-vvvvvvvv")                                               \
+  X(CopyTexSubImage2D, "-vvvvvvvv")                                            \
+  X(CreateProgram, "p")                                                        \
+  X(CreateShader, "sv")                                                        \
+  X(CullFace, "-v")                                                            \
+  X(DeleteBuffers, "-vB")                                                      \
+  X(DeleteFramebuffers, "-vF")                                                 \
+  X(DeleteProgram, "-p")                                                       \
+  X(DeleteRenderbuffers, "-vR")                                                \
+  X(DeleteShader, "-s")                                                        \
+  X(DeleteTextures, "-vT")                                                     \
+  X(DepthFunc, "-v")                                                           \
+  X(DepthMask, "-v")                                                           \
+  X(DepthRangef, "-vv")                                                        \
+  X(DetachShader, "-ps")                                                       \
+  X(Disable, "-v")                                                             \
+  X(DisableVertexAttribArray, "-v")                                            \
+  X(DrawArrays, "-vvv")                                                        \
+  X(DrawElements, "-vvv*")                                                     \
+  X(Enable, "-v")                                                              \
+  X(EnableVertexAttribArray, "-v")                                             \
+  X(Finish, "-")                                                               \
+  X(Flush, "-")                                                                \
+  X(FramebufferRenderbuffer, "-vvvr")                                          \
+  X(FramebufferTexture2D, "-vvvtv")                                            \
+  X(FrontFace, "-v")                                                           \
+  X(GenBuffers, "-vB")                                                         \
+  X(GenerateMipmap, "-v")                                                      \
+  X(GenFramebuffers, "-vF")                                                    \
+  X(GenRenderbuffers, "-vR")                                                   \
+  X(GenTextures, "-vT")                                                        \
+  X(GetActiveAttrib, "?pvvoooo")                                               \
+  X(GetActiveUniform, "?pvvoooo")                                              \
+  X(GetAttachedShaders, "?pvoo")                                               \
+  X(GetAttribLocation, "vpc")                                                  \
+  X(GetBooleanv, "?vo")                                                        \
+  X(GetBufferParameteriv, "?vvo")                                              \
+  X(GetFloatv, "?vo")                                                          \
+  X(GetFramebufferAttachmentParameteriv, "?vvvo")                              \
+  X(GetIntegerv, "?vo")                                                        \
+  X(GetProgramiv, "?pvo")                                                      \
+  X(GetProgramInfoLog, "?pvoo")                                                \
+  X(GetRenderbufferParameteriv, "?vvo")                                        \
+  X(GetShaderiv, "?svo")                                                       \
+  X(GetShaderInfoLog, "?svoo")                                                 \
+  X(GetShaderPrecisionFormat, "?vvoo")                                         \
+  X(GetShaderSource, "?svoo")                                                  \
+  X(GetString, "?v")                                                           \
+  X(GetTexParameterfv, "?vvo")                                                 \
+  X(GetTexParameteriv, "?vvo")                                                 \
+  X(GetUniformfv, "?plo")                                                      \
+  X(GetUniformiv, "?plo")                                                      \
+  X(GetUniformLocation, "lpc")                                                 \
+  X(GetVertexAttribfv, "?vvo")                                                 \
+  X(GetVertexAttribiv, "?vvo")                                                 \
+  X(GetVertexAttribPointerv, "?vvo")                                           \
+  X(Hint, "-vv")                                                               \
+  X(IsBuffer, "?b")                                                            \
+  X(IsEnabled, "?v")                                                           \
+  X(IsFramebuffer, "?f")                                                       \
+  X(IsProgram, "?p")                                                           \
+  X(IsRenderbuffer, "?r")                                                      \
+  X(IsShader, "?s")                                                            \
+  X(IsTexture, "?t")                                                           \
+  X(LineWidth, "-v")                                                           \
+  X(LinkProgram, "-p")                                                         \
+  X(PixelStorei, "-vv")                                                        \
+  X(PolygonOffset, "-vv")                                                      \
+  X(ReadPixels, "-vvvvvvo")                                                    \
+  X(ReleaseShaderCompiler, "-")                                                \
+  X(RenderbufferStorage, "-vvvv")                                              \
+  X(SampleCoverage, "-vv")                                                     \
+  X(Scissor, "-vvvv")                                                          \
+  X(ShaderBinary, "-vSv*v")                                                    \
+  X(ShaderSource, "-sv&n")                                                     \
+  X(StencilFunc, "-vvv")                                                       \
+  X(StencilFuncSeparate, "-vvvv")                                              \
+  X(StencilMask, "-v")                                                         \
+  X(StencilMaskSeparate, "-vv")                                                \
+  X(StencilOp, "-vvv")                                                         \
+  X(StencilOpSeparate, "-vvvv")                                                \
+  X(TexImage2D, "-vvvvvvvv*")                                                  \
+  X(TexParameterf, "-vvv")                                                     \
+  X(TexParameterfv, "-vv*")                                                    \
+  X(TexParameteri, "-vvv")                                                     \
+  X(TexParameteriv, "-vv*")                                                    \
+  X(TexSubImage2D, "-vvvvvvvv*")                                               \
+  X(Uniform1f, "-lv")                                                          \
+  X(Uniform1fv, "-lv*")                                                        \
+  X(Uniform1i, "-lv")                                                          \
+  X(Uniform1iv, "-lv*")                                                        \
+  X(Uniform2f, "-lvv")                                                         \
+  X(Uniform2fv, "-lv*")                                                        \
+  X(Uniform2i, "-lvv")                                                         \
+  X(Uniform2iv, "-lv*")                                                        \
+  X(Uniform3f, "-lvvv")                                                        \
+  X(Uniform3fv, "-lv*")                                                        \
+  X(Uniform3i, "-lvvv")                                                        \
+  X(Uniform3iv, "-lv*")                                                        \
+  X(Uniform4f, "-lvvvv")                                                       \
+  X(Uniform4fv, "-lv*")                                                        \
+  X(Uniform4i, "-lvvvv")                                                       \
+  X(Uniform4iv, "-lv*")                                                        \
+  X(UniformMatrix2fv, "-lvv*")                                                 \
+  X(UniformMatrix3fv, "-lvv*")                                                 \
+  X(UniformMatrix4fv, "-lvv*")                                                 \
+  X(UseProgram, "-p")                                                          \
+  X(ValidateProgram, "-p")                                                     \
+  X(VertexAttrib1f, "-vv")                                                     \
+  X(VertexAttrib1fv, "-v*")                                                    \
+  X(VertexAttrib2f, "-vvv")                                                    \
+  X(VertexAttrib2fv, "-v*")                                                    \
+  X(VertexAttrib3f, "-vvvv")                                                   \
+  X(VertexAttrib3fv, "-v*")                                                    \
+  X(VertexAttrib4f, "-vvvvv")                                                  \
+  X(VertexAttrib4fv, "-v*")                                                    \
+  X(VertexAttribPointer, "-vvvvv*")                                            \
+  X(Viewport, "-vvvv")                                                         \
+  X(ReadBuffer, "-v")                                                          \
+  X(DrawRangeElements, "-vvvvv*")                                              \
+  X(TexImage3D, "-vvvvvvvvv*")                                                 \
+  X(TexSubImage3D, "-vvvvvvvvvv*")                                             \
+  X(CopyTexSubImage3D, "-vvvvvvvvv")                                           \
+  X(CompressedTexImage3D, "-vvvvvvvv*")                                        \
+  X(CompressedTexSubImage3D, "-vvvvvvvvvv*")                                   \
+  X(GenQueries, "-vQ")                                                         \
+  X(DeleteQueries, "-vQ")                                                      \
+  X(IsQuery, "?q")                                                             \
+  X(BeginQuery, "-vq")                                                         \
+  X(EndQuery, "-v")                                                            \
+  X(GetQueryiv, "?vvo")                                                        \
+  X(GetQueryObjectuiv, "?qvo")                                                 \
+  X(UnmapBuffer, "vv")                                                         \
+  X(GetBufferPointerv, "?vvo")                                                 \
+  X(DrawBuffers, "-v*")                                                        \
+  X(UniformMatrix2x3fv, "-lvv*")                                               \
+  X(UniformMatrix3x2fv, "-lvv*")                                               \
+  X(UniformMatrix2x4fv, "-lvv*")                                               \
+  X(UniformMatrix4x2fv, "-lvv*")                                               \
+  X(UniformMatrix3x4fv, "-lvv*")                                               \
+  X(UniformMatrix4x3fv, "-lvv*")                                               \
+  X(BlitFramebuffer, "-vvvvvvvvvv")                                            \
+  X(RenderbufferStorageMultisample, "-vvvvv")                                  \
+  X(FramebufferTextureLayer, "-vvtvv")                                         \
+  X(MapBufferRange, "vvvvv")                                                   \
+  X(FlushMappedBufferRange, "-vvv")                                            \
+  X(BindVertexArray, "-a")                                                     \
+  X(DeleteVertexArrays, "-vA")                                                 \
+  X(GenVertexArrays, "-vA")                                                    \
+  X(IsVertexArray, "?a")                                                       \
+  X(GetIntegeri_v, "?vvo")                                                     \
+  X(BeginTransformFeedback, "-v")                                              \
+  X(EndTransformFeedback, "-")                                                 \
+  X(BindBufferRange, "-vvbvv")                                                 \
+  X(BindBufferBase, "-vvb")                                                    \
+  X(TransformFeedbackVaryings, "-pv&v")                                        \
+  X(GetTransformFeedbackVarying, "?pvvoooo")                                   \
+  X(VertexAttribIPointer, "-vvvv*")                                            \
+  X(GetVertexAttribIiv, "?vvo")                                                \
+  X(GetVertexAttribIuiv, "?vvo")                                               \
+  X(VertexAttribI4i, "-vvvvv")                                                 \
+  X(VertexAttribI4ui, "-vvvvv")                                                \
+  X(VertexAttribI4iv, "-v*")                                                   \
+  X(VertexAttribI4uiv, "-v*")                                                  \
+  X(GetUniformuiv, "?plo")                                                     \
+  X(GetFragDataLocation, "vpc")                                                \
+  X(Uniform1ui, "-lv")                                                         \
+  X(Uniform2ui, "-lvv")                                                        \
+  X(Uniform3ui, "-lvvv")                                                       \
+  X(Uniform4ui, "-lvvvv")                                                      \
+  X(Uniform1uiv, "-lv*")                                                       \
+  X(Uniform2uiv, "-lv*")                                                       \
+  X(Uniform3uiv, "-lv*")                                                       \
+  X(Uniform4uiv, "-lv*")                                                       \
+  X(ClearBufferiv, "-vv*")                                                     \
+  X(ClearBufferuiv, "-vv*")                                                    \
+  X(ClearBufferfv, "-vv*")                                                     \
+  X(ClearBufferfi, "-vvvv")                                                    \
+  X(GetStringi, "?vv")                                                         \
+  X(CopyBufferSubData, "-vvvvv")                                               \
+  X(GetUniformIndices, "?pv&o")                                                \
+  X(GetActiveUniformsiv, "?pv*vo")                                             \
+  X(GetUniformBlockIndex, "vpc")                                               \
+  X(GetActiveUniformBlockiv, "?pvvo")                                          \
+  X(GetActiveUniformBlockName, "?pvvoo")                                       \
+  X(UniformBlockBinding, "-pvv")                                               \
+  X(DrawArraysInstanced, "-vvvv")                                              \
+  X(DrawElementsInstanced, "-vvv*v")                                           \
+  X(FenceSync, "yvv")                                                          \
+  X(IsSync, "?y")                                                              \
+  X(DeleteSync, "-y")                                                          \
+  X(ClientWaitSync, "vyvv")                                                    \
+  X(WaitSync, "-yvv")                                                          \
+  X(GetInteger64v, "?vo")                                                      \
+  X(GetSynciv, "?yvvoo")                                                       \
+  X(GetInteger64i_v, "?vvo")                                                   \
+  X(GetBufferParameteri64v, "?vvo")                                            \
+  X(GenSamplers, "-vM")                                                        \
+  X(DeleteSamplers, "-vM")                                                     \
+  X(IsSampler, "?m")                                                           \
+  X(BindSampler, "-vm")                                                        \
+  X(SamplerParameteri, "-mvv")                                                 \
+  X(SamplerParameteriv, "-mv*")                                                \
+  X(SamplerParameterf, "-mvv")                                                 \
+  X(SamplerParameterfv, "-mv*")                                                \
+  X(GetSamplerParameteriv, "?mvo")                                             \
+  X(GetSamplerParameterfv, "?mvo")                                             \
+  X(VertexAttribDivisor, "-vv")                                                \
+  X(BindTransformFeedback, "-vx")                                              \
+  X(DeleteTransformFeedbacks, "-vX")                                           \
+  X(GenTransformFeedbacks, "-vX")                                              \
+  X(IsTransformFeedback, "?x")                                                 \
+  X(PauseTransformFeedback, "-")                                               \
+  X(ResumeTransformFeedback, "-")                                              \
+  X(GetProgramBinary, "?pvooo")                                                \
+  X(ProgramBinary, "-pv*v")                                                    \
+  X(ProgramParameteri, "-pvv")                                                 \
+  X(InvalidateFramebuffer, "-vv*")                                             \
+  X(InvalidateSubFramebuffer, "-vv*vvvv")                                      \
+  X(TexStorage2D, "-vvvvv")                                                    \
+  X(TexStorage3D, "-vvvvvv")                                                   \
+  X(GetInternalformativ, "?vvvvo")
+
+/**
+ * @brief Table of the desktop OpenGL functions wrapped by the `abcg::gl*`
+ * functions.
+ *
+ * @sa ABCG_OPENGL_COMMANDS.
+ */
+#if defined(__EMSCRIPTEN__)
+#define ABCG_OPENGL_DESKTOP_COMMANDS(X)
+#else
+#define ABCG_OPENGL_DESKTOP_COMMANDS(X)                                        \
+  X(BindFragDataLocation, "-pvc")                                              \
+  X(GetTexLevelParameterfv, "?vvvo")                                           \
+  X(GetTexLevelParameteriv, "?vvvo")                                           \
+  X(FramebufferTexture, "-vvtv")                                               \
+  X(TexImage2DMultisample, "-vvvvvv")                                          \
+  X(QueryCounter, "-qv")                                                       \
+  X(GetQueryObjecti64v, "?qvo")                                                \
+  X(GetQueryObjectui64v, "?qvo")                                               \
+  X(GetDoublev, "?vo")
+#endif
+
+namespace abcg {
+enum class OpenGLCommand : std::uint16_t;
+template <typename TFun> struct OpenGLFunctionTraits;
+} // namespace abcg
+
+/**
+ * @brief Enumeration of the commands of an OpenGL capture.
+ *
+ * There is one command for each entry of ABCG_OPENGL_COMMANDS and
+ * ABCG_OPENGL_DESKTOP_COMMANDS, named after the OpenGL function without the
+ * `gl` prefix.
+ *
+ * @sa abcg::OpenGLCapture.
+ */
+enum class abcg::OpenGLCommand : std::uint16_t {
+  /** @brief Start of a captured frame. */
+  Frame,
+#define ABCG_OPENGL_COMMAND_ENUMERATOR(name, signature) name,
+  ABCG_OPENGL_COMMANDS(ABCG_OPENGL_COMMAND_ENUMERATOR)
+  ABCG_OPENGL_DESKTOP_COMMANDS(ABCG_OPENGL_COMMAND_ENUMERATOR)
+#undef ABCG_OPENGL_COMMAND_ENUMERATOR
+  /** @brief Number of commands. */
+  Count
+};
+
+/**
+ * @brief Parameter and return types of an OpenGL function.
+ *
+ * @tparam TFun Type of the function pointer.
+ *
+ * @remark The calling convention is ignored, so the OpenGL functions of
+ * 32-bit Windows builds, which use `__stdcall`, are not supported.
+ */
+template <typename TResult, typename... TArgs>
+struct abcg::OpenGLFunctionTraits<TResult (*)(TArgs...)> {
+  /** @brief Return type. */
+  using Result = TResult;
+  /** @brief Type of the argument at a given position. */
+  template <std::size_t Index>
+  using Argument = std::tuple_element_t<Index, std::tuple<TArgs...>>;
+  /** @brief Number of arguments. */
+  static constexpr std::size_t arity{sizeof...(TArgs)};
+};
+
+namespace abcg {
+/**
+ * @brief Returns the signature of a command.
+ *
+ * @param command Command.
+ *
+ * @return Signature as described in ABCG_OPENGL_COMMANDS, or an empty string
+ * for abcg::OpenGLCommand::Frame.
+ */
+[[nodiscard]] constexpr std::string_view
+getOpenGLCommandSignature(OpenGLCommand command) noexcept {
+  switch (command) {
+#define ABCG_OPENGL_COMMAND_CASE(name, signature)                              \
+  case OpenGLCommand::name:                                                    \
+    return signature;
+    ABCG_OPENGL_COMMANDS(ABCG_OPENGL_COMMAND_CASE)
+    ABCG_OPENGL_DESKTOP_COMMANDS(ABCG_OPENGL_COMMAND_CASE)
+#undef ABCG_OPENGL_COMMAND_CASE
+  default:
+    return {};
+  }
+}
+
+/**
+ * @brief Returns the name of the OpenGL function of a command.
+ *
+ * @param command Command.
+ *
+ * @return Function name without the `gl` prefix.
+ */
+[[nodiscard]] constexpr std::string_view
+getOpenGLCommandName(OpenGLCommand command) noexcept {
+  switch (command) {
+#define ABCG_OPENGL_COMMAND_CASE(name, signature)                              \
+  case OpenGLCommand::name:                                                    \
+    return #name;
+    ABCG_OPENGL_COMMANDS(ABCG_OPENGL_COMMAND_CASE)
+    ABCG_OPENGL_DESKTOP_COMMANDS(ABCG_OPENGL_COMMAND_CASE)
+#undef ABCG_OPENGL_COMMAND_CASE
+  case OpenGLCommand::Frame:
+    return "Frame";
+  default:
+    return {};
+  }
+}
+
+/**
+ * @brief Encodes an argument of an OpenGL function as a 64-bit word.
+ *
+ * Signed integers are zigzag-encoded, so that small negative values have
+ * short variable-length encodings. Floating-point values are stored as their
+ * bit patterns, and pointers as their addresses.
+ *
+ * @tparam T Type of the parameter of the OpenGL function.
+ *
+ * @param value Argument.
+ *
+ * @return Encoded argument.
+ */
+template <typename T>
+[[nodiscard]] std::uint64_t encodeOpenGLArgument(T value) noexcept {
+  if constexpr (std::is_pointer_v<T>) {
+    return reinterpret_cast<std::uintptr_t>(value);
+  } else if constexpr (std::is_same_v<T, float>) {
+    return std::bit_cast<std::uint32_t>(value);
+  } else if constexpr (std::is_same_v<T, double>) {
+    return std::bit_cast<std::uint64_t>(value);
+  } else if constexpr (std::is_signed_v<T>) {
+    auto const signedValue{static_cast<std::int64_t>(value)};
+    return (static_cast<std::uint64_t>(signedValue) << 1U) ^
+           static_cast<std::uint64_t>(signedValue >> 63);
+  } else {
+    return static_cast<std::uint64_t>(value);
+  }
+}
+
+/**
+ * @brief Decodes an argument encoded with abcg::encodeOpenGLArgument.
+ *
+ * @tparam T Type of the parameter of the OpenGL function.
+ *
+ * @param word Encoded argument.
+ *
+ * @return Argument.
+ */
+template <typename T>
+[[nodiscard]] T decodeOpenGLArgument(std::uint64_t word) noexcept {
+  if constexpr (std::is_pointer_v<T>) {
+    return reinterpret_cast<T>(gsl::narrow_cast<std::uintptr_t>(word));
+  } else if constexpr (std::is_same_v<T, float>) {
+    return std::bit_cast<float>(static_cast<std::uint32_t>(word));
+  } else if constexpr (std::is_same_v<T, double>) {
+    return std::bit_cast<double>(word);
+  } else if constexpr (std::is_signed_v<T>) {
+    return static_cast<T>(static_cast<std::int64_t>(word >> 1U) ^
+                          -static_cast<std::int64_t>(word & 1U));
+  } else {
+    return static_cast<T>(word);
+  }
+}
+} // namespace abcg
+
+#endif
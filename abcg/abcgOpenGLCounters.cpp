@@ -0,0 +1,121 @@
+/**
+ * @file abcgOpenGLCounters.cpp
+ * @brief Definition of abcg::OpenGLCounters members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgOpenGLCounters.hpp"
+
+namespace {
+// Returns the number of components of a pixel format
+std::uint64_t getComponentCount(GLenum format) noexcept {
+  switch (format) {
+  case GL_RED:
+  case GL_RED_INTEGER:
+  case GL_DEPTH_COMPONENT:
+  case GL_ALPHA:
+  case GL_LUMINANCE:
+    return 1;
+  case GL_RG:
+  case GL_RG_INTEGER:
+  case GL_DEPTH_STENCIL:
+  case GL_LUMINANCE_ALPHA:
+    return 2;
+  case GL_RGB:
+  case GL_RGB_INTEGER:
+    return 3;
+  default:
+    return 4;
+  }
+}
+
+// Returns the size of a pixel, or 0 if the components are not stored in
+// separate bytes
+std::uint64_t getPixelSize(GLenum format, GLenum type) noexcept {
+  switch (type) {
+  case GL_UNSIGNED_BYTE:
+  case GL_BYTE:
+    return getComponentCount(format);
+  case GL_UNSIGNED_SHORT:
+  case GL_SHORT:
+  case GL_HALF_FLOAT:
+    return 2 * getComponentCount(format);
+  case GL_UNSIGNED_INT:
+  case GL_INT:
+  case GL_FLOAT:
+    return 4 * getComponentCount(format);
+  case GL_UNSIGNED_SHORT_5_6_5:
+  case GL_UNSIGNED_SHORT_4_4_4_4:
+  case GL_UNSIGNED_SHORT_5_5_5_1:
+    return 2;
+  case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+    return 8;
+  default:
+    // Packed 32-bit types, such as GL_UNSIGNED_INT_24_8
+    return 4;
+  }
+}
+} // namespace
+
+/**
+ * @brief Starts a new frame.
+ *
+ * The counters of the current frame become the counters of the last frame,
+ * and the counters of the current frame are reset.
+ *
+ * @remark This is called by abcg::OpenGLWindow at the beginning of each
+ * frame.
+ */
+void abcg::OpenGLCounters::newFrame() noexcept {
+  m_lastFrame = m_frame;
+  m_frame = {};
+}
+
+/**
+ * @brief Returns the counters of the current frame.
+ *
+ * @return Counters updated since the last call to
+ * abcg::OpenGLCounters::newFrame.
+ */
+abcg::OpenGLFrameCounters const &
+abcg::OpenGLCounters::getFrameCounters() noexcept {
+  return m_frame;
+}
+
+/**
+ * @brief Returns the counters of the last complete frame.
+ *
+ * @return Counters of the frame before the last call to
+ * abcg::OpenGLCounters::newFrame.
+ */
+abcg::OpenGLFrameCounters const &
+abcg::OpenGLCounters::getLastFrameCounters() noexcept {
+  return m_lastFrame;
+}
+
+/**
+ * @brief Returns the size of an uncompressed texture upload.
+ *
+ * Row alignment (`GL_UNPACK_ALIGNMENT`) is not taken into account.
+ *
+ * @param width Width of the uploaded region.
+ * @param height Height of the uploaded region.
+ * @param depth Depth of the uploaded region.
+ * @param format Pixel format of the data.
+ * @param type Component type of the data.
+ *
+ * @return Size in bytes.
+ */
+std::uint64_t abcg::OpenGLCounters::getUploadSize(GLsizei width,
+                                                  GLsizei height, GLsizei depth,
+                                                  GLenum format,
+                                                  GLenum type) noexcept {
+  auto const texels{static_cast<std::uint64_t>(std::max(width, 0)) *
+                    static_cast<std::uint64_t>(std::max(height, 0)) *
+                    static_cast<std::uint64_t>(std::max(depth, 0))};
+  return texels * getPixelSize(format, type);
+}
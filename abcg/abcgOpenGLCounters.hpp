@@ -0,0 +1,174 @@
+/**
+ * @file abcgOpenGLCounters.hpp
+ * @brief Header file of abcg::OpenGLCounters.
+ *
+ * Declaration of abcg::OpenGLCounters and abcg::OpenGLFrameCounters.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_COUNTERS_HPP_
+#define ABCG_OPENGL_COUNTERS_HPP_
+
+#include <algorithm>
+#include <cstdint>
+
+#include "abcgOpenGLExternal.hpp"
+
+/**
+ * @brief Whether the `abcg::gl*` wrappers update the counters of
+ * abcg::OpenGLCounters.
+ *
+ * Define as 0 to remove the counters from the wrappers.
+ */
+#if !defined(ABCG_OPENGL_COUNTERS)
+#define ABCG_OPENGL_COUNTERS 1
+#endif
+
+namespace abcg {
+class OpenGLCounters;
+struct OpenGLFrameCounters;
+} // namespace abcg
+
+/**
+ * @brief Number of OpenGL commands and bytes submitted in a frame through
+ * the `abcg::gl*` wrappers.
+ */
+struct abcg::OpenGLFrameCounters {
+  /** @brief Number of glDrawArrays, glDrawElements and glDrawRangeElements
+   * calls, including their instanced versions. */
+  std::uint64_t drawCalls{};
+  /** @brief Number of vertices drawn, multiplied by the number of
+   * instances. */
+  std::uint64_t vertices{};
+  /** @brief Number of instances drawn. A non-instanced draw call counts as
+   * one instance. */
+  std::uint64_t instances{};
+  /** @brief Number of glUseProgram calls. */
+  std::uint64_t programBinds{};
+  /** @brief Number of glBindVertexArray calls. */
+  std::uint64_t vertexArrayBinds{};
+  /** @brief Number of glBindTexture calls. */
+  std::uint64_t textureBinds{};
+  /** @brief Number of glBindBuffer, glBindBufferBase and glBindBufferRange
+   * calls. */
+  std::uint64_t bufferBinds{};
+  /** @brief Number of glBindFramebuffer calls. */
+  std::uint64_t framebufferBinds{};
+  /** @brief Number of glUniform* and glUniformMatrix* calls. */
+  std::uint64_t uniformUploads{};
+  /** @brief Number of glTexParameter* calls. */
+  std::uint64_t textureParameterChanges{};
+  /** @brief Number of calls skipped by abcg::OpenGLStateCache because they
+   * would not change the state. */
+  std::uint64_t redundantCalls{};
+  /** @brief Number of bytes uploaded with glBufferData and
+   * glBufferSubData. */
+  std::uint64_t bufferBytesUploaded{};
+  /** @brief Number of bytes uploaded with glTexImage*, glTexSubImage* and
+   * their compressed versions. */
+  std::uint64_t textureBytesUploaded{};
+};
+
+/**
+ * @brief Counts the draw calls, state changes and uploads submitted through
+ * the `abcg::gl*` wrappers in each frame.
+ *
+ * abcg::OpenGLWindow starts a new frame at the beginning of
+ * abcg::OpenGLWindow::paint and shows the counters of the last frame in the
+ * FPS overlay. Commands issued by Dear ImGui are not counted, as they do not
+ * go through the wrappers.
+ *
+ * Updating a counter is a single addition to a global variable, so the
+ * counters are enabled in all build types. Define `ABCG_OPENGL_COUNTERS` as
+ * 0 to remove them.
+ *
+ * @remark The counters are not synchronized. They must be updated from the
+ * thread that owns the OpenGL context.
+ */
+class abcg::OpenGLCounters {
+public:
+  OpenGLCounters() = delete;
+
+  /**
+   * @brief Returns whether the wrappers update the counters.
+   *
+   * @return True if `ABCG_OPENGL_COUNTERS` is not 0.
+   */
+  [[nodiscard]] static constexpr bool isEnabled() noexcept {
+    return ABCG_OPENGL_COUNTERS != 0;
+  }
+
+  static void newFrame() noexcept;
+  [[nodiscard]] static OpenGLFrameCounters const &getFrameCounters() noexcept;
+  [[nodiscard]] static OpenGLFrameCounters const &
+  getLastFrameCounters() noexcept;
+
+  /**
+   * @brief Adds a value to a counter of the current frame.
+   *
+   * @param counter Counter to be updated.
+   * @param value Value to be added.
+   */
+  static void add(std::uint64_t OpenGLFrameCounters::*counter,
+                  std::uint64_t value = 1) noexcept {
+    if constexpr (isEnabled()) {
+      m_frame.*counter += value;
+    }
+  }
+
+  /**
+   * @brief Counts a draw call.
+   *
+   * @param count Number of vertices.
+   * @param instanceCount Number of instances.
+   */
+  static void addDraw(GLsizei count, GLsizei instanceCount = 1) noexcept {
+    if constexpr (isEnabled()) {
+      auto const vertices{static_cast<std::uint64_t>(std::max(count, 0))};
+      auto const instances{
+          static_cast<std::uint64_t>(std::max(instanceCount, 0))};
+      ++m_frame.drawCalls;
+      m_frame.vertices += vertices * instances;
+      m_frame.instances += instances;
+    }
+  }
+
+  /**
+   * @brief Counts the bytes of an uncompressed texture upload.
+   *
+   * Does nothing if `data` is null, i.e., if the call only allocates
+   * storage.
+   *
+   * @param width Width of the uploaded region.
+   * @param height Height of the uploaded region.
+   * @param depth Depth of the uploaded region.
+   * @param format Pixel format of the data.
+   * @param type Component type of the data.
+   * @param data Pointer to the data.
+   */
+  static void addTextureUpload(GLsizei width, GLsizei height, GLsizei depth,
+                               GLenum format, GLenum type,
+                               void const *data) noexcept {
+    if constexpr (isEnabled()) {
+      if (data != nullptr) {
+        m_frame.textureBytesUploaded +=
+            getUploadSize(width, height, depth, format, type);
+      }
+    }
+  }
+
+  [[nodiscard]] static std::uint64_t getUploadSize(GLsizei width,
+                                                   GLsizei height,
+                                                   GLsizei depth, GLenum format,
+                                                   GLenum type) noexcept;
+
+private:
+  static inline OpenGLFrameCounters m_frame{};
+  static inline OpenGLFrameCounters m_lastFrame{};
+};
+
+#endif
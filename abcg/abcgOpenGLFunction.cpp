@@ -1,6 +1,7 @@
 /**
  * @file abcgOpenGLFunction.cpp
- * @brief Definition of OpenGL-related error checking functions.
+ * @brief Definition of OpenGL-related error checking functions and of the
+ * helpers that account for OpenGL buffers and textures in abcg::GpuMemory.
  *
  * This file is part of ABCg (https://github.com/hbatagelo/abcg).
  *
@@ -11,6 +12,11 @@
 #include "abcgOpenGLFunction.hpp"
 #include "abcgOpenGLError.hpp"
 
+#include <cppitertools/itertools.hpp>
+#include <gsl/gsl>
+
+#include <utility>
+
 #if !defined(NDEBUG) && !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
 /**
  * @brief Checks OpenGL error status and throws on error with a log message.
@@ -30,3 +36,100 @@ void abcg::checkGLError(source_location const &sourceLocation,
   }
 }
 #endif
+
+namespace {
+// Returns the binding query of a buffer target and the name of the target
+std::pair<GLenum, char const *> getBufferBinding(GLenum target) noexcept {
+  switch (target) {
+  case GL_ARRAY_BUFFER:
+    return {GL_ARRAY_BUFFER_BINDING, "ARRAY_BUFFER"};
+  case GL_ELEMENT_ARRAY_BUFFER:
+    return {GL_ELEMENT_ARRAY_BUFFER_BINDING, "ELEMENT_ARRAY_BUFFER"};
+  case GL_UNIFORM_BUFFER:
+    return {GL_UNIFORM_BUFFER_BINDING, "UNIFORM_BUFFER"};
+  case GL_COPY_READ_BUFFER:
+    return {GL_COPY_READ_BUFFER_BINDING, "COPY_READ_BUFFER"};
+  case GL_COPY_WRITE_BUFFER:
+    return {GL_COPY_WRITE_BUFFER_BINDING, "COPY_WRITE_BUFFER"};
+  case GL_PIXEL_PACK_BUFFER:
+    return {GL_PIXEL_PACK_BUFFER_BINDING, "PIXEL_PACK_BUFFER"};
+  case GL_PIXEL_UNPACK_BUFFER:
+    return {GL_PIXEL_UNPACK_BUFFER_BINDING, "PIXEL_UNPACK_BUFFER"};
+  case GL_TRANSFORM_FEEDBACK_BUFFER:
+    return {GL_TRANSFORM_FEEDBACK_BUFFER_BINDING, "TRANSFORM_FEEDBACK_BUFFER"};
+  default:
+    return {GL_NONE, nullptr};
+  }
+}
+
+char const *getBufferUsageName(GLenum usage) noexcept {
+  switch (usage) {
+  case GL_STATIC_DRAW:
+    return "STATIC_DRAW";
+  case GL_DYNAMIC_DRAW:
+    return "DYNAMIC_DRAW";
+  case GL_STREAM_DRAW:
+    return "STREAM_DRAW";
+  case GL_STATIC_READ:
+    return "STATIC_READ";
+  case GL_DYNAMIC_READ:
+    return "DYNAMIC_READ";
+  case GL_STREAM_READ:
+    return "STREAM_READ";
+  case GL_STATIC_COPY:
+    return "STATIC_COPY";
+  case GL_DYNAMIC_COPY:
+    return "DYNAMIC_COPY";
+  case GL_STREAM_COPY:
+    return "STREAM_COPY";
+  default:
+    return "UNKNOWN_USAGE";
+  }
+}
+} // namespace
+
+/**
+ * @brief Records the storage allocated by glBufferData in abcg::GpuMemory.
+ *
+ * The buffer is the one currently bound to the target, as shadowed by
+ * abcg::OpenGLStateCache. OpenGL is only queried if the binding is not known.
+ * Storage allocated for targets that are not supported is not recorded.
+ *
+ * @param target Target of the glBufferData call.
+ * @param size Size of the storage, in bytes.
+ * @param usage Usage hint of the glBufferData call.
+ */
+void abcg::trackOpenGLBufferData(GLenum target, GLsizeiptr size,
+                                 GLenum usage) {
+  auto const [binding, targetName]{getBufferBinding(target)};
+  if (targetName == nullptr)
+    return;
+
+  auto buffer{OpenGLStateCache::getBoundBuffer(target)};
+  if (!buffer) {
+    GLint queried{};
+    ::glGetIntegerv(binding, &queried);
+    buffer = gsl::narrow<GLuint>(queried);
+  }
+  if (*buffer == 0)
+    return;
+
+  GpuMemory::track({.kind = GpuResourceKind::Buffer,
+                    .handle = *buffer,
+                    .bytes = gsl::narrow<std::uint64_t>(size),
+                    .formatParts = {targetName, getBufferUsageName(usage)}});
+}
+
+/**
+ * @brief Removes the records of OpenGL objects from abcg::GpuMemory.
+ *
+ * @param kind Kind of the objects.
+ * @param n Number of objects.
+ * @param names Names of the objects.
+ */
+void abcg::untrackOpenGLObjects(GpuResourceKind kind, GLsizei n,
+                                GLuint const *names) {
+  for (auto const index : iter::range(n)) {
+    GpuMemory::untrack(kind, names[index]);
+  }
+}
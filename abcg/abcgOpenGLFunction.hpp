@@ -31,7 +31,12 @@ using source_location = std::source_location;
 #include <string_view>
 #include <type_traits>
 
+#include "abcgGpuMemory.hpp"
+#include "abcgOpenGLCapture.hpp"
+#include "abcgOpenGLCounters.hpp"
 #include "abcgOpenGLExternal.hpp"
+#include "abcgOpenGLStateCache.hpp"
+#include "abcgOpenGLValidation.hpp"
 
 #if defined(_MSC_VER)
 // Disable "unreachable code" warnings for the case callGl is not specialized
@@ -47,7 +52,10 @@ void checkGLError(source_location const &sourceLocation,
                   std::string_view appendString);
 
 /**
- * @brief Checks for OpenGL errors before and after a function call.
+ * @brief Checks for OpenGL errors before and after a function call, if
+ * required by the validation level (see abcg::OpenGLValidation).
+ *
+ * If a capture is running, the call is recorded (see abcg::OpenGLCapture).
  *
  * @tparam TFun Function typename.
  * @tparam TArgs Variadic arguments typename.
@@ -61,16 +69,32 @@ void checkGLError(source_location const &sourceLocation,
 template <typename TFun, typename... TArgs>
 auto callGL(source_location const &sourceLocation, TFun &&function,
             TArgs &&...args) {
-  checkGLError(sourceLocation, "BEFORE function call");
+  OpenGLValidation::setLastCall(sourceLocation.file_name(),
+                                sourceLocation.line(),
+                                sourceLocation.function_name());
+  auto const checkErrors{OpenGLValidation::isCheckingErrors()};
+  if (checkErrors) {
+    checkGLError(sourceLocation, "BEFORE function call");
+  }
   if constexpr (!std::is_void_v<std::invoke_result_t<TFun, TArgs...>>) {
     // Specialization for functions that do not return void
-    auto &&res{std::forward<TFun>(function)(std::forward<TArgs>(args)...)};
-    checkGLError(sourceLocation, "AFTER function call");
+    auto &&res{function(args...)};
+    if (checkErrors) {
+      checkGLError(sourceLocation, "AFTER function call");
+    }
+    if (OpenGLCapture::isRecording()) {
+      OpenGLCapture::record(function, encodeOpenGLArgument(res), args...);
+    }
     return res;
   }
   // Specialization for functions that return void
-  std::forward<TFun>(function)(std::forward<TArgs>(args)...);
-  checkGLError(sourceLocation, "AFTER function call");
+  function(args...);
+  if (checkErrors) {
+    checkGLError(sourceLocation, "AFTER function call");
+  }
+  if (OpenGLCapture::isRecording()) {
+    OpenGLCapture::record(function, 0, args...);
+  }
 }
 
 #else
@@ -84,6 +108,8 @@ struct source_location {
 /**
  * @brief Calls a function with given arguments.
  *
+ * If a capture is running, the call is recorded (see abcg::OpenGLCapture).
+ *
  * @tparam TFun Function typename.
  * @tparam TArgs Variadic arguments typename.
  *
@@ -97,14 +123,23 @@ auto callGL([[maybe_unused]] source_location, TFun &&function,
             TArgs &&...args) {
   if constexpr (!std::is_void_v<std::invoke_result_t<TFun, TArgs...>>) {
     // Specialization for functions that do not return void
-    auto &&res{std::forward<TFun>(function)(std::forward<TArgs>(args)...)};
+    auto &&res{function(args...)};
+    if (OpenGLCapture::isRecording()) {
+      OpenGLCapture::record(function, encodeOpenGLArgument(res), args...);
+    }
     return res;
   }
   // Specialization for functions that return void
-  std::forward<TFun>(function)(std::forward<TArgs>(args)...);
+  function(args...);
+  if (OpenGLCapture::isRecording()) {
+    OpenGLCapture::record(function, 0, args...);
+  }
 }
 #endif
 
+void trackOpenGLBufferData(GLenum target, GLsizeiptr size, GLenum usage);
+void untrackOpenGLObjects(GpuResourceKind kind, GLsizei n, GLuint const *names);
+
 // NOLINTBEGIN(readability-identifier-length)
 
 // OpenGL ES 2.0 function definitions
@@ -112,6 +147,8 @@ auto callGL([[maybe_unused]] source_location, TFun &&function,
 inline void glActiveTexture(
     GLenum texture,
     source_location const &sourceLocation = source_location::current()) {
+  if (!OpenGLStateCache::activeTexture(texture))
+    return;
   callGL(sourceLocation, ::glActiveTexture, texture);
 }
 inline void glAttachShader(
@@ -127,12 +164,16 @@ inline void glBindAttribLocation(
 inline void glBindBuffer(
     GLenum target, GLuint buffer,
     source_location const &sourceLocation = source_location::current()) {
+  if (!OpenGLStateCache::bindBuffer(target, buffer))
+    return;
   callGL(sourceLocation, ::glBindBuffer, target, buffer);
+  OpenGLCounters::add(&OpenGLFrameCounters::bufferBinds);
 }
 inline void glBindFramebuffer(
     GLenum target, GLuint framebuffer,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glBindFramebuffer, target, framebuffer);
+  OpenGLCounters::add(&OpenGLFrameCounters::framebufferBinds);
 }
 inline void glBindRenderbuffer(
     GLenum target, GLuint renderbuffer,
@@ -142,7 +183,10 @@ inline void glBindRenderbuffer(
 inline void glBindTexture(
     GLenum target, GLuint texture,
     source_location const &sourceLocation = source_location::current()) {
+  if (!OpenGLStateCache::bindTexture(target, texture))
+    return;
   callGL(sourceLocation, ::glBindTexture, target, texture);
+  OpenGLCounters::add(&OpenGLFrameCounters::textureBinds);
 }
 inline void glBlendColor(
     GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha,
@@ -161,6 +205,8 @@ inline void glBlendEquationSeparate(
 inline void glBlendFunc(
     GLenum sfactor, GLenum dfactor,
     source_location const &sourceLocation = source_location::current()) {
+  if (!OpenGLStateCache::blendFunc(sfactor, dfactor))
+    return;
   callGL(sourceLocation, ::glBlendFunc, sfactor, dfactor);
 }
 inline void glBlendFuncSeparate(
@@ -168,16 +214,24 @@ inline void glBlendFuncSeparate(
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glBlendFuncSeparate, srcRGB, dstRGB, srcAlpha,
          dstAlpha);
+  OpenGLStateCache::invalidateBlendFunc();
 }
 inline void glBufferData(
     GLenum target, GLsizeiptr size, void const *data, GLenum usage,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glBufferData, target, size, data, usage);
+  trackOpenGLBufferData(target, size, usage);
+  if (data != nullptr) {
+    OpenGLCounters::add(&OpenGLFrameCounters::bufferBytesUploaded,
+                        static_cast<std::uint64_t>(size));
+  }
 }
 inline void glBufferSubData(
     GLenum target, GLintptr offset, GLsizeiptr size, void const *data,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glBufferSubData, target, offset, size, data);
+  OpenGLCounters::add(&OpenGLFrameCounters::bufferBytesUploaded,
+                      static_cast<std::uint64_t>(size));
 }
 inline GLenum glCheckFramebufferStatus(
     GLenum target,
@@ -218,6 +272,10 @@ inline void glCompressedTexImage2D(
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glCompressedTexImage2D, target, level,
          internalformat, width, height, border, imageSize, data);
+  if (data != nullptr) {
+    OpenGLCounters::add(&OpenGLFrameCounters::textureBytesUploaded,
+                        static_cast<std::uint64_t>(imageSize));
+  }
 }
 inline void glCompressedTexSubImage2D(
     GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width,
@@ -225,6 +283,10 @@ inline void glCompressedTexSubImage2D(
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glCompressedTexSubImage2D, target, level, xoffset,
          yoffset, width, height, format, imageSize, data);
+  if (data != nullptr) {
+    OpenGLCounters::add(&OpenGLFrameCounters::textureBytesUploaded,
+                        static_cast<std::uint64_t>(imageSize));
+  }
 }
 inline void glCopyTexImage2D(
     GLenum target, GLint level, GLenum internalformat, GLint x, GLint y,
@@ -259,7 +321,9 @@ inline void glDeleteBuffers(
     source_location const &sourceLocation = source_location::current()) {
   if (buffers == nullptr || *buffers == 0)
     return;
+  untrackOpenGLObjects(GpuResourceKind::Buffer, n, buffers);
   callGL(sourceLocation, ::glDeleteBuffers, n, buffers);
+  OpenGLStateCache::onBuffersDeleted(n, buffers);
 }
 inline void glDeleteFramebuffers(
     GLsizei n, GLuint const *framebuffers,
@@ -274,12 +338,14 @@ inline void glDeleteProgram(
   if (program == 0)
     return;
   callGL(sourceLocation, ::glDeleteProgram, program);
+  OpenGLStateCache::onProgramDeleted(program);
 }
 inline void glDeleteRenderbuffers(
     GLsizei n, GLuint *renderbuffers,
     source_location const &sourceLocation = source_location::current()) {
   if (renderbuffers == nullptr || *renderbuffers == 0)
     return;
+  untrackOpenGLObjects(GpuResourceKind::Renderbuffer, n, renderbuffers);
   callGL(sourceLocation, ::glDeleteRenderbuffers, n, renderbuffers);
 }
 inline void glDeleteShader(
@@ -294,7 +360,9 @@ inline void glDeleteTextures(
     source_location const &sourceLocation = source_location::current()) {
   if (textures == nullptr || *textures == 0)
     return;
+  untrackOpenGLObjects(GpuResourceKind::Texture, n, textures);
   callGL(sourceLocation, ::glDeleteTextures, n, textures);
+  OpenGLStateCache::onTexturesDeleted(n, textures);
 }
 inline void glDepthFunc(GLenum func, source_location const &sourceLocation =
                                          source_location::current()) {
@@ -317,6 +385,8 @@ inline void glDetachShader(
 inline void
 glDisable(GLenum cap,
           source_location const &sourceLocation = source_location::current()) {
+  if (!OpenGLStateCache::setCapability(cap, false))
+    return;
   callGL(sourceLocation, ::glDisable, cap);
 }
 inline void glDisableVertexAttribArray(
@@ -328,15 +398,19 @@ inline void glDrawArrays(
     GLenum mode, GLint first, GLsizei count,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glDrawArrays, mode, first, count);
+  OpenGLCounters::addDraw(count);
 }
 inline void glDrawElements(
     GLenum mode, GLsizei count, GLenum type, void const *indices,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glDrawElements, mode, count, type, indices);
+  OpenGLCounters::addDraw(count);
 }
 inline void
 glEnable(GLenum cap,
          source_location const &sourceLocation = source_location::current()) {
+  if (!OpenGLStateCache::setCapability(cap, true))
+    return;
   callGL(sourceLocation, ::glEnable, cap);
 }
 inline void glEnableVertexAttribArray(
@@ -661,27 +735,32 @@ inline void glTexImage2D(
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glTexImage2D, target, level, internalformat, width,
          height, border, format, type, data);
+  OpenGLCounters::addTextureUpload(width, height, 1, format, type, data);
 }
 
 inline void glTexParameterf(
     GLenum target, GLenum pname, GLfloat param,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glTexParameterf, target, pname, param);
+  OpenGLCounters::add(&OpenGLFrameCounters::textureParameterChanges);
 }
 inline void glTexParameterfv(
     GLenum target, GLenum pname, GLfloat const *params,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glTexParameterfv, target, pname, params);
+  OpenGLCounters::add(&OpenGLFrameCounters::textureParameterChanges);
 }
 inline void glTexParameteri(
     GLenum target, GLenum pname, GLint param,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glTexParameteri, target, pname, param);
+  OpenGLCounters::add(&OpenGLFrameCounters::textureParameterChanges);
 }
 inline void glTexParameteriv(
     GLenum target, GLenum pname, GLint const *params,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glTexParameteriv, target, pname, params);
+  OpenGLCounters::add(&OpenGLFrameCounters::textureParameterChanges);
 }
 inline void glTexSubImage2D(
     GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width,
@@ -689,108 +768,131 @@ inline void glTexSubImage2D(
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glTexSubImage2D, target, level, xoffset, yoffset,
          width, height, format, type, pixels);
+  OpenGLCounters::addTextureUpload(width, height, 1, format, type, pixels);
 }
 inline void glUniform1f(
     GLint location, GLfloat v0,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniform1f, location, v0);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniform1fv(
     GLint location, GLsizei count, GLfloat const *value,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniform1fv, location, count, value);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniform1i(
     GLint location, GLint v0,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniform1i, location, v0);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniform1iv(
     GLint location, GLsizei count, GLint const *value,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniform1iv, location, count, value);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniform2f(
     GLint location, GLfloat v0, GLfloat v1,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniform2f, location, v0, v1);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniform2fv(
     GLint location, GLsizei count, GLfloat const *value,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniform2fv, location, count, value);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniform2i(
     GLint location, GLint v0, GLint v1,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniform2i, location, v0, v1);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniform2iv(
     GLint location, GLsizei count, GLint const *value,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniform2iv, location, count, value);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniform3f(
     GLint location, GLfloat v0, GLfloat v1, GLfloat v2,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniform3f, location, v0, v1, v2);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniform3fv(
     GLint location, GLsizei count, GLfloat const *value,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniform3fv, location, count, value);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniform3i(
     GLint location, GLint v0, GLint v1, GLint v2,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniform3i, location, v0, v1, v2);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniform3iv(
     GLint location, GLsizei count, GLint const *value,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniform3iv, location, count, value);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniform4f(
     GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniform4f, location, v0, v1, v2, v3);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniform4fv(
     GLint location, GLsizei count, GLfloat const *value,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniform4fv, location, count, value);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniform4i(
     GLint location, GLint v0, GLint v1, GLint v2, GLint v3,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniform4i, location, v0, v1, v2, v3);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniform4iv(
     GLint location, GLsizei count, GLint const *value,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniform4iv, location, count, value);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniformMatrix2fv(
     GLint location, GLsizei count, GLboolean transpose, GLfloat const *value,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniformMatrix2fv, location, count, transpose,
          value);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniformMatrix3fv(
     GLint location, GLsizei count, GLboolean transpose, GLfloat const *value,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniformMatrix3fv, location, count, transpose,
          value);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniformMatrix4fv(
     GLint location, GLsizei count, GLboolean transpose, GLfloat const *value,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniformMatrix4fv, location, count, transpose,
          value);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUseProgram(GLuint program, source_location const &sourceLocation =
                                              source_location::current()) {
+  if (!OpenGLStateCache::useProgram(program))
+    return;
   callGL(sourceLocation, ::glUseProgram, program);
+  OpenGLCounters::add(&OpenGLFrameCounters::programBinds);
 }
 inline void glValidateProgram(
     GLuint program,
@@ -847,6 +949,8 @@ inline void glVertexAttribPointer(
 inline void
 glViewport(GLint x, GLint y, GLsizei width, GLsizei height,
            source_location const &sourceLocation = source_location::current()) {
+  if (!OpenGLStateCache::viewport(x, y, width, height))
+    return;
   callGL(sourceLocation, ::glViewport, x, y, width, height);
 }
 
@@ -862,6 +966,7 @@ inline void glDrawRangeElements(
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glDrawRangeElements, mode, start, end, count, type,
          indices);
+  OpenGLCounters::addDraw(count);
 }
 inline void glTexImage3D(
     GLenum target, GLint level, GLint internalformat, GLsizei width,
@@ -870,6 +975,8 @@ inline void glTexImage3D(
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glTexImage3D, target, level, internalformat, width,
          height, depth, border, format, type, pixels);
+  OpenGLCounters::addTextureUpload(width, height, depth, format, type,
+                                   pixels);
 }
 inline void glTexSubImage3D(
     GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset,
@@ -878,6 +985,8 @@ inline void glTexSubImage3D(
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glTexSubImage3D, target, level, xoffset, yoffset,
          zoffset, width, height, depth, format, type, pixels);
+  OpenGLCounters::addTextureUpload(width, height, depth, format, type,
+                                   pixels);
 }
 inline void glCopyTexSubImage3D(
     GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset,
@@ -893,6 +1002,10 @@ inline void glCompressedTexImage3D(
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glCompressedTexImage3D, target, level,
          internalformat, width, height, depth, border, imageSize, data);
+  if (data != nullptr) {
+    OpenGLCounters::add(&OpenGLFrameCounters::textureBytesUploaded,
+                        static_cast<std::uint64_t>(imageSize));
+  }
 }
 inline void glCompressedTexSubImage3D(
     GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset,
@@ -901,6 +1014,10 @@ inline void glCompressedTexSubImage3D(
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glCompressedTexSubImage3D, target, level, xoffset,
          yoffset, zoffset, width, height, depth, format, imageSize, data);
+  if (data != nullptr) {
+    OpenGLCounters::add(&OpenGLFrameCounters::textureBytesUploaded,
+                        static_cast<std::uint64_t>(imageSize));
+  }
 }
 inline void glGenQueries(
     GLsizei n, GLuint *ids,
@@ -957,36 +1074,42 @@ inline void glUniformMatrix2x3fv(
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniformMatrix2x3fv, location, count, transpose,
          value);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniformMatrix3x2fv(
     GLint location, GLsizei count, GLboolean transpose, GLfloat const *value,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniformMatrix3x2fv, location, count, transpose,
          value);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniformMatrix2x4fv(
     GLint location, GLsizei count, GLboolean transpose, GLfloat const *value,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniformMatrix2x4fv, location, count, transpose,
          value);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniformMatrix4x2fv(
     GLint location, GLsizei count, GLboolean transpose, GLfloat const *value,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniformMatrix4x2fv, location, count, transpose,
          value);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniformMatrix3x4fv(
     GLint location, GLsizei count, GLboolean transpose, GLfloat const *value,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniformMatrix3x4fv, location, count, transpose,
          value);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniformMatrix4x3fv(
     GLint location, GLsizei count, GLboolean transpose, GLfloat const *value,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniformMatrix4x3fv, location, count, transpose,
          value);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glBlitFramebuffer(
     GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0,
@@ -1022,12 +1145,16 @@ inline void glFlushMappedBufferRange(
 inline void glBindVertexArray(
     GLuint array,
     source_location const &sourceLocation = source_location::current()) {
+  if (!OpenGLStateCache::bindVertexArray(array))
+    return;
   callGL(sourceLocation, ::glBindVertexArray, array);
+  OpenGLCounters::add(&OpenGLFrameCounters::vertexArrayBinds);
 }
 inline void glDeleteVertexArrays(
     GLsizei n, GLuint const *arrays,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glDeleteVertexArrays, n, arrays);
+  OpenGLStateCache::onVertexArraysDeleted(n, arrays);
 }
 inline void glGenVertexArrays(
     GLsizei n, GLuint *arrays,
@@ -1059,11 +1186,15 @@ inline void glBindBufferRange(
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glBindBufferRange, target, index, buffer, offset,
          size);
+  OpenGLStateCache::invalidateBuffer(target);
+  OpenGLCounters::add(&OpenGLFrameCounters::bufferBinds);
 }
 inline void glBindBufferBase(
     GLenum target, GLuint index, GLuint buffer,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glBindBufferBase, target, index, buffer);
+  OpenGLStateCache::invalidateBuffer(target);
+  OpenGLCounters::add(&OpenGLFrameCounters::bufferBinds);
 }
 inline void glTransformFeedbackVaryings(
     GLuint program, GLsizei count, GLchar const *const *varyings,
@@ -1129,41 +1260,49 @@ inline void glUniform1ui(
     GLint location, GLuint v0,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniform1ui, location, v0);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniform2ui(
     GLint location, GLuint v0, GLuint v1,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniform2ui, location, v0, v1);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniform3ui(
     GLint location, GLuint v0, GLuint v1, GLuint v2,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniform3ui, location, v0, v1, v2);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniform4ui(
     GLint location, GLuint v0, GLuint v1, GLuint v2, GLuint v3,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniform4ui, location, v0, v1, v2, v3);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniform1uiv(
     GLint location, GLsizei count, GLuint const *value,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniform1uiv, location, count, value);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniform2uiv(
     GLint location, GLsizei count, GLuint const *value,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniform2uiv, location, count, value);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniform3uiv(
     GLint location, GLsizei count, GLuint const *value,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniform3uiv, location, count, value);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glUniform4uiv(
     GLint location, GLsizei count, GLuint const *value,
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glUniform4uiv, location, count, value);
+  OpenGLCounters::add(&OpenGLFrameCounters::uniformUploads);
 }
 inline void glClearBufferiv(
     GLenum buffer, GLint drawbuffer, GLint const *value,
@@ -1242,6 +1381,7 @@ inline void glDrawArraysInstanced(
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glDrawArraysInstanced, mode, first, count,
          instancecount);
+  OpenGLCounters::addDraw(count, instancecount);
 }
 inline void glDrawElementsInstanced(
     GLenum mode, GLsizei count, GLenum type, void const *indices,
@@ -1249,6 +1389,7 @@ inline void glDrawElementsInstanced(
     source_location const &sourceLocation = source_location::current()) {
   callGL(sourceLocation, ::glDrawElementsInstanced, mode, count, type, indices,
          instancecount);
+  OpenGLCounters::addDraw(count, instancecount);
 }
 inline GLsync glFenceSync(
     GLenum condition, GLbitfield flags,
@@ -1471,6 +1612,24 @@ inline void glTexImage2DMultisample(
          internalformat, width, height, fixedsamplelocations);
 }
 
+// OpenGL 3.3+ function definitions
+
+inline void glQueryCounter(
+    GLuint id, GLenum target,
+    source_location const &sourceLocation = source_location::current()) {
+  callGL(sourceLocation, ::glQueryCounter, id, target);
+}
+inline void glGetQueryObjecti64v(
+    GLuint id, GLenum pname, GLint64 *params,
+    source_location const &sourceLocation = source_location::current()) {
+  callGL(sourceLocation, ::glGetQueryObjecti64v, id, pname, params);
+}
+inline void glGetQueryObjectui64v(
+    GLuint id, GLenum pname, GLuint64 *params,
+    source_location const &sourceLocation = source_location::current()) {
+  callGL(sourceLocation, ::glGetQueryObjectui64v, id, pname, params);
+}
+
 // OpenGL 2.0+ function definitions
 
 inline void glGetDoublev(
@@ -0,0 +1,246 @@
+/**
+ * @file abcgOpenGLGpuTimer.cpp
+ * @brief Definition of abcg::OpenGLGpuTimer members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgOpenGLGpuTimer.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+#include "abcgExternal.hpp"
+
+namespace {
+// Number of frames between two estimates of the GPU clock offset, which
+// compensate for drift between the CPU and GPU clocks
+constexpr std::uint64_t framesBetweenCalibrations{60};
+} // namespace
+
+/**
+ * @brief Creates the timer.
+ *
+ * Must be called with the OpenGL context current.
+ *
+ * @param frameLatency Number of frames in the ring, i.e., how many frames
+ * after being issued the queries are read back. Values smaller than 2 are
+ * clamped to 2.
+ */
+void abcg::OpenGLGpuTimer::create(std::size_t frameLatency) {
+  destroy();
+
+#if !defined(__EMSCRIPTEN__)
+  m_supported = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+#endif
+  if (!m_supported)
+    return;
+
+  m_frames.resize(std::max<std::size_t>(frameLatency, 2));
+  calibrateClock();
+}
+
+/**
+ * @brief Releases the query objects.
+ *
+ * Must be called with the OpenGL context current.
+ */
+void abcg::OpenGLGpuTimer::destroy() {
+  for (auto &frame : m_frames) {
+    if (!frame.queries.empty()) {
+      glDeleteQueries(gsl::narrow<GLsizei>(frame.queries.size()),
+                      frame.queries.data());
+    }
+  }
+  m_frames.clear();
+  m_results.clear();
+  m_supported = false;
+  m_currentFrame = 0;
+  m_frameCount = 0;
+}
+
+/**
+ * @brief Returns whether timer queries are available.
+ *
+ * @return True if the timer was created on a context with support for
+ * `GL_TIMESTAMP` queries.
+ */
+bool abcg::OpenGLGpuTimer::isSupported() const noexcept { return m_supported; }
+
+/**
+ * @brief Starts a new frame.
+ *
+ * Reads back the queries of the oldest frame of the ring, whose slot is
+ * reused by the new frame. If the GPU has not finished that frame yet, its
+ * results are discarded.
+ *
+ * @remark abcg::OpenGLWindow calls this at the start of each frame.
+ *
+ * @return True if abcg::OpenGLGpuTimer::getResults was updated.
+ */
+bool abcg::OpenGLGpuTimer::beginFrame() {
+  if (!m_supported)
+    return false;
+
+  m_currentFrame = (m_currentFrame + 1) % m_frames.size();
+  auto &frame{m_frames.at(m_currentFrame)};
+  auto const updated{frame.usedScopes > 0 && readResults(frame)};
+  frame.usedQueries = 0;
+  frame.usedScopes = 0;
+  frame.openScopes = 0;
+
+  if (++m_frameCount % framesBetweenCalibrations == 0) {
+    calibrateClock();
+  }
+  return updated;
+}
+
+/**
+ * @brief Opens a scope.
+ *
+ * @param name Name of the scope.
+ *
+ * @return Handle to be passed to abcg::OpenGLGpuTimer::end.
+ */
+std::size_t abcg::OpenGLGpuTimer::begin(std::string_view name) {
+  if (!m_supported)
+    return 0;
+
+  auto &frame{m_frames.at(m_currentFrame)};
+  if (frame.usedScopes == frame.scopes.size()) {
+    frame.scopes.emplace_back();
+  }
+  auto const index{frame.usedScopes++};
+  auto &scope{frame.scopes.at(index)};
+  scope.name = name;
+  scope.depth = gsl::narrow<std::uint32_t>(frame.openScopes++);
+  scope.beginQuery = issueQuery(frame);
+  scope.endQuery = scope.beginQuery;
+  return index;
+}
+
+/**
+ * @brief Closes a scope.
+ *
+ * @param scope Handle returned by abcg::OpenGLGpuTimer::begin in the same
+ * frame.
+ */
+void abcg::OpenGLGpuTimer::end(std::size_t scope) {
+  if (!m_supported)
+    return;
+
+  auto &frame{m_frames.at(m_currentFrame)};
+  frame.scopes.at(scope).endQuery = issueQuery(frame);
+  frame.openScopes = std::max<std::size_t>(frame.openScopes, 1) - 1;
+}
+
+/**
+ * @brief Returns the GPU times of the most recent frame read back.
+ *
+ * @return Results in the order the scopes were opened.
+ */
+std::vector<abcg::OpenGLGpuTimerResult> const &
+abcg::OpenGLGpuTimer::getResults() const noexcept {
+  return m_results;
+}
+
+/**
+ * @brief Returns the GPU time of a scope of the most recent frame read back.
+ *
+ * @param name Name of the scope. If several scopes have the same name, their
+ * times are added.
+ *
+ * @return GPU time in seconds, or an empty optional if no scope has the given
+ * name.
+ */
+std::optional<double>
+abcg::OpenGLGpuTimer::getTime(std::string_view name) const {
+  std::optional<double> time;
+  for (auto const &result : m_results) {
+    if (result.name == name) {
+      time = time.value_or(0.0) +
+             gsl::narrow_cast<double>(result.end - result.start) * 1e-9;
+    }
+  }
+  return time;
+}
+
+/**
+ * @brief Returns the number of frames whose results were discarded because
+ * the GPU had not finished them when their slot was reused.
+ *
+ * A steadily increasing count means the GPU runs more frames behind the CPU
+ * than the frame latency given to abcg::OpenGLGpuTimer::create.
+ *
+ * @return Number of discarded frames.
+ */
+std::uint64_t abcg::OpenGLGpuTimer::getDiscardedFrameCount() const noexcept {
+  return m_discardedFrames;
+}
+
+// Writes a timestamp query and returns its index in the frame's query pool
+std::size_t abcg::OpenGLGpuTimer::issueQuery(Frame &frame) {
+  if (frame.usedQueries == frame.queries.size()) {
+    GLuint query{};
+    glGenQueries(1, &query);
+    frame.queries.push_back(query);
+  }
+#if !defined(__EMSCRIPTEN__)
+  glQueryCounter(frame.queries.at(frame.usedQueries), GL_TIMESTAMP);
+#endif
+  return frame.usedQueries++;
+}
+
+// Reads the queries of a frame into m_results if they are available. Queries
+// complete in order, so the last one being available implies that the others
+// are too.
+bool abcg::OpenGLGpuTimer::readResults(Frame &frame) {
+  if (frame.openScopes > 0) {
+    ++m_discardedFrames;
+    return false;
+  }
+
+  GLuint available{};
+  glGetQueryObjectuiv(frame.queries.at(frame.usedQueries - 1),
+                      GL_QUERY_RESULT_AVAILABLE, &available);
+  if (available == GL_FALSE) {
+    ++m_discardedFrames;
+    return false;
+  }
+
+#if !defined(__EMSCRIPTEN__)
+  auto const readTimestamp{[&](std::size_t query) {
+    GLuint64 timestamp{};
+    glGetQueryObjectui64v(frame.queries.at(query), GL_QUERY_RESULT,
+                          &timestamp);
+    return gsl::narrow_cast<std::int64_t>(timestamp) + m_clockOffset;
+  }};
+
+  m_results.resize(frame.usedScopes);
+  for (auto const index : iter::range(frame.usedScopes)) {
+    auto const &scope{frame.scopes.at(index)};
+    auto &result{m_results.at(index)};
+    result.name = scope.name;
+    result.start = readTimestamp(scope.beginQuery);
+    result.end = readTimestamp(scope.endQuery);
+    result.depth = scope.depth;
+  }
+#endif
+  return true;
+}
+
+// Estimates the offset from the GPU clock to the steady_clock. Reading
+// GL_TIMESTAMP does not wait for the GPU to finish previous commands.
+void abcg::OpenGLGpuTimer::calibrateClock() {
+#if !defined(__EMSCRIPTEN__)
+  GLint64 gpuTime{};
+  glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+  auto const cpuTime{std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::now().time_since_epoch())
+                         .count()};
+  m_clockOffset = cpuTime - gpuTime;
+#endif
+}
@@ -0,0 +1,119 @@
+/**
+ * @file abcgOpenGLGpuTimer.hpp
+ * @brief Header file of abcg::OpenGLGpuTimer.
+ *
+ * Declaration of abcg::OpenGLGpuTimer and abcg::OpenGLGpuTimerResult.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_GPU_TIMER_HPP_
+#define ABCG_OPENGL_GPU_TIMER_HPP_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "abcgOpenGLFunction.hpp"
+
+namespace abcg {
+class OpenGLGpuTimer;
+struct OpenGLGpuTimerResult;
+} // namespace abcg
+
+/**
+ * @brief GPU time of a scope measured by abcg::OpenGLGpuTimer.
+ */
+struct abcg::OpenGLGpuTimerResult {
+  /** @brief Name of the scope. */
+  std::string name;
+  /** @brief Start time, in nanoseconds of `std::chrono::steady_clock`,
+   * estimated from the GPU clock. */
+  std::int64_t start{};
+  /** @brief End time, in nanoseconds of `std::chrono::steady_clock`,
+   * estimated from the GPU clock. */
+  std::int64_t end{};
+  /** @brief Nesting level of the scope, starting at 0. */
+  std::uint32_t depth{};
+};
+
+/**
+ * @brief Measures the GPU time of named scopes without stalling the pipeline.
+ *
+ * Each scope issues a pair of `GL_TIMESTAMP` queries, so scopes can be
+ * nested. Queries are kept in a ring of frames and read back when the ring
+ * wraps around, several frames after being issued, by which time the GPU has
+ * usually finished them. Results that are not yet available are discarded
+ * instead of waited for, so the CPU never blocks.
+ *
+ * abcg::OpenGLWindow owns a timer that measures the scene
+ * (abcg::OpenGLWindow::onPaint) and the UI as the scopes "Scene" and "UI".
+ * Other scopes can be added from abcg::OpenGLWindow::onPaint:
+ *
+ * @code
+ * auto &timer{getGpuTimer()};
+ * auto const shadowPass{timer.begin("Shadow pass")};
+ * // Draw calls of the shadow pass
+ * timer.end(shadowPass);
+ * @endcode
+ *
+ * @remark Timer queries are not available in OpenGL ES and WebGL. There,
+ * abcg::OpenGLGpuTimer::isSupported returns false and no results are
+ * produced.
+ */
+class abcg::OpenGLGpuTimer {
+public:
+  /** @brief Default number of frames in the ring. */
+  static constexpr std::size_t defaultFrameLatency{4};
+
+  void create(std::size_t frameLatency = defaultFrameLatency);
+  void destroy();
+
+  [[nodiscard]] bool isSupported() const noexcept;
+
+  bool beginFrame();
+  [[nodiscard]] std::size_t begin(std::string_view name);
+  void end(std::size_t scope);
+
+  [[nodiscard]] std::vector<OpenGLGpuTimerResult> const &
+  getResults() const noexcept;
+  [[nodiscard]] std::optional<double> getTime(std::string_view name) const;
+  [[nodiscard]] std::uint64_t getDiscardedFrameCount() const noexcept;
+
+private:
+  struct Scope {
+    std::string name;
+    std::uint32_t depth{};
+    // Indices of the timestamp queries in the frame's query pool
+    std::size_t beginQuery{};
+    std::size_t endQuery{};
+  };
+
+  struct Frame {
+    std::vector<GLuint> queries;
+    std::size_t usedQueries{};
+    std::vector<Scope> scopes;
+    std::size_t usedScopes{};
+    std::size_t openScopes{};
+  };
+
+  [[nodiscard]] std::size_t issueQuery(Frame &frame);
+  bool readResults(Frame &frame);
+  void calibrateClock();
+
+  bool m_supported{};
+  std::vector<Frame> m_frames;
+  std::size_t m_currentFrame{};
+  std::uint64_t m_frameCount{};
+  std::uint64_t m_discardedFrames{};
+  std::vector<OpenGLGpuTimerResult> m_results;
+  // Offset from GPU timestamps to steady_clock time, in nanoseconds
+  std::int64_t m_clockOffset{};
+};
+
+#endif
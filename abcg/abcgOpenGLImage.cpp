@@ -16,6 +16,21 @@
 #include <gsl/gsl>
 
 #include "abcgException.hpp"
+#include "abcgGpuMemory.hpp"
+#include "abcgHitchDetector.hpp"
+#include "abcgMetrics.hpp"
+
+namespace {
+// Adds the size of an image uploaded to the GPU to the metrics
+void countTextureUpload(SDL_Surface const &surface) {
+  static auto &bytesUploaded{
+      abcg::Metrics::counter("abcg.texture_bytes_uploaded")};
+  bytesUploaded.add(gsl::narrow<std::uint64_t>(surface.pitch * surface.h));
+}
+
+// Drivers usually store RGB8 textures with 4 bytes per texel
+constexpr std::uint32_t bytesPerTexel{4};
+} // namespace
 
 /**
  * @brief Creates an OpenGL 2D texture from an image loaded from a filesystem
@@ -30,21 +45,27 @@
 GLuint abcg::loadOpenGLTexture(OpenGLTextureCreateInfo const &createInfo) {
   GLuint textureID{};
 
+  abcg::HitchDetector::addNote(
+      fmt::format("Texture loaded: {}", createInfo.path));
+  abcg::initSDLImage();
   if (SDL_Surface *const surface{IMG_Load(createInfo.path.data())}) {
     // Enforce RGB/RGBA
     GLenum internalFormat{};
     GLenum format{};
+    char const *formatName{};
     SDL_Surface *formattedSurface{};
     if (surface->format->BytesPerPixel == 3) {
       formattedSurface =
           SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGB24, 0);
       internalFormat = createInfo.sRGBToLinear ? GL_SRGB8 : GL_RGB;
       format = GL_RGB;
+      formatName = createInfo.sRGBToLinear ? "SRGB8" : "RGB8";
     } else {
       formattedSurface =
           SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
       internalFormat = createInfo.sRGBToLinear ? GL_SRGB8_ALPHA8 : GL_RGBA;
       format = GL_RGBA;
+      formatName = createInfo.sRGBToLinear ? "SRGB8_ALPHA8" : "RGBA8";
     }
     SDL_FreeSurface(surface);
 
@@ -59,6 +80,21 @@ GLuint abcg::loadOpenGLTexture(OpenGLTextureCreateInfo const &createInfo) {
     glTexImage2D(GL_TEXTURE_2D, 0, gsl::narrow<GLint>(internalFormat),
                  formattedSurface->w, formattedSurface->h, 0, format,
                  GL_UNSIGNED_BYTE, formattedSurface->pixels);
+    countTextureUpload(*formattedSurface);
+
+    auto const width{gsl::narrow<std::uint32_t>(formattedSurface->w)};
+    auto const height{gsl::narrow<std::uint32_t>(formattedSurface->h)};
+    auto const mipLevels{createInfo.generateMipmaps
+                             ? GpuMemory::getMipLevelCount(width, height)
+                             : 1U};
+    GpuMemory::track(
+        {.kind = GpuResourceKind::Texture,
+         .handle = textureID,
+         .bytes = GpuMemory::getTextureSize(width, height, bytesPerTexel,
+                                            mipLevels),
+         .format = formatName,
+         .mipLevels = mipLevels,
+         .label = std::string{createInfo.path}});
 
     SDL_FreeSurface(formattedSurface);
 
@@ -85,6 +121,7 @@ GLuint abcg::loadOpenGLTexture(OpenGLTextureCreateInfo const &createInfo) {
 
   glBindTexture(GL_TEXTURE_2D, 0);
 
+  abcg::Metrics::counter("abcg.textures_loaded").add();
   return textureID;
 }
 
@@ -99,10 +136,17 @@ GLuint abcg::loadOpenGLTexture(OpenGLTextureCreateInfo const &createInfo) {
  * @return ID of the texture, as generated by glGenTextures.
  */
 GLuint abcg::loadOpenGLCubemap(OpenGLCubemapCreateInfo const &createInfo) {
+  abcg::HitchDetector::addNote(
+      fmt::format("Cube map loaded: {}", createInfo.paths.front()));
+  abcg::initSDLImage();
+
   GLuint textureID{};
   glGenTextures(1, &textureID);
   glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
 
+  std::uint64_t faceBytes{};
+  std::uint32_t mipLevels{1};
+
   for (auto &&[index, path] : iter::enumerate(createInfo.paths)) {
     // Load the bitmap
     if (SDL_Surface *const surface{IMG_Load(path.data())}) {
@@ -133,6 +177,16 @@ GLuint abcg::loadOpenGLCubemap(OpenGLCubemapCreateInfo const &createInfo) {
       // Create texture
       glTexImage2D(target, 0, GL_RGB, formattedSurface->w, formattedSurface->h,
                    0, GL_RGB, GL_UNSIGNED_BYTE, formattedSurface->pixels);
+      countTextureUpload(*formattedSurface);
+
+      // All faces have the same size
+      auto const width{gsl::narrow<std::uint32_t>(formattedSurface->w)};
+      auto const height{gsl::narrow<std::uint32_t>(formattedSurface->h)};
+      if (createInfo.generateMipmaps) {
+        mipLevels = GpuMemory::getMipLevelCount(width, height);
+      }
+      faceBytes =
+          GpuMemory::getTextureSize(width, height, bytesPerTexel, mipLevels);
 
       SDL_FreeSurface(formattedSurface);
     } else {
@@ -159,5 +213,13 @@ GLuint abcg::loadOpenGLCubemap(OpenGLCubemapCreateInfo const &createInfo) {
                     GL_LINEAR_MIPMAP_LINEAR);
   }
 
+  GpuMemory::track({.kind = GpuResourceKind::Texture,
+                    .handle = textureID,
+                    .bytes = faceBytes * createInfo.paths.size(),
+                    .format = "RGB8",
+                    .mipLevels = mipLevels,
+                    .label = std::string{createInfo.paths.front()}});
+
+  abcg::Metrics::counter("abcg.textures_loaded").add();
   return textureID;
 }
\ No newline at end of file
@@ -0,0 +1,248 @@
+/**
+ * @file abcgOpenGLProgram.cpp
+ * @brief Definition of abcg::OpenGLProgram members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgOpenGLProgram.hpp"
+
+#include <algorithm>
+#include <cppitertools/itertools.hpp>
+
+#include "abcgLog.hpp"
+#include "abcgOpenGLFunction.hpp"
+#include "abcgOpenGLShader.hpp"
+
+namespace {
+// Returns the name of an active variable without the "[0]" suffix of arrays
+std::string_view getBaseName(std::string_view name) noexcept {
+  if (constexpr std::string_view suffix{"[0]"}; name.ends_with(suffix)) {
+    name.remove_suffix(suffix.size());
+  }
+  return name;
+}
+
+GLint getProgramInteger(GLuint program, GLenum name) {
+  GLint value{};
+  abcg::glGetProgramiv(program, name, &value);
+  return value;
+}
+
+template <typename TValue>
+void addVariable(std::unordered_map<std::uint64_t, TValue> &variables,
+                 std::string_view name, TValue value) {
+  auto const hash{abcg::OpenGLName::fromString(getBaseName(name)).hash};
+  if (!variables.emplace(hash, value).second) {
+    abcg::Log::warning("Hash collision of program variable {}", name);
+  }
+}
+} // namespace
+
+/**
+ * @brief Builds the program and enumerates its active variables.
+ *
+ * Any program previously created is destroyed.
+ *
+ * @param pathsOrSources Paths or source codes of the shaders, as in
+ * abcg::createOpenGLProgram.
+ *
+ * @throw abcg::RuntimeError if the program cannot be built.
+ */
+void abcg::OpenGLProgram::create(
+    std::vector<ShaderSource> const &pathsOrSources) {
+  destroy();
+  m_program = createOpenGLProgram(pathsOrSources);
+  reflect();
+}
+
+/**
+ * @brief Deletes the program object and clears the cache of variables.
+ */
+void abcg::OpenGLProgram::destroy() {
+  if (m_program != 0) {
+    abcg::glDeleteProgram(m_program);
+    m_program = 0;
+  }
+  m_uniforms.clear();
+  m_attributes.clear();
+  m_uniformBlocks.clear();
+}
+
+/**
+ * @brief Makes the program current.
+ */
+void abcg::OpenGLProgram::use() const { abcg::glUseProgram(m_program); }
+
+/**
+ * @brief Returns the location of an active uniform.
+ *
+ * @param name Name of the uniform.
+ *
+ * @return Location of the uniform, or -1 if the uniform is not active or is a
+ * member of a uniform block.
+ */
+GLint abcg::OpenGLProgram::getUniformLocation(OpenGLName name) const noexcept {
+  auto const it{m_uniforms.find(name.hash)};
+  return it == m_uniforms.end() ? -1 : it->second.location;
+}
+
+/**
+ * @brief Returns the location of an active vertex attribute.
+ *
+ * @param name Name of the attribute.
+ *
+ * @return Location of the attribute, or -1 if the attribute is not active.
+ */
+GLint abcg::OpenGLProgram::getAttribLocation(OpenGLName name) const noexcept {
+  auto const it{m_attributes.find(name.hash)};
+  return it == m_attributes.end() ? -1 : it->second;
+}
+
+/**
+ * @brief Returns the index of an active uniform block.
+ *
+ * @param name Name of the uniform block.
+ *
+ * @return Index of the uniform block, or `GL_INVALID_INDEX` if the block is
+ * not active.
+ */
+GLuint
+abcg::OpenGLProgram::getUniformBlockIndex(OpenGLName name) const noexcept {
+  auto const it{m_uniformBlocks.find(name.hash)};
+  return it == m_uniformBlocks.end() ? GL_INVALID_INDEX : it->second;
+}
+
+/**
+ * @brief Assigns a binding point to an active uniform block.
+ *
+ * Does nothing if the block is not active.
+ *
+ * @param name Name of the uniform block.
+ * @param binding Uniform buffer binding point.
+ */
+void abcg::OpenGLProgram::setUniformBlockBinding(OpenGLName name,
+                                                 GLuint binding) const {
+  if (auto const index{getUniformBlockIndex(name)}; index != GL_INVALID_INDEX) {
+    abcg::glUniformBlockBinding(m_program, index, binding);
+  }
+}
+
+void abcg::OpenGLProgram::reflect() {
+  std::vector<GLchar> name;
+  // Resizes the name buffer and returns the number of active variables
+  auto const getCount{[&](GLenum countName, GLenum maxLengthName) {
+    name.resize(static_cast<std::size_t>(
+        std::max(getProgramInteger(m_program, maxLengthName), 1)));
+    return static_cast<GLuint>(
+        std::max(getProgramInteger(m_program, countName), 0));
+  }};
+  auto const bufferSize{[&] { return gsl::narrow<GLsizei>(name.size()); }};
+
+  for (auto const index : iter::range(
+           getCount(GL_ACTIVE_UNIFORMS, GL_ACTIVE_UNIFORM_MAX_LENGTH))) {
+    GLsizei length{};
+    GLint size{};
+    GLenum type{};
+    abcg::glGetActiveUniform(m_program, index, bufferSize(), &length, &size,
+                             &type, name.data());
+    // Members of uniform blocks have no location
+    if (auto const location{abcg::glGetUniformLocation(m_program, name.data())};
+        location >= 0) {
+      addVariable(m_uniforms, {name.data(), static_cast<std::size_t>(length)},
+                  Uniform{.location = location});
+    }
+  }
+
+  for (auto const index : iter::range(
+           getCount(GL_ACTIVE_ATTRIBUTES, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH))) {
+    GLsizei length{};
+    GLint size{};
+    GLenum type{};
+    abcg::glGetActiveAttrib(m_program, index, bufferSize(), &length, &size,
+                            &type, name.data());
+    // Built-in attributes, such as gl_VertexID, have no location
+    if (auto const location{abcg::glGetAttribLocation(m_program, name.data())};
+        location >= 0) {
+      addVariable(m_attributes,
+                  {name.data(), static_cast<std::size_t>(length)}, location);
+    }
+  }
+
+  for (auto const index :
+       iter::range(getCount(GL_ACTIVE_UNIFORM_BLOCKS,
+                            GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH))) {
+    GLsizei length{};
+    abcg::glGetActiveUniformBlockName(m_program, index, bufferSize(), &length,
+                                      name.data());
+    addVariable(m_uniformBlocks,
+                {name.data(), static_cast<std::size_t>(length)}, index);
+  }
+}
+
+void abcg::OpenGLProgram::upload(GLint location, bool value) {
+  abcg::glUniform1i(location, value ? 1 : 0);
+}
+
+void abcg::OpenGLProgram::upload(GLint location, GLint value) {
+  abcg::glUniform1i(location, value);
+}
+
+void abcg::OpenGLProgram::upload(GLint location, GLuint value) {
+  abcg::glUniform1ui(location, value);
+}
+
+void abcg::OpenGLProgram::upload(GLint location, float value) {
+  abcg::glUniform1f(location, value);
+}
+
+void abcg::OpenGLProgram::upload(GLint location, glm::vec2 const &value) {
+  abcg::glUniform2fv(location, 1, &value.x);
+}
+
+void abcg::OpenGLProgram::upload(GLint location, glm::vec3 const &value) {
+  abcg::glUniform3fv(location, 1, &value.x);
+}
+
+void abcg::OpenGLProgram::upload(GLint location, glm::vec4 const &value) {
+  abcg::glUniform4fv(location, 1, &value.x);
+}
+
+void abcg::OpenGLProgram::upload(GLint location, glm::ivec2 const &value) {
+  abcg::glUniform2iv(location, 1, &value.x);
+}
+
+void abcg::OpenGLProgram::upload(GLint location, glm::ivec3 const &value) {
+  abcg::glUniform3iv(location, 1, &value.x);
+}
+
+void abcg::OpenGLProgram::upload(GLint location, glm::ivec4 const &value) {
+  abcg::glUniform4iv(location, 1, &value.x);
+}
+
+void abcg::OpenGLProgram::upload(GLint location, glm::uvec2 const &value) {
+  abcg::glUniform2uiv(location, 1, &value.x);
+}
+
+void abcg::OpenGLProgram::upload(GLint location, glm::uvec3 const &value) {
+  abcg::glUniform3uiv(location, 1, &value.x);
+}
+
+void abcg::OpenGLProgram::upload(GLint location, glm::uvec4 const &value) {
+  abcg::glUniform4uiv(location, 1, &value.x);
+}
+
+void abcg::OpenGLProgram::upload(GLint location, glm::mat2 const &value) {
+  abcg::glUniformMatrix2fv(location, 1, GL_FALSE, &value[0][0]);
+}
+
+void abcg::OpenGLProgram::upload(GLint location, glm::mat3 const &value) {
+  abcg::glUniformMatrix3fv(location, 1, GL_FALSE, &value[0][0]);
+}
+
+void abcg::OpenGLProgram::upload(GLint location, glm::mat4 const &value) {
+  abcg::glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]);
+}
@@ -0,0 +1,220 @@
+/**
+ * @file abcgOpenGLProgram.hpp
+ * @brief Header file of abcg::OpenGLProgram.
+ *
+ * Declaration of abcg::OpenGLProgram and abcg::OpenGLName.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_PROGRAM_HPP_
+#define ABCG_OPENGL_PROGRAM_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "abcgExternal.hpp"
+#include "abcgOpenGLCounters.hpp"
+#include "abcgOpenGLExternal.hpp"
+#include "abcgShader.hpp"
+
+namespace abcg {
+class OpenGLProgram;
+struct OpenGLName;
+} // namespace abcg
+
+/**
+ * @brief Hashed name of a uniform, attribute or uniform block of an
+ * abcg::OpenGLProgram.
+ *
+ * Names given as string literals are hashed at compile time, so that looking
+ * up a variable of a program does not involve any string operation:
+ *
+ * @code
+ * program.setUniform("viewMatrix", viewMatrix);
+ * @endcode
+ *
+ * Names only known at runtime are hashed with abcg::OpenGLName::fromString.
+ */
+struct abcg::OpenGLName {
+  /**
+   * @brief Hashes a string literal at compile time.
+   *
+   * @param name Name of the variable, without the `[0]` suffix of arrays.
+   */
+  template <std::size_t N>
+  // NOLINTNEXTLINE(*-avoid-c-arrays,hicpp-explicit-conversions)
+  consteval OpenGLName(char const (&name)[N]) noexcept
+      : hash{computeHash({name, N - 1})} {}
+
+  /**
+   * @brief Hashes a name at runtime.
+   *
+   * @param name Name of the variable, without the `[0]` suffix of arrays.
+   *
+   * @return Hashed name.
+   */
+  [[nodiscard]] static constexpr OpenGLName
+  fromString(std::string_view name) noexcept {
+    return OpenGLName{computeHash(name)};
+  }
+
+  /**
+   * @brief Computes the 64-bit FNV-1a hash of a name.
+   *
+   * @param name Name of the variable.
+   *
+   * @return Hash of the name.
+   */
+  [[nodiscard]] static constexpr std::uint64_t
+  computeHash(std::string_view name) noexcept {
+    std::uint64_t value{0xcbf29ce484222325ULL};
+    for (auto const character : name) {
+      value ^= static_cast<unsigned char>(character);
+      value *= 0x100000001b3ULL;
+    }
+    return value;
+  }
+
+  /** @brief Hash of the name. */
+  std::uint64_t hash{};
+
+private:
+  explicit constexpr OpenGLName(std::uint64_t nameHash) noexcept
+      : hash{nameHash} {}
+};
+
+/**
+ * @brief OpenGL program object with a cache of its active variables.
+ *
+ * When the program is created, its active uniforms, attributes and uniform
+ * blocks are enumerated with `glGetActiveUniform`, `glGetActiveAttrib` and
+ * `glGetActiveUniformBlockName`, and indexed by the hash of their names (see
+ * abcg::OpenGLName). Looking up a variable is then a hash table lookup
+ * instead of a call to `glGetUniformLocation` or `glGetAttribLocation`.
+ *
+ * The typed setters keep a copy of the last value uploaded to each uniform
+ * and skip the upload if the value did not change. Skipped uploads are
+ * counted in abcg::OpenGLFrameCounters::redundantCalls. Setting a uniform
+ * that is not active in the program does nothing, so the same code can drive
+ * programs that use different subsets of the uniforms.
+ *
+ * @code
+ * program.use();
+ * program.setUniform("viewMatrix", m_viewMatrix);
+ * program.setUniform("diffuseTex", 0);
+ * @endcode
+ *
+ * @remark Like `glUniform*`, the setters affect the current program, so the
+ * program must be made current with abcg::OpenGLProgram::use first. Values
+ * uploaded to the program without the setters are not seen by the cache.
+ */
+class abcg::OpenGLProgram {
+public:
+  void create(std::vector<ShaderSource> const &pathsOrSources);
+  void destroy();
+
+  /**
+   * @brief Returns the program object.
+   *
+   * @return Program object, or 0 if the program was not created.
+   */
+  [[nodiscard]] GLuint get() const noexcept { return m_program; }
+
+  void use() const;
+
+  [[nodiscard]] GLint getUniformLocation(OpenGLName name) const noexcept;
+  [[nodiscard]] GLint getAttribLocation(OpenGLName name) const noexcept;
+  [[nodiscard]] GLuint getUniformBlockIndex(OpenGLName name) const noexcept;
+  void setUniformBlockBinding(OpenGLName name, GLuint binding) const;
+
+  /**
+   * @brief Sets the value of a uniform of the program, if it changed.
+   *
+   * @tparam T Type of the value: `bool`, `GLint`, `GLuint`, `float`, or a
+   * `glm` vector or square matrix of these types.
+   *
+   * @param name Name of the uniform.
+   * @param value Value of the uniform.
+   *
+   * @remark The program must be current.
+   */
+  template <typename T> void setUniform(OpenGLName name, T const &value) {
+    static_assert(isUniformType<T>,
+                  "Unsupported uniform type: use bool, GLint, GLuint, float, "
+                  "or a glm vector or square matrix of these types");
+    // Not instantiated for unsupported types, so that the assertion above is
+    // the only diagnostic instead of an ambiguous call to upload
+    if constexpr (isUniformType<T>) {
+      auto const it{m_uniforms.find(name.hash)};
+      if (it == m_uniforms.end())
+        return;
+      auto &uniform{it->second};
+      if (uniform.cached &&
+          std::memcmp(uniform.value.data(), &value, sizeof(T)) == 0) {
+        OpenGLCounters::add(&OpenGLFrameCounters::redundantCalls);
+        return;
+      }
+      std::memcpy(uniform.value.data(), &value, sizeof(T));
+      uniform.cached = true;
+      upload(uniform.location, value);
+    }
+  }
+
+private:
+  // Size of a glm::mat4
+  static constexpr std::size_t maxCachedValueSize{64};
+
+  // Types with an overload of upload
+  template <typename T>
+  static constexpr bool isUniformType{
+      std::is_same_v<T, bool> || std::is_same_v<T, GLint> ||
+      std::is_same_v<T, GLuint> || std::is_same_v<T, float> ||
+      std::is_same_v<T, glm::vec2> || std::is_same_v<T, glm::vec3> ||
+      std::is_same_v<T, glm::vec4> || std::is_same_v<T, glm::ivec2> ||
+      std::is_same_v<T, glm::ivec3> || std::is_same_v<T, glm::ivec4> ||
+      std::is_same_v<T, glm::uvec2> || std::is_same_v<T, glm::uvec3> ||
+      std::is_same_v<T, glm::uvec4> || std::is_same_v<T, glm::mat2> ||
+      std::is_same_v<T, glm::mat3> || std::is_same_v<T, glm::mat4>};
+
+  struct Uniform {
+    GLint location{-1};
+    std::array<std::byte, maxCachedValueSize> value{};
+    bool cached{};
+  };
+
+  void reflect();
+
+  static void upload(GLint location, bool value);
+  static void upload(GLint location, GLint value);
+  static void upload(GLint location, GLuint value);
+  static void upload(GLint location, float value);
+  static void upload(GLint location, glm::vec2 const &value);
+  static void upload(GLint location, glm::vec3 const &value);
+  static void upload(GLint location, glm::vec4 const &value);
+  static void upload(GLint location, glm::ivec2 const &value);
+  static void upload(GLint location, glm::ivec3 const &value);
+  static void upload(GLint location, glm::ivec4 const &value);
+  static void upload(GLint location, glm::uvec2 const &value);
+  static void upload(GLint location, glm::uvec3 const &value);
+  static void upload(GLint location, glm::uvec4 const &value);
+  static void upload(GLint location, glm::mat2 const &value);
+  static void upload(GLint location, glm::mat3 const &value);
+  static void upload(GLint location, glm::mat4 const &value);
+
+  GLuint m_program{};
+  std::unordered_map<std::uint64_t, Uniform> m_uniforms;
+  std::unordered_map<std::uint64_t, GLint> m_attributes;
+  std::unordered_map<std::uint64_t, GLuint> m_uniformBlocks;
+};
+
+#endif
@@ -0,0 +1,440 @@
+/**
+ * @file abcgOpenGLReplayer.cpp
+ * @brief Definition of abcg::OpenGLReplayer members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgOpenGLReplayer.hpp"
+
+#include <algorithm>
+#include <cppitertools/itertools.hpp>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <tuple>
+
+#include "abcgException.hpp"
+#include "abcgExternal.hpp"
+
+namespace {
+using Command = abcg::OpenGLCommand;
+
+constexpr std::array<char, 8> fileMagic{'A', 'B', 'C', 'G', 'G', 'L', 'C',
+                                        '1'};
+
+// Alignment of the payloads in the file
+constexpr std::size_t payloadAlignment{8};
+
+// Kinds of object names, in the order of OpenGLReplayer::m_names. Programs
+// and shaders share the same namespace.
+constexpr std::string_view nameKinds{"btafrpqmx"};
+
+char toLower(char kind) noexcept {
+  return kind >= 'A' && kind <= 'Z' ? static_cast<char>(kind - 'A' + 'a')
+                                    : kind;
+}
+
+std::size_t getNameIndex(char kind) noexcept {
+  auto const lower{toLower(kind)};
+  return nameKinds.find(lower == 's' ? 'p' : lower);
+}
+
+std::size_t toSize(GLsizei value) noexcept {
+  return value > 0 ? static_cast<std::size_t>(value) : 0;
+}
+
+// Reads the contents of a capture file
+class Reader {
+public:
+  Reader(std::span<std::uint8_t const> bytes, std::string const &path)
+      : m_bytes{bytes}, m_path{path} {}
+
+  [[nodiscard]] bool atEnd() const noexcept {
+    return m_position >= m_bytes.size();
+  }
+
+  std::uint64_t readVarint() {
+    std::uint64_t value{};
+    for (auto shift{0U}; shift < 64U; shift += 7U) {
+      if (atEnd())
+        fail();
+      auto const byte{m_bytes[m_position++]};
+      value |= static_cast<std::uint64_t>(byte & 0x7FU) << shift;
+      if ((byte & 0x80U) == 0)
+        return value;
+    }
+    fail();
+  }
+
+  int readInt() {
+    auto const value{readVarint()};
+    if (value > static_cast<std::uint64_t>(std::numeric_limits<int>::max()))
+      fail();
+    return static_cast<int>(value);
+  }
+
+  std::uint8_t const *readBytes(std::size_t size, bool aligned) {
+    if (aligned) {
+      m_position = (m_position + payloadAlignment - 1) / payloadAlignment *
+                   payloadAlignment;
+    }
+    if (m_position > m_bytes.size() || size > m_bytes.size() - m_position)
+      fail();
+    auto const *const bytes{std::next(
+        m_bytes.data(), static_cast<std::ptrdiff_t>(m_position))};
+    m_position += size;
+    return bytes;
+  }
+
+  [[noreturn]] void fail() const {
+    throw abcg::RuntimeError(
+        fmt::format("Truncated OpenGL capture {}", m_path));
+  }
+
+private:
+  std::span<std::uint8_t const> m_bytes;
+  std::string const &m_path;
+  std::size_t m_position{};
+};
+
+// Reads a pointer argument written by OpenGLCapture. Input data is used in
+// place; output data is given a scratch buffer of the recorded size.
+std::uint64_t readPointer(Reader &reader, bool output,
+                          std::deque<std::vector<std::uint64_t>> &outputs) {
+  auto const tag{reader.readVarint()};
+  if (tag == 0) {
+    // Offset into a buffer object
+    return reader.readVarint();
+  }
+  auto const size{gsl::narrow_cast<std::size_t>(tag - 1)};
+  if (output) {
+    auto &scratch{outputs.emplace_back(
+        std::max<std::size_t>((size + sizeof(std::uint64_t) - 1) /
+                                  sizeof(std::uint64_t),
+                              1))};
+    return abcg::encodeOpenGLArgument(scratch.data());
+  }
+  return abcg::encodeOpenGLArgument(reader.readBytes(size, true));
+}
+
+std::uint64_t
+readStrings(Reader &reader,
+            std::deque<std::vector<GLchar const *>> &stringArrays) {
+  auto const count{reader.readVarint()};
+  auto &strings{stringArrays.emplace_back()};
+  for ([[maybe_unused]] auto const index : iter::range(count)) {
+    auto const size{reader.readVarint()};
+    if (size == 0)
+      reader.fail();
+    auto const *const bytes{
+        reader.readBytes(gsl::narrow_cast<std::size_t>(size), false)};
+    strings.push_back(reinterpret_cast<GLchar const *>(bytes));
+  }
+  return abcg::encodeOpenGLArgument(strings.data());
+}
+} // namespace
+
+/**
+ * @brief Loads a capture file.
+ *
+ * @param path Path of a file written by abcg::OpenGLCapture.
+ *
+ * @throw abcg::RuntimeError if the file cannot be read, is not an OpenGL
+ * capture, or is truncated.
+ */
+abcg::OpenGLReplayer::OpenGLReplayer(std::string const &path) : m_path{path} {
+  std::unique_ptr<std::FILE, decltype(&std::fclose)> file{
+      std::fopen(path.c_str(), "rb"), &std::fclose};
+  if (!file || std::fseek(file.get(), 0, SEEK_END) != 0) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to open OpenGL capture {}", path));
+  }
+  auto const fileSize{std::ftell(file.get())};
+  if (fileSize < 0 || std::fseek(file.get(), 0, SEEK_SET) != 0) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to read OpenGL capture {}", path));
+  }
+  auto const size{static_cast<std::size_t>(fileSize)};
+  m_data.resize((size + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t));
+  if (std::fread(m_data.data(), 1, size, file.get()) != size) {
+    throw abcg::RuntimeError(
+        fmt::format("Failed to read OpenGL capture {}", path));
+  }
+  file.reset();
+
+  Reader reader{{reinterpret_cast<std::uint8_t const *>(m_data.data()), size},
+                m_path};
+  if (size < fileMagic.size() ||
+      std::memcmp(reader.readBytes(fileMagic.size(), false),
+                  fileMagic.data(), fileMagic.size()) != 0) {
+    throw abcg::RuntimeError(
+        fmt::format("{} is not an OpenGL capture", path));
+  }
+  m_info.es = reader.readVarint() != 0;
+  m_info.majorVersion = reader.readInt();
+  m_info.minorVersion = reader.readInt();
+  m_info.width = reader.readInt();
+  m_info.height = reader.readInt();
+  m_info.firstFrame = reader.readInt();
+  std::ignore = reader.readInt();
+
+  // The capture may have been stopped before the requested number of frames
+  auto frames{0};
+  while (!reader.atEnd()) {
+    auto const id{reader.readVarint()};
+    if (id >= static_cast<std::uint64_t>(Command::Count)) {
+      throw abcg::RuntimeError(
+          fmt::format("Unknown command {} in OpenGL capture {}", id, path));
+    }
+    auto const command{static_cast<Command>(id)};
+    if (command == Command::Frame) {
+      std::ignore = reader.readVarint();
+      if (frames++ == 0) {
+        m_setupCallCount = m_calls.size();
+      }
+      continue;
+    }
+
+    auto const signature{getOpenGLCommandSignature(command)};
+    Call call{.command = command, .firstArgument = m_arguments.size()};
+    for (auto const kind : signature.substr(1)) {
+      switch (kind) {
+      case '*':
+      case 'c':
+        m_arguments.push_back(readPointer(reader, false, m_outputs));
+        break;
+      case 'o':
+        m_arguments.push_back(readPointer(reader, true, m_outputs));
+        break;
+      case '&':
+        m_arguments.push_back(readStrings(reader, m_stringArrays));
+        break;
+      case 'n':
+        // The strings are null-terminated
+        m_arguments.push_back(0);
+        break;
+      default:
+        m_arguments.push_back(kind >= 'A' && kind <= 'Z'
+                                  ? readPointer(reader, false, m_outputs)
+                                  : reader.readVarint());
+      }
+    }
+    if (signature.front() != '-') {
+      call.result = reader.readVarint();
+    }
+    m_calls.push_back(call);
+  }
+  if (frames == 0) {
+    m_setupCallCount = m_calls.size();
+  }
+  m_info.frames = frames;
+}
+
+/**
+ * @brief Returns the description of the captured context and frames.
+ *
+ * @return Capture description. The number of frames is the number of frames
+ * found in the file.
+ */
+abcg::OpenGLCaptureInfo const &
+abcg::OpenGLReplayer::getInfo() const noexcept {
+  return m_info;
+}
+
+/**
+ * @brief Returns the number of calls made before the first captured frame.
+ *
+ * @return Number of calls replayed by abcg::OpenGLReplayer::replaySetup.
+ */
+std::size_t abcg::OpenGLReplayer::getSetupCallCount() const noexcept {
+  return m_setupCallCount;
+}
+
+/**
+ * @brief Returns the number of calls of the captured frames.
+ *
+ * @return Number of calls replayed by abcg::OpenGLReplayer::replayFrames.
+ */
+std::size_t abcg::OpenGLReplayer::getFrameCallCount() const noexcept {
+  return m_calls.size() - m_setupCallCount;
+}
+
+/**
+ * @brief Replays the calls made before the first captured frame.
+ *
+ * This creates the resources used by the captured frames, and must be called
+ * once, with the replay context current, before
+ * abcg::OpenGLReplayer::replayFrames.
+ */
+void abcg::OpenGLReplayer::replaySetup() {
+  replay(std::span{m_calls}.first(m_setupCallCount));
+}
+
+/**
+ * @brief Replays the captured frames.
+ *
+ * This can be called repeatedly to measure the time of the frames. The
+ * calls are issued without waiting for the GPU to finish them.
+ */
+void abcg::OpenGLReplayer::replayFrames() {
+  replay(std::span{m_calls}.subspan(m_setupCallCount));
+}
+
+void abcg::OpenGLReplayer::replay(std::span<Call const> calls) {
+  for (auto const &call : calls) {
+    replayCall(call);
+  }
+}
+
+void abcg::OpenGLReplayer::replayCall(Call const &call) {
+  if (call.command == OpenGLCommand::UseProgram) {
+    // Uniform locations are translated per program
+    m_program = decodeOpenGLArgument<GLuint>(m_arguments[call.firstArgument]);
+  }
+
+  switch (call.command) {
+#define ABCG_OPENGL_COMMAND_CASE(name, signature)                              \
+  case OpenGLCommand::name:                                                    \
+    invoke(::gl##name, call);                                                  \
+    break;
+    ABCG_OPENGL_COMMANDS(ABCG_OPENGL_COMMAND_CASE)
+    ABCG_OPENGL_DESKTOP_COMMANDS(ABCG_OPENGL_COMMAND_CASE)
+#undef ABCG_OPENGL_COMMAND_CASE
+  default:
+    break;
+  }
+}
+
+template <typename TResult, typename... TArgs>
+void abcg::OpenGLReplayer::invoke(TResult (*function)(TArgs...),
+                                  Call const &call) {
+  // Not supported by the replay context
+  if (function == nullptr)
+    return;
+
+  auto const signature{getOpenGLCommandSignature(call.command)};
+  std::span<std::uint64_t const> const arguments{
+      std::next(m_arguments.data(),
+                static_cast<std::ptrdiff_t>(call.firstArgument)),
+      sizeof...(TArgs)};
+  [&]<std::size_t... Indices>(std::index_sequence<Indices...>) {
+    if constexpr (std::is_void_v<TResult>) {
+      function(
+          getArgument<TArgs>(signature[Indices + 1], arguments, Indices)...);
+    } else {
+      auto const result{function(
+          getArgument<TArgs>(signature[Indices + 1], arguments, Indices)...)};
+      updateResult(signature.front(), arguments, call.result,
+                   encodeOpenGLArgument(result));
+    }
+    (updateArgument<TArgs>(signature[Indices + 1], arguments, Indices), ...);
+  }(std::index_sequence_for<TArgs...>{});
+}
+
+template <typename T>
+T abcg::OpenGLReplayer::getArgument(char kind,
+                                    std::span<std::uint64_t const> arguments,
+                                    std::size_t index) {
+  auto const word{arguments[index]};
+  if constexpr (std::is_same_v<T, GLuint>) {
+    if (getNameIndex(kind) != std::string_view::npos)
+      return translateName(kind, decodeOpenGLArgument<GLuint>(word));
+  } else if constexpr (std::is_same_v<T, GLint>) {
+    if (kind == 'l')
+      return translateLocation(decodeOpenGLArgument<GLint>(word));
+  } else if constexpr (std::is_same_v<T, GLsync>) {
+    if (kind == 'y') {
+      auto const it{m_syncs.find(word)};
+      return it == m_syncs.end() ? nullptr : it->second;
+    }
+  } else if constexpr (std::is_same_v<T, GLuint const *> ||
+                       std::is_same_v<T, GLuint *>) {
+    auto const *const names{decodeOpenGLArgument<GLuint const *>(word)};
+    if (kind >= 'A' && kind <= 'Z' && names != nullptr) {
+      // Each command has at most one array of names
+      m_nameScratch.resize(
+          toSize(decodeOpenGLArgument<GLsizei>(arguments.front())));
+      if constexpr (std::is_const_v<std::remove_pointer_t<T>>) {
+        for (auto const nameIndex : iter::range(m_nameScratch.size())) {
+          m_nameScratch[nameIndex] = translateName(kind, names[nameIndex]);
+        }
+      }
+      return m_nameScratch.data();
+    }
+  }
+  return decodeOpenGLArgument<T>(word);
+}
+
+template <typename T>
+void abcg::OpenGLReplayer::updateArgument(
+    char kind, std::span<std::uint64_t const> arguments, std::size_t index) {
+  if constexpr (std::is_same_v<T, GLuint *>) {
+    // Names created by glGen*
+    auto const *const names{
+        decodeOpenGLArgument<GLuint const *>(arguments[index])};
+    if (kind >= 'A' && kind <= 'Z' && names != nullptr) {
+      for (auto const nameIndex : iter::range(m_nameScratch.size())) {
+        mapName(kind, names[nameIndex], m_nameScratch[nameIndex]);
+      }
+    }
+  }
+}
+
+void abcg::OpenGLReplayer::updateResult(
+    char kind, std::span<std::uint64_t const> arguments,
+    std::uint64_t recorded, std::uint64_t replayed) {
+  switch (kind) {
+  case 'p':
+  case 's':
+    mapName(kind, decodeOpenGLArgument<GLuint>(recorded),
+            decodeOpenGLArgument<GLuint>(replayed));
+    break;
+  case 'l': {
+    auto const program{decodeOpenGLArgument<GLuint>(arguments.front())};
+    auto const location{decodeOpenGLArgument<GLint>(recorded)};
+    if (location >= 0) {
+      m_locations[(std::uint64_t{program} << 32U) |
+                  static_cast<std::uint32_t>(location)] =
+          decodeOpenGLArgument<GLint>(replayed);
+    }
+    break;
+  }
+  case 'y':
+    m_syncs[recorded] = decodeOpenGLArgument<GLsync>(replayed);
+    break;
+  default:
+    break;
+  }
+}
+
+GLuint abcg::OpenGLReplayer::translateName(char kind, GLuint name) const {
+  auto const &names{m_names.at(getNameIndex(kind))};
+  // Names that were not created in the capture, such as 0, are kept
+  if (name >= names.size() || names[name] == 0)
+    return name;
+  return names[name];
+}
+
+GLint abcg::OpenGLReplayer::translateLocation(GLint location) const {
+  if (location < 0)
+    return location;
+  auto const it{m_locations.find((std::uint64_t{m_program} << 32U) |
+                                 static_cast<std::uint32_t>(location))};
+  return it == m_locations.end() ? location : it->second;
+}
+
+void abcg::OpenGLReplayer::mapName(char kind, GLuint recorded,
+                                   GLuint replayed) {
+  if (recorded == 0)
+    return;
+  auto &names{m_names.at(getNameIndex(kind))};
+  if (recorded >= names.size()) {
+    names.resize(std::size_t{recorded} + 1);
+  }
+  names[recorded] = replayed;
+}
@@ -0,0 +1,102 @@
+/**
+ * @file abcgOpenGLReplayer.hpp
+ * @brief Header file of abcg::OpenGLReplayer.
+ *
+ * Declaration of abcg::OpenGLReplayer.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_REPLAYER_HPP_
+#define ABCG_OPENGL_REPLAYER_HPP_
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "abcgOpenGLCapture.hpp"
+
+namespace abcg {
+class OpenGLReplayer;
+} // namespace abcg
+
+/**
+ * @brief Replays a file written by abcg::OpenGLCapture.
+ *
+ * The whole file is decoded when the replayer is created, so that replaying
+ * the calls only costs the OpenGL calls themselves and the translation of
+ * object names. The names of the objects created by the replayed calls may
+ * differ from the recorded ones, so the replayer maps the recorded names of
+ * buffers, textures, vertex arrays, framebuffers, renderbuffers, programs,
+ * shaders, queries, samplers, transform feedbacks, sync objects and uniform
+ * locations to the replayed ones.
+ *
+ * The calls must be replayed in an OpenGL context compatible with the one
+ * described by abcg::OpenGLReplayer::getInfo. The `glreplay` tool creates
+ * such a context and measures the time of the captured frames.
+ *
+ * @remark Attribute locations and uniform block indices are assumed to be
+ * the same as in the captured session.
+ */
+class abcg::OpenGLReplayer {
+public:
+  explicit OpenGLReplayer(std::string const &path);
+
+  [[nodiscard]] OpenGLCaptureInfo const &getInfo() const noexcept;
+  [[nodiscard]] std::size_t getSetupCallCount() const noexcept;
+  [[nodiscard]] std::size_t getFrameCallCount() const noexcept;
+
+  void replaySetup();
+  void replayFrames();
+
+private:
+  struct Call {
+    OpenGLCommand command{};
+    std::size_t firstArgument{};
+    std::uint64_t result{};
+  };
+
+  void replay(std::span<Call const> calls);
+  void replayCall(Call const &call);
+
+  template <typename TResult, typename... TArgs>
+  void invoke(TResult (*function)(TArgs...), Call const &call);
+  template <typename T>
+  T getArgument(char kind, std::span<std::uint64_t const> arguments,
+                std::size_t index);
+  template <typename T>
+  void updateArgument(char kind, std::span<std::uint64_t const> arguments,
+                      std::size_t index);
+  void updateResult(char kind, std::span<std::uint64_t const> arguments,
+                    std::uint64_t recorded, std::uint64_t replayed);
+
+  [[nodiscard]] GLuint translateName(char kind, GLuint name) const;
+  [[nodiscard]] GLint translateLocation(GLint location) const;
+  void mapName(char kind, GLuint recorded, GLuint replayed);
+
+  std::string m_path;
+  OpenGLCaptureInfo m_info{};
+  // File contents, aligned for the payloads used in place
+  std::vector<std::uint64_t> m_data;
+  std::vector<Call> m_calls;
+  std::vector<std::uint64_t> m_arguments;
+  std::size_t m_setupCallCount{};
+  std::deque<std::vector<GLchar const *>> m_stringArrays;
+  std::deque<std::vector<std::uint64_t>> m_outputs;
+
+  std::array<std::vector<GLuint>, 9> m_names;
+  std::unordered_map<std::uint64_t, GLint> m_locations;
+  std::unordered_map<std::uint64_t, GLsync> m_syncs;
+  std::vector<GLuint> m_nameScratch;
+  // Recorded name of the current program
+  GLuint m_program{};
+};
+
+#endif
@@ -21,6 +21,9 @@
 #include <vector>
 
 #include "abcgException.hpp"
+#include "abcgHitchDetector.hpp"
+#include "abcgLog.hpp"
+#include "abcgMetrics.hpp"
 
 namespace {
 void printShaderInfoLog(GLuint const shader, std::string_view prefix) {
@@ -31,8 +34,9 @@ void printShaderInfoLog(GLuint const shader, std::string_view prefix) {
     std::vector<GLchar> infoLog{};
     infoLog.reserve(gsl::narrow<std::size_t>(infoLogLength));
     glGetShaderInfoLog(shader, infoLogLength, nullptr, infoLog.data());
-    fmt::print("Shader information log ({} shader):\n{}\n", prefix,
-               infoLog.data());
+    abcg::Log::error("Shader information log ({} shader):\n{}", prefix,
+                     infoLog.data());
+    abcg::Log::flush();
   }
 }
 
@@ -44,7 +48,8 @@ void printProgramInfoLog(GLuint const program) {
     std::vector<GLchar> infoLog{};
     infoLog.reserve(gsl::narrow<std::size_t>(infoLogLength));
     glGetProgramInfoLog(program, infoLogLength, nullptr, infoLog.data());
-    fmt::print("Program information log:\n{}\n", infoLog.data());
+    abcg::Log::error("Program information log:\n{}", infoLog.data());
+    abcg::Log::flush();
   }
 }
 
@@ -171,6 +176,9 @@ void deleteShaders(std::vector<abcg::OpenGLShader> const &shaderIDs) {
 GLuint
 abcg::createOpenGLProgram(std::vector<ShaderSource> const &pathsOrSources,
                           bool throwOnError) {
+  abcg::HitchDetector::addNote(fmt::format(
+      "Shader program compiled ({} stages)", pathsOrSources.size()));
+
   std::vector<ShaderSource> sources;
   sources.reserve(pathsOrSources.size());
   for (auto const &pathOrSource : pathsOrSources) {
@@ -212,7 +220,6 @@ abcg::createOpenGLProgram(std::vector<ShaderSource> const &pathsOrSources,
   glGetProgramiv(shaderProgram, GL_LINK_STATUS, &linkStatus);
   if (linkStatus == GL_FALSE) {
     if (throwOnError) {
-      fmt::print("\n");
       printProgramInfoLog(shaderProgram);
       glDeleteProgram(shaderProgram);
       throw abcg::RuntimeError("Failed to link program");
@@ -221,6 +228,7 @@ abcg::createOpenGLProgram(std::vector<ShaderSource> const &pathsOrSources,
     return 0U;
   }
 
+  abcg::Metrics::counter("abcg.programs_linked").add();
   return shaderProgram;
 }
 
@@ -249,6 +257,9 @@ abcg::createOpenGLProgram(std::vector<ShaderSource> const &pathsOrSources,
  */
 std::vector<abcg::OpenGLShader> abcg::triggerOpenGLShaderCompile(
     std::vector<ShaderSource> const &pathsOrSources) {
+  abcg::HitchDetector::addNote(fmt::format(
+      "Shader compilation triggered ({} stages)", pathsOrSources.size()));
+
   std::vector<ShaderSource> sources;
   sources.reserve(pathsOrSources.size());
   for (auto const &pathOrSource : pathsOrSources) {
@@ -289,7 +300,6 @@ bool abcg::checkOpenGLShaderCompile(std::vector<OpenGLShader> const &shaders,
     glGetShaderiv(shader.shader, GL_COMPILE_STATUS, &compileStatus);
     if (compileStatus == GL_FALSE) {
       if (throwOnError) {
-        fmt::print("\n");
         auto const *shaderStage{shaderStageToText(shader.stage)};
         printShaderInfoLog(shader.shader, shaderStage);
         deleteShaders(shaders);
@@ -363,7 +373,6 @@ bool abcg::checkOpenGLShaderLink(GLuint shaderProgram, bool throwOnError) {
   glGetProgramiv(shaderProgram, GL_LINK_STATUS, &linkStatus);
   if (linkStatus == GL_FALSE) {
     if (throwOnError) {
-      fmt::print("\n");
       printProgramInfoLog(shaderProgram);
       glDeleteProgram(shaderProgram);
       throw abcg::RuntimeError("Failed to link program");
@@ -372,5 +381,6 @@ bool abcg::checkOpenGLShaderLink(GLuint shaderProgram, bool throwOnError) {
     return false;
   }
 
+  abcg::Metrics::counter("abcg.programs_linked").add();
   return true;
 }
\ No newline at end of file
@@ -0,0 +1,162 @@
+/**
+ * @file abcgOpenGLStateCache.cpp
+ * @brief Definition of abcg::OpenGLStateCache members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgOpenGLStateCache.hpp"
+
+#include <algorithm>
+#include <span>
+
+namespace {
+template <typename T, std::size_t N>
+constexpr std::array<T, N> makeFilled(T value) noexcept {
+  std::array<T, N> array{};
+  array.fill(value);
+  return array;
+}
+
+// Returns the names of a glDelete* call, or an empty span if there are none
+std::span<GLuint const> getNames(GLsizei n, GLuint const *names) noexcept {
+  if (n <= 0 || names == nullptr)
+    return {};
+  return {names, static_cast<std::size_t>(n)};
+}
+
+bool contains(std::span<GLuint const> names, GLuint name) noexcept {
+  return std::find(names.begin(), names.end(), name) != names.end();
+}
+} // namespace
+
+bool abcg::OpenGLStateCache::m_enabled{true};
+GLuint abcg::OpenGLStateCache::m_program{unknownName};
+GLuint abcg::OpenGLStateCache::m_vertexArray{unknownName};
+std::array<GLuint, 7> abcg::OpenGLStateCache::m_buffers{
+    makeFilled<GLuint, 7>(unknownName)};
+GLenum abcg::OpenGLStateCache::m_activeTexture{unknownEnum};
+std::array<std::array<GLuint, abcg::OpenGLStateCache::textureTargetCount>, 32>
+    abcg::OpenGLStateCache::m_textures{
+        makeFilled<std::array<GLuint, textureTargetCount>, 32>(
+            makeFilled<GLuint, textureTargetCount>(unknownName))};
+std::array<GLenum, 11> abcg::OpenGLStateCache::m_capabilities{
+    makeFilled<GLenum, 11>(unknownEnum)};
+GLenum abcg::OpenGLStateCache::m_blendSource{unknownEnum};
+GLenum abcg::OpenGLStateCache::m_blendDestination{unknownEnum};
+std::array<GLint, 4> abcg::OpenGLStateCache::m_viewport{};
+bool abcg::OpenGLStateCache::m_viewportKnown{};
+
+/**
+ * @brief Enables or disables the cache.
+ *
+ * When disabled, all calls are issued. The cached state is invalidated in
+ * both cases.
+ *
+ * @param enabled Whether the cache is enabled.
+ */
+void abcg::OpenGLStateCache::setEnabled(bool enabled) noexcept {
+  m_enabled = enabled;
+  invalidate();
+}
+
+/**
+ * @brief Returns whether the cache is enabled.
+ *
+ * @return True if redundant calls are skipped.
+ */
+bool abcg::OpenGLStateCache::isEnabled() noexcept { return m_enabled; }
+
+/**
+ * @brief Forgets the cached state.
+ *
+ * The next call to each cached function is issued regardless of its
+ * arguments.
+ *
+ * @remark This must be called after the OpenGL state is changed without
+ * using the `abcg::gl*` wrappers, and when a new context is made current.
+ */
+void abcg::OpenGLStateCache::invalidate() noexcept {
+  m_program = unknownName;
+  m_vertexArray = unknownName;
+  m_buffers.fill(unknownName);
+  m_activeTexture = unknownEnum;
+  for (auto &unit : m_textures) {
+    unit.fill(unknownName);
+  }
+  m_capabilities.fill(unknownEnum);
+  invalidateBlendFunc();
+  m_viewportKnown = false;
+}
+
+/**
+ * @brief Updates the cache after a call to glDeleteProgram.
+ *
+ * A program that is in use is only deleted when it is no longer current, so
+ * its binding is forgotten rather than reset to 0.
+ *
+ * @param program Deleted program object.
+ */
+void abcg::OpenGLStateCache::onProgramDeleted(GLuint program) noexcept {
+  if (program != 0 && m_program == program) {
+    m_program = unknownName;
+  }
+}
+
+/**
+ * @brief Updates the cache after a call to glDeleteVertexArrays.
+ *
+ * Deleting the bound vertex array object reverts the binding to 0.
+ *
+ * @param n Number of vertex array objects.
+ * @param arrays Deleted vertex array objects.
+ */
+void abcg::OpenGLStateCache::onVertexArraysDeleted(
+    GLsizei n, GLuint const *arrays) noexcept {
+  if (m_vertexArray != 0 && contains(getNames(n, arrays), m_vertexArray)) {
+    m_vertexArray = 0;
+    m_buffers.at(elementArrayBufferIndex) = unknownName;
+  }
+}
+
+/**
+ * @brief Updates the cache after a call to glDeleteBuffers.
+ *
+ * Deleting a bound buffer object reverts its bindings to 0.
+ *
+ * @param n Number of buffer objects.
+ * @param buffers Deleted buffer objects.
+ */
+void abcg::OpenGLStateCache::onBuffersDeleted(GLsizei n,
+                                              GLuint const *buffers) noexcept {
+  auto const names{getNames(n, buffers)};
+  for (auto &binding : m_buffers) {
+    if (binding != 0 && contains(names, binding)) {
+      binding = 0;
+    }
+  }
+}
+
+/**
+ * @brief Updates the cache after a call to glDeleteTextures.
+ *
+ * Deleting a bound texture object reverts its bindings to 0 in all texture
+ * units.
+ *
+ * @param n Number of texture objects.
+ * @param textures Deleted texture objects.
+ */
+void abcg::OpenGLStateCache::onTexturesDeleted(
+    GLsizei n, GLuint const *textures) noexcept {
+  auto const names{getNames(n, textures)};
+  for (auto &unit : m_textures) {
+    for (auto &binding : unit) {
+      if (binding != 0 && contains(names, binding)) {
+        binding = 0;
+      }
+    }
+  }
+}
@@ -0,0 +1,338 @@
+/**
+ * @file abcgOpenGLStateCache.hpp
+ * @brief Header file of abcg::OpenGLStateCache.
+ *
+ * Declaration of abcg::OpenGLStateCache.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_STATE_CACHE_HPP_
+#define ABCG_OPENGL_STATE_CACHE_HPP_
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <optional>
+
+#include "abcgOpenGLCounters.hpp"
+#include "abcgOpenGLExternal.hpp"
+
+namespace abcg {
+class OpenGLStateCache;
+} // namespace abcg
+
+/**
+ * @brief Shadows part of the OpenGL state to skip redundant state changes.
+ *
+ * The following `abcg::gl*` wrappers do not call OpenGL if the call would
+ * not change the current state:
+ *
+ * - `abcg::glUseProgram`;
+ * - `abcg::glBindVertexArray`;
+ * - `abcg::glBindBuffer`;
+ * - `abcg::glActiveTexture` and `abcg::glBindTexture` (2D, cube map, 3D and
+ *   2D array targets of the first 32 texture units);
+ * - `abcg::glEnable` and `abcg::glDisable` for the capabilities of OpenGL ES
+ *   3.0;
+ * - `abcg::glBlendFunc`;
+ * - `abcg::glViewport`.
+ *
+ * Skipped calls are counted in abcg::OpenGLFrameCounters::redundantCalls.
+ *
+ * The cache only sees the calls made through the wrappers. Code that changes
+ * the same state with the raw OpenGL functions, or through libraries such as
+ * the OpenGL backend of Dear ImGui, must call
+ * abcg::OpenGLStateCache::invalidate afterwards. abcg::OpenGLWindow does so
+ * after rendering the UI.
+ *
+ * @remark The cache is not synchronized. It must be used from the thread that
+ * owns the OpenGL context.
+ */
+class abcg::OpenGLStateCache {
+public:
+  OpenGLStateCache() = delete;
+
+  static void setEnabled(bool enabled) noexcept;
+  [[nodiscard]] static bool isEnabled() noexcept;
+  static void invalidate() noexcept;
+
+  /**
+   * @brief Records a call to glUseProgram.
+   *
+   * @param program Program object.
+   *
+   * @return Whether the call changes the state and must be issued.
+   */
+  [[nodiscard]] static bool useProgram(GLuint program) noexcept {
+    return update(m_program, program);
+  }
+
+  /**
+   * @brief Records a call to glBindVertexArray.
+   *
+   * @param array Vertex array object.
+   *
+   * @return Whether the call changes the state and must be issued.
+   */
+  [[nodiscard]] static bool bindVertexArray(GLuint array) noexcept {
+    if (!update(m_vertexArray, array))
+      return false;
+    // The element array buffer binding is part of the vertex array state
+    m_buffers.at(elementArrayBufferIndex) = unknownName;
+    return true;
+  }
+
+  /**
+   * @brief Records a call to glBindBuffer.
+   *
+   * @param target Buffer binding target.
+   * @param buffer Buffer object.
+   *
+   * @return Whether the call changes the state and must be issued.
+   */
+  [[nodiscard]] static bool bindBuffer(GLenum target, GLuint buffer) noexcept {
+    auto const index{getBufferIndex(target)};
+    if (index >= m_buffers.size())
+      return true;
+    return update(m_buffers.at(index), buffer);
+  }
+
+  /**
+   * @brief Records a call to glActiveTexture.
+   *
+   * @param texture Texture unit.
+   *
+   * @return Whether the call changes the state and must be issued.
+   */
+  [[nodiscard]] static bool activeTexture(GLenum texture) noexcept {
+    return update(m_activeTexture, texture);
+  }
+
+  /**
+   * @brief Records a call to glBindTexture.
+   *
+   * @param target Texture target.
+   * @param texture Texture object.
+   *
+   * @return Whether the call changes the state and must be issued.
+   */
+  [[nodiscard]] static bool bindTexture(GLenum target,
+                                        GLuint texture) noexcept {
+    auto const targetIndex{getTextureTargetIndex(target)};
+    // Bindings of unknown units or targets are not cached
+    auto const unit{m_activeTexture - GL_TEXTURE0};
+    if (targetIndex >= textureTargetCount || unit >= m_textures.size())
+      return true;
+    return update(m_textures.at(unit).at(targetIndex), texture);
+  }
+
+  /**
+   * @brief Records a call to glEnable or glDisable.
+   *
+   * @param cap Capability.
+   * @param enabled True for glEnable, false for glDisable.
+   *
+   * @return Whether the call changes the state and must be issued.
+   */
+  [[nodiscard]] static bool setCapability(GLenum cap, bool enabled) noexcept {
+    auto const index{getCapabilityIndex(cap)};
+    if (index >= m_capabilities.size())
+      return true;
+    return update(m_capabilities.at(index),
+                  enabled ? GLenum{GL_TRUE} : GLenum{GL_FALSE});
+  }
+
+  /**
+   * @brief Records a call to glBlendFunc.
+   *
+   * @param sfactor Source factor.
+   * @param dfactor Destination factor.
+   *
+   * @return Whether the call changes the state and must be issued.
+   */
+  [[nodiscard]] static bool blendFunc(GLenum sfactor, GLenum dfactor) noexcept {
+    // Evaluate both, as both must be recorded
+    auto const sourceChanged{update(m_blendSource, sfactor, false)};
+    auto const destinationChanged{update(m_blendDestination, dfactor, false)};
+    return countRedundant(sourceChanged || destinationChanged);
+  }
+
+  /**
+   * @brief Records a call to glViewport.
+   *
+   * @param x Lower left corner x.
+   * @param y Lower left corner y.
+   * @param width Width.
+   * @param height Height.
+   *
+   * @return Whether the call changes the state and must be issued.
+   */
+  [[nodiscard]] static bool viewport(GLint x, GLint y, GLsizei width,
+                                     GLsizei height) noexcept {
+    std::array const viewport{x, y, width, height};
+    if (!m_enabled || !m_viewportKnown || viewport != m_viewport) {
+      m_viewport = viewport;
+      m_viewportKnown = m_enabled;
+      return true;
+    }
+    return countRedundant(false);
+  }
+
+  /**
+   * @brief Forgets the blend factors after a call that changes them without
+   * going through abcg::OpenGLStateCache::blendFunc, such as
+   * glBlendFuncSeparate.
+   */
+  static void invalidateBlendFunc() noexcept {
+    m_blendSource = unknownEnum;
+    m_blendDestination = unknownEnum;
+  }
+
+  /**
+   * @brief Forgets the generic binding of a buffer target after a call to
+   * glBindBufferBase or glBindBufferRange.
+   *
+   * @param target Buffer binding target.
+   */
+  static void invalidateBuffer(GLenum target) noexcept {
+    if (auto const index{getBufferIndex(target)}; index < m_buffers.size()) {
+      m_buffers.at(index) = unknownName;
+    }
+  }
+
+  /**
+   * @brief Returns the buffer object bound to a target, if it is known.
+   *
+   * @param target Buffer binding target.
+   *
+   * @return Buffer object, or `std::nullopt` if the cache is disabled or the
+   * binding is not known.
+   */
+  [[nodiscard]] static std::optional<GLuint>
+  getBoundBuffer(GLenum target) noexcept {
+    auto const index{getBufferIndex(target)};
+    if (!m_enabled || index >= m_buffers.size() ||
+        m_buffers.at(index) == unknownName)
+      return std::nullopt;
+    return m_buffers.at(index);
+  }
+
+  static void onProgramDeleted(GLuint program) noexcept;
+  static void onVertexArraysDeleted(GLsizei n, GLuint const *arrays) noexcept;
+  static void onBuffersDeleted(GLsizei n, GLuint const *buffers) noexcept;
+  static void onTexturesDeleted(GLsizei n, GLuint const *textures) noexcept;
+
+private:
+  // Value of a binding that is not known
+  static constexpr GLuint unknownName{std::numeric_limits<GLuint>::max()};
+  // Value of an enum, or of a capability, that is not known
+  static constexpr GLenum unknownEnum{std::numeric_limits<GLenum>::max()};
+
+  static constexpr std::size_t elementArrayBufferIndex{1};
+  static constexpr std::size_t textureTargetCount{4};
+
+  [[nodiscard]] static constexpr std::size_t
+  getBufferIndex(GLenum target) noexcept {
+    switch (target) {
+    case GL_ARRAY_BUFFER:
+      return 0;
+    case GL_ELEMENT_ARRAY_BUFFER:
+      return elementArrayBufferIndex;
+    case GL_UNIFORM_BUFFER:
+      return 2;
+    case GL_COPY_READ_BUFFER:
+      return 3;
+    case GL_COPY_WRITE_BUFFER:
+      return 4;
+    case GL_PIXEL_PACK_BUFFER:
+      return 5;
+    case GL_PIXEL_UNPACK_BUFFER:
+      return 6;
+    default:
+      return std::numeric_limits<std::size_t>::max();
+    }
+  }
+
+  [[nodiscard]] static constexpr std::size_t
+  getTextureTargetIndex(GLenum target) noexcept {
+    switch (target) {
+    case GL_TEXTURE_2D:
+      return 0;
+    case GL_TEXTURE_CUBE_MAP:
+      return 1;
+    case GL_TEXTURE_3D:
+      return 2;
+    case GL_TEXTURE_2D_ARRAY:
+      return 3;
+    default:
+      return textureTargetCount;
+    }
+  }
+
+  [[nodiscard]] static constexpr std::size_t
+  getCapabilityIndex(GLenum cap) noexcept {
+    switch (cap) {
+    case GL_BLEND:
+      return 0;
+    case GL_CULL_FACE:
+      return 1;
+    case GL_DEPTH_TEST:
+      return 2;
+    case GL_DITHER:
+      return 3;
+    case GL_POLYGON_OFFSET_FILL:
+      return 4;
+    case GL_PRIMITIVE_RESTART_FIXED_INDEX:
+      return 5;
+    case GL_RASTERIZER_DISCARD:
+      return 6;
+    case GL_SAMPLE_ALPHA_TO_COVERAGE:
+      return 7;
+    case GL_SAMPLE_COVERAGE:
+      return 8;
+    case GL_SCISSOR_TEST:
+      return 9;
+    case GL_STENCIL_TEST:
+      return 10;
+    default:
+      return std::numeric_limits<std::size_t>::max();
+    }
+  }
+
+  // Counts a skipped call
+  static bool countRedundant(bool changed) noexcept {
+    if (!changed) {
+      OpenGLCounters::add(&OpenGLFrameCounters::redundantCalls);
+    }
+    return changed;
+  }
+
+  // Records a new value and returns whether it differs from the cached one
+  template <typename T>
+  static bool update(T &cached, T value, bool count = true) noexcept {
+    if (!m_enabled)
+      return true;
+    if (cached == value)
+      return count ? countRedundant(false) : false;
+    cached = value;
+    return true;
+  }
+
+  static bool m_enabled;
+  static GLuint m_program;
+  static GLuint m_vertexArray;
+  static std::array<GLuint, 7> m_buffers;
+  static GLenum m_activeTexture;
+  static std::array<std::array<GLuint, textureTargetCount>, 32> m_textures;
+  static std::array<GLenum, 11> m_capabilities;
+  static GLenum m_blendSource;
+  static GLenum m_blendDestination;
+  static std::array<GLint, 4> m_viewport;
+  static bool m_viewportKnown;
+};
+
+#endif
@@ -0,0 +1,279 @@
+/**
+ * @file abcgOpenGLValidation.cpp
+ * @brief Definition of abcg::OpenGLValidation members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgOpenGLValidation.hpp"
+
+#include <algorithm>
+#include <fmt/core.h>
+#include <string_view>
+
+#include "abcgLog.hpp"
+#include "abcgOpenGLExternal.hpp"
+
+namespace {
+struct ValidationState {
+#if defined(NDEBUG)
+  abcg::OpenGLValidationLevel level{abcg::OpenGLValidationLevel::Off};
+#else
+  abcg::OpenGLValidationLevel level{abcg::OpenGLValidationLevel::DebugOutput};
+#endif
+  abcg::OpenGLValidationLevel effectiveLevel{abcg::OpenGLValidationLevel::Off};
+  int sampleInterval{60};
+  std::uint64_t frameIndex{};
+  bool hasContext{};
+  bool noErrorContext{};
+  bool debugOutputSupported{};
+};
+
+// Only accessed from the thread that owns the OpenGL context
+ValidationState &state() {
+  static ValidationState instance;
+  return instance;
+}
+
+std::string_view getLevelName(abcg::OpenGLValidationLevel level) {
+  switch (level) {
+  case abcg::OpenGLValidationLevel::Off:
+    return "Off";
+  case abcg::OpenGLValidationLevel::DebugOutput:
+    return "DebugOutput";
+  case abcg::OpenGLValidationLevel::SampledFrames:
+    return "SampledFrames";
+  case abcg::OpenGLValidationLevel::Full:
+    return "Full";
+  }
+  return "Unknown";
+}
+
+#if !defined(__EMSCRIPTEN__)
+std::string_view getDebugTypeName(GLenum type) {
+  switch (type) {
+  case GL_DEBUG_TYPE_ERROR:
+    return "error";
+  case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:
+    return "deprecated behavior";
+  case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:
+    return "undefined behavior";
+  case GL_DEBUG_TYPE_PORTABILITY:
+    return "portability";
+  case GL_DEBUG_TYPE_PERFORMANCE:
+    return "performance";
+  default:
+    return "message";
+  }
+}
+
+void GLAPIENTRY onDebugMessage(GLenum /*source*/, GLenum type, GLuint id,
+                               GLenum severity, GLsizei length,
+                               GLchar const *message,
+                               void const * /*userParam*/) {
+  auto const text{length < 0 ? std::string_view{message}
+                             : std::string_view{message,
+                                                static_cast<std::size_t>(
+                                                    length)}};
+  auto const lastCall{abcg::OpenGLValidation::describeLastCall()};
+  auto const description{
+      fmt::format("OpenGL {} {}: {}{}", getDebugTypeName(type), id, text,
+                  lastCall.empty() ? "" : fmt::format(" (near {})", lastCall))};
+
+  switch (severity) {
+  case GL_DEBUG_SEVERITY_HIGH:
+    abcg::Log::error("{}", description);
+    break;
+  case GL_DEBUG_SEVERITY_MEDIUM:
+    abcg::Log::warning("{}", description);
+    break;
+  default:
+    abcg::Log::info("{}", description);
+  }
+}
+#endif
+
+// Selects the effective level and enables or disables the debug output
+// accordingly
+void apply() {
+  auto &validation{state()};
+
+  auto level{validation.level};
+  if (validation.noErrorContext) {
+    // Errors are undefined behavior in a KHR_no_error context
+    level = abcg::OpenGLValidationLevel::Off;
+  } else if (level == abcg::OpenGLValidationLevel::DebugOutput &&
+             !validation.debugOutputSupported) {
+    level = abcg::OpenGLValidationLevel::SampledFrames;
+  }
+  validation.effectiveLevel = level;
+  validation.frameIndex = 0;
+
+#if !defined(__EMSCRIPTEN__)
+  if (validation.debugOutputSupported) {
+    if (level == abcg::OpenGLValidationLevel::DebugOutput ||
+        level == abcg::OpenGLValidationLevel::Full) {
+      ::glEnable(GL_DEBUG_OUTPUT);
+      if (level == abcg::OpenGLValidationLevel::Full) {
+        // The callback is called before the offending function returns
+        ::glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+      } else {
+        ::glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+      }
+      ::glDebugMessageCallback(onDebugMessage, nullptr);
+      // Ignore notifications, such as buffer placement hints
+      ::glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE,
+                              GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr,
+                              GL_FALSE);
+    } else {
+      ::glDisable(GL_DEBUG_OUTPUT);
+    }
+  }
+#endif
+}
+} // namespace
+
+/**
+ * @brief Sets the validation level.
+ *
+ * The level can be changed at any time. If an OpenGL context exists, the
+ * debug output is enabled or disabled immediately.
+ *
+ * @param level Validation level.
+ */
+void abcg::OpenGLValidation::setLevel(OpenGLValidationLevel level) {
+  auto &validation{state()};
+  validation.level = level;
+  if (validation.hasContext) {
+    apply();
+    m_checkingErrors = validation.effectiveLevel == OpenGLValidationLevel::Full;
+  }
+}
+
+/**
+ * @brief Returns the validation level set with
+ * abcg::OpenGLValidation::setLevel.
+ *
+ * @return Validation level.
+ */
+abcg::OpenGLValidationLevel abcg::OpenGLValidation::getLevel() noexcept {
+  return state().level;
+}
+
+/**
+ * @brief Returns the validation level in use.
+ *
+ * The level in use differs from the level that was set if `KHR_debug` is
+ * not supported, or if the context was created with `KHR_no_error`.
+ *
+ * @return Validation level in use, or abcg::OpenGLValidationLevel::Off if
+ * there is no OpenGL context.
+ */
+abcg::OpenGLValidationLevel
+abcg::OpenGLValidation::getEffectiveLevel() noexcept {
+  return state().effectiveLevel;
+}
+
+/**
+ * @brief Sets the interval of the frames checked with
+ * abcg::OpenGLValidationLevel::SampledFrames.
+ *
+ * @param frames Number of frames between checked frames. Values less than 1
+ * are clamped to 1.
+ */
+void abcg::OpenGLValidation::setSampleInterval(int frames) noexcept {
+  state().sampleInterval = std::max(frames, 1);
+}
+
+/**
+ * @brief Returns the interval of the frames checked with
+ * abcg::OpenGLValidationLevel::SampledFrames.
+ *
+ * @return Number of frames between checked frames.
+ */
+int abcg::OpenGLValidation::getSampleInterval() noexcept {
+  return state().sampleInterval;
+}
+
+/**
+ * @brief Applies the validation level to a new OpenGL context.
+ *
+ * @param noErrorContext Whether the context was created with `KHR_no_error`.
+ * If so, validation is disabled.
+ *
+ * @remark This is called by abcg::OpenGLWindow after the OpenGL functions
+ * are loaded.
+ */
+void abcg::OpenGLValidation::onContextCreated(bool noErrorContext) {
+  auto &validation{state()};
+  validation.hasContext = true;
+  validation.noErrorContext = noErrorContext;
+#if defined(__EMSCRIPTEN__)
+  validation.debugOutputSupported = false;
+#else
+  validation.debugOutputSupported = GLEW_KHR_debug != GL_FALSE;
+#endif
+  apply();
+  m_checkingErrors = validation.effectiveLevel == OpenGLValidationLevel::Full;
+
+  if (validation.effectiveLevel != validation.level) {
+    abcg::Log::info("OpenGL validation level {} not available, using {}",
+                    getLevelName(validation.level),
+                    getLevelName(validation.effectiveLevel));
+  }
+}
+
+/**
+ * @brief Disables validation when the OpenGL context is destroyed.
+ *
+ * @remark This is called by abcg::OpenGLWindow.
+ */
+void abcg::OpenGLValidation::onContextDestroyed() noexcept {
+  auto &validation{state()};
+  validation.hasContext = false;
+  validation.effectiveLevel = OpenGLValidationLevel::Off;
+  m_checkingErrors = false;
+}
+
+/**
+ * @brief Starts a new frame.
+ *
+ * With abcg::OpenGLValidationLevel::SampledFrames, selects whether
+ * `glGetError` is checked in this frame.
+ *
+ * @remark This is called by abcg::OpenGLWindow at the beginning of each
+ * frame.
+ */
+void abcg::OpenGLValidation::newFrame() noexcept {
+  auto &validation{state()};
+  if (validation.effectiveLevel != OpenGLValidationLevel::SampledFrames)
+    return;
+
+  auto const interval{static_cast<std::uint64_t>(validation.sampleInterval)};
+  m_checkingErrors = validation.frameIndex % interval == 0;
+  ++validation.frameIndex;
+}
+
+/**
+ * @brief Returns the source location of the most recent call made through
+ * the `abcg::gl*` wrappers.
+ *
+ * As the debug output is asynchronous unless the level is
+ * abcg::OpenGLValidationLevel::Full, the call that caused a message may be
+ * an earlier one.
+ *
+ * @return Location formatted as "file:line (function)", or an empty string
+ * if no location was recorded.
+ */
+std::string abcg::OpenGLValidation::describeLastCall() {
+  auto const *const file{m_lastFile.load(std::memory_order_relaxed)};
+  if (file == nullptr)
+    return {};
+  auto const *const function{m_lastFunction.load(std::memory_order_relaxed)};
+  return fmt::format("{}:{} ({})", file,
+                     m_lastLine.load(std::memory_order_relaxed),
+                     function == nullptr ? "" : function);
+}
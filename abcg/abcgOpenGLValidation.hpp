@@ -0,0 +1,125 @@
+/**
+ * @file abcgOpenGLValidation.hpp
+ * @brief Header file of abcg::OpenGLValidation.
+ *
+ * Declaration of abcg::OpenGLValidation and abcg::OpenGLValidationLevel.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_VALIDATION_HPP_
+#define ABCG_OPENGL_VALIDATION_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace abcg {
+enum class OpenGLValidationLevel;
+class OpenGLValidation;
+} // namespace abcg
+
+/**
+ * @brief Enumeration of the levels of validation of OpenGL calls.
+ *
+ * @sa abcg::OpenGLValidation.
+ */
+enum class abcg::OpenGLValidationLevel {
+  /** @brief No validation. */
+  Off,
+  /** @brief Messages of the `KHR_debug` debug output are logged
+   * asynchronously, together with the source location of the most recent
+   * call made through the `abcg::gl*` wrappers.
+   *
+   * Falls back to `SampledFrames` if `KHR_debug` is not supported.
+   */
+  DebugOutput,
+  /** @brief `glGetError` is checked before and after each call made through
+   * the `abcg::gl*` wrappers, but only in one of every
+   * abcg::OpenGLValidation::getSampleInterval frames. */
+  SampledFrames,
+  /** @brief `glGetError` is checked before and after each call made through
+   * the `abcg::gl*` wrappers, and the `KHR_debug` debug output, if supported,
+   * is synchronous. */
+  Full
+};
+
+/**
+ * @brief Controls the validation of OpenGL calls at runtime.
+ *
+ * In debug builds, the `abcg::gl*` wrappers can check `glGetError` before
+ * and after each call and throw abcg::OpenGLError on the first error. As
+ * `glGetError` forces the driver to synchronize, checking every call makes
+ * debug builds much slower than release builds. The validation level
+ * selects a cheaper alternative:
+ *
+ * - abcg::OpenGLValidationLevel::DebugOutput, the default in debug builds,
+ *   leaves the error checking to the driver, which reports errors and
+ *   warnings through the `KHR_debug` callback without stalling;
+ * - abcg::OpenGLValidationLevel::SampledFrames checks `glGetError` only in
+ *   some frames;
+ * - abcg::OpenGLValidationLevel::Full checks every call, as in previous
+ *   versions of ABCg.
+ *
+ * The initial level is given by abcg::OpenGLSettings::validation, and can be
+ * changed at any time with abcg::OpenGLValidation::setLevel.
+ *
+ * @remark `glGetError` is never checked in release builds, on WebAssembly
+ * and on macOS, where the wrappers do not capture source locations.
+ */
+class abcg::OpenGLValidation {
+public:
+  OpenGLValidation() = delete;
+
+  static void setLevel(OpenGLValidationLevel level);
+  [[nodiscard]] static OpenGLValidationLevel getLevel() noexcept;
+  [[nodiscard]] static OpenGLValidationLevel getEffectiveLevel() noexcept;
+  static void setSampleInterval(int frames) noexcept;
+  [[nodiscard]] static int getSampleInterval() noexcept;
+
+  static void onContextCreated(bool noErrorContext);
+  static void onContextDestroyed() noexcept;
+  static void newFrame() noexcept;
+
+  /**
+   * @brief Returns whether the wrappers must check `glGetError` in the
+   * current frame.
+   *
+   * @return True if the effective level is
+   * abcg::OpenGLValidationLevel::Full, or
+   * abcg::OpenGLValidationLevel::SampledFrames and the current frame is
+   * sampled.
+   */
+  [[nodiscard]] static bool isCheckingErrors() noexcept {
+    return m_checkingErrors;
+  }
+
+  /**
+   * @brief Records the source location of a call made through the
+   * `abcg::gl*` wrappers.
+   *
+   * @param file Source file name.
+   * @param line Line number.
+   * @param function Function name.
+   */
+  static void setLastCall(char const *file, std::uint_least32_t line,
+                          char const *function) noexcept {
+    m_lastFile.store(file, std::memory_order_relaxed);
+    m_lastLine.store(line, std::memory_order_relaxed);
+    m_lastFunction.store(function, std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] static std::string describeLastCall();
+
+private:
+  static inline bool m_checkingErrors{};
+  // Read by the debug output callback, which may run on a driver thread
+  static inline std::atomic<char const *> m_lastFile{};
+  static inline std::atomic<std::uint_least32_t> m_lastLine{};
+  static inline std::atomic<char const *> m_lastFunction{};
+};
+
+#endif
@@ -12,11 +12,20 @@
 
 #include <SDL_events.h>
 #include <SDL_image.h>
+
+#include <algorithm>
+#include <cmath>
+
 #include <imgui_impl_opengl3.h>
 #include <imgui_impl_sdl2.h>
 
 #include "abcgEmbeddedFonts.hpp"
 #include "abcgException.hpp"
+#include "abcgGpuMemory.hpp"
+#include "abcgHitchDetector.hpp"
+#include "abcgLog.hpp"
+#include "abcgMetrics.hpp"
+#include "abcgTrace.hpp"
 #include "abcgWindow.hpp"
 
 /**
@@ -57,9 +66,39 @@ void abcg::OpenGLWindow::saveScreenshotPNG(std::string_view filename) const {
 
   auto const numPixels{gsl::narrow<std::size_t>(size.x * size.y * channels)};
   std::vector<unsigned char> pixels(numPixels);
-  glReadBuffer(m_openGLSettings.doubleBuffering ? GL_BACK : GL_FRONT);
+
+  GLuint resolveFramebuffer{};
+  GLuint resolveRenderbuffer{};
+  if (m_headlessTarget.framebuffer != 0) {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_headlessTarget.framebuffer);
+    if (m_headlessTarget.samples > 0) {
+      // Multisampled renderbuffers must be resolved before reading
+      glGenRenderbuffers(1, &resolveRenderbuffer);
+      glBindRenderbuffer(GL_RENDERBUFFER, resolveRenderbuffer);
+      glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, size.x, size.y);
+      glBindRenderbuffer(GL_RENDERBUFFER, 0);
+      glGenFramebuffers(1, &resolveFramebuffer);
+      glBindFramebuffer(GL_DRAW_FRAMEBUFFER, resolveFramebuffer);
+      glFramebufferRenderbuffer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                GL_RENDERBUFFER, resolveRenderbuffer);
+      glBlitFramebuffer(0, 0, size.x, size.y, 0, 0, size.x, size.y,
+                        GL_COLOR_BUFFER_BIT, GL_NEAREST);
+      glBindFramebuffer(GL_READ_FRAMEBUFFER, resolveFramebuffer);
+    }
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+  } else {
+    glReadBuffer(m_openGLSettings.doubleBuffering ? GL_BACK : GL_FRONT);
+  }
   glReadPixels(0, 0, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
 
+  if (resolveFramebuffer != 0) {
+    glDeleteFramebuffers(1, &resolveFramebuffer);
+    glDeleteRenderbuffers(1, &resolveRenderbuffer);
+  }
+  if (m_headlessTarget.framebuffer != 0) {
+    glBindFramebuffer(GL_FRAMEBUFFER, m_headlessTarget.framebuffer);
+  }
+
   // Flip upside down
   for (auto const line : iter::range(size.y / 2)) {
     std::swap_ranges(pixels.begin() + pitch * line,
@@ -76,6 +115,69 @@ void abcg::OpenGLWindow::saveScreenshotPNG(std::string_view filename) const {
   }
 }
 
+/**
+ * @brief Returns the framebuffer object used as the default framebuffer.
+ *
+ * This is 0 (the window-system-provided framebuffer) unless
+ * abcg::WindowSettings::headless is set, in which case it is the framebuffer
+ * object that replaces the window's backbuffer. The framebuffer is bound
+ * before abcg::OpenGLWindow::onPaintUI is called.
+ *
+ * While abcg::OpenGLWindow::onPaint is called with
+ * abcg::OpenGLSettings::dynamicResolution set, this is the scene framebuffer
+ * that is later upscaled to the window.
+ *
+ * @returns ID of the framebuffer object.
+ *
+ * @remark Bind this framebuffer instead of 0 when restoring the default
+ * framebuffer after rendering to a texture.
+ */
+GLuint abcg::OpenGLWindow::getDefaultFramebuffer() const noexcept {
+  return m_inScenePass ? m_sceneTarget.framebuffer : getOutputFramebuffer();
+}
+
+/**
+ * @brief Returns the size of the framebuffer the scene is rendered into.
+ *
+ * This is the size of the window, in pixels, unless
+ * abcg::OpenGLSettings::dynamicResolution is set, in which case it is the size
+ * of the internal scene framebuffer scaled by
+ * abcg::OpenGLWindow::getResolutionScale.
+ *
+ * @returns Size of the scene framebuffer (width, height), in pixels.
+ */
+glm::ivec2 abcg::OpenGLWindow::getRenderSize() const {
+  if (m_sceneTarget.framebuffer != 0) {
+    return m_sceneTarget.size;
+  }
+  return getWindowSize();
+}
+
+/**
+ * @brief Returns the current scale factor of the scene resolution.
+ *
+ * @returns Scale factor in the range given by
+ * abcg::OpenGLSettings::minResolutionScale and
+ * abcg::OpenGLSettings::maxResolutionScale, or 1 if
+ * abcg::OpenGLSettings::dynamicResolution is not set.
+ */
+float abcg::OpenGLWindow::getResolutionScale() const noexcept {
+  return m_resolutionScale;
+}
+
+/**
+ * @brief Returns the GPU timer of the window.
+ *
+ * The timer measures the scopes "Scene" (abcg::OpenGLWindow::onPaint) and
+ * "UI" of each frame. Additional scopes can be opened from
+ * abcg::OpenGLWindow::onPaint.
+ *
+ * @returns Reference to the GPU timer.
+ */
+abcg::OpenGLGpuTimer &abcg::OpenGLWindow::getGpuTimer() noexcept {
+  return m_gpuTimer;
+}
+
 /**
  * @brief Custom event handler.
  *
@@ -109,11 +211,11 @@ void abcg::OpenGLWindow::onCreate() { glClearColor(0, 0, 0, 1); }
  *
  * Override it for custom behavior. By default, it clears the color buffer and
  * calls `glViewport(0, 0, w, h)`, where `w` is the width, and `h` is the height
- * of the window.
+ * of the scene framebuffer returned by abcg::OpenGLWindow::getRenderSize.
  */
 void abcg::OpenGLWindow::onPaint() {
   glClear(GL_COLOR_BUFFER_BIT);
-  auto const size{getWindowSize()};
+  auto const size{getRenderSize()};
   glViewport(0, 0, size.x, size.y);
 }
 
@@ -126,39 +228,68 @@ void abcg::OpenGLWindow::onPaint() {
  * This is not called when the window is minimized.
  *
  * Override it for custom behavior. By default, it shows a FPS counter if
- * abcg::WindowSettings::showFPS is set to `true`, and a toggle fullscreen
+ * abcg::WindowSettings::showFPS is set to `true`, the profiler timeline if
+ * abcg::WindowSettings::showProfiler is set to `true`, and a toggle fullscreen
  * button if abcg::WindowSettings::showFullscreenButton is set to `true`.
  */
 void abcg::OpenGLWindow::onPaintUI() {
   // FPS counter
   if (abcg::Window::getWindowSettings().showFPS) {
-    auto fps{ImGui::GetIO().Framerate};
-
-    static auto offset{0UL};
-    static auto refreshTime{ImGui::GetTime()};
-    static std::array<float, 150> frames{};
-
-    while (refreshTime < ImGui::GetTime()) {
-      auto const refreshFrequency{60.0};
-      frames.at(offset) = fps;
-      offset = (offset + 1) % frames.size();
-      refreshTime += (1.0 / refreshFrequency);
-    }
-
     ImGui::SetNextWindowPos(ImVec2(5, 5));
     ImGui::Begin("FPS", nullptr,
                  ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoInputs |
                      ImGuiWindowFlags_NoBringToFrontOnFocus |
-                     ImGuiWindowFlags_NoFocusOnAppearing);
-    auto const label{fmt::format("avg {:.1f} FPS", fps)};
-    ImGui::PlotLines("", frames.data(), gsl::narrow<int>(frames.size()),
-                     gsl::narrow<int>(offset), label.c_str(), 0.0f,
-                     // *std::ranges::max_element(frames) * 2,
-                     *std::max_element(frames.begin(), frames.end()) * 2,
-                     ImVec2(gsl::narrow<float>(frames.size()), 50));
+                     ImGuiWindowFlags_NoFocusOnAppearing |
+                     ImGuiWindowFlags_AlwaysAutoResize);
+    abcg::Window::getFrameStatistics().showPlots();
+    if (auto const latency{abcg::Window::getInputLatency()}; latency > 0.0) {
+      ImGui::Text("input latency %.1f ms", latency * 1000.0);
+    }
+    if constexpr (abcg::AllocationTracker::isEnabled()) {
+      auto const allocations{abcg::AllocationTracker::getLastFrameStats()};
+      ImGui::Text("heap %llu allocs, %.1f KiB",
+                  static_cast<unsigned long long>(allocations.allocations),
+                  static_cast<double>(allocations.bytes) / 1024.0);
+    }
+    if (auto const sceneTime{m_gpuTimer.getTime("Scene")}) {
+      ImGui::Text("GPU scene %.2f ms, UI %.2f ms", *sceneTime * 1000.0,
+                  m_gpuTimer.getTime("UI").value_or(0.0) * 1000.0);
+    }
+    constexpr double mebibyte{1024.0 * 1024.0};
+    ImGui::Text(
+        "VRAM %.1f MiB, peak %.1f MiB",
+        static_cast<double>(abcg::GpuMemory::getLiveBytes()) / mebibyte,
+        static_cast<double>(abcg::GpuMemory::getPeakBytes()) / mebibyte);
+    if constexpr (abcg::OpenGLCounters::isEnabled()) {
+      auto const &counters{abcg::OpenGLCounters::getLastFrameCounters()};
+      auto const toULL{[](std::uint64_t value) {
+        return static_cast<unsigned long long>(value);
+      }};
+      ImGui::Text("%llu draws, %llu vertices, %llu instances",
+                  toULL(counters.drawCalls), toULL(counters.vertices),
+                  toULL(counters.instances));
+      ImGui::Text("binds: %llu programs, %llu VAOs, %llu textures, "
+                  "%llu buffers",
+                  toULL(counters.programBinds),
+                  toULL(counters.vertexArrayBinds),
+                  toULL(counters.textureBinds), toULL(counters.bufferBinds));
+      ImGui::Text("%llu uniforms, %llu tex params, %llu redundant, "
+                  "upload %.1f KiB",
+                  toULL(counters.uniformUploads),
+                  toULL(counters.textureParameterChanges),
+                  toULL(counters.redundantCalls),
+                  static_cast<double>(counters.bufferBytesUploaded +
+                                      counters.textureBytesUploaded) /
+                      1024.0);
+    }
     ImGui::End();
   }
 
+  // Profiler timeline
+  if (abcg::Window::getWindowSettings().showProfiler) {
+    abcg::Profiler::showWindow();
+  }
+
   // Fullscreen button
   if (abcg::Window::getWindowSettings().showFullscreenButton) {
 #if defined(__EMSCRIPTEN__)
@@ -206,7 +337,7 @@ void abcg::OpenGLWindow::onResize([[maybe_unused]] glm::ivec2 const &size) {}
 /**
  * @brief Custom handler called for each frame before painting.
  *
- * This virtual function is called just before abcg::VulkanWindow::onPaint, even
+ * This virtual function is called just before abcg::OpenGLWindow::onPaint, even
  * if the window is minimized.
  *
  * Override it for custom behavior. By default, it does nothing.
@@ -296,22 +427,36 @@ void abcg::OpenGLWindow::create() {
   m_GLSLVersion =
       fmt::format("#version {:d}{:02d}", majorVersion, minorVersion * 10);
 
+  auto contextMode{m_openGLSettings.contextMode};
+  if (contextMode == OpenGLContextMode::Default) {
+    auto const validation{m_openGLSettings.validation};
+    contextMode = validation == OpenGLValidationLevel::DebugOutput ||
+                          validation == OpenGLValidationLevel::Full
+                      ? OpenGLContextMode::Debug
+                      : OpenGLContextMode::Regular;
+  }
+  int const debugFlag{contextMode == OpenGLContextMode::Debug
+                          ? SDL_GL_CONTEXT_DEBUG_FLAG
+                          : 0};
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_NO_ERROR,
+                      contextMode == OpenGLContextMode::NoError ? 1 : 0);
+
   switch (profile) {
   case OpenGLProfile::Core:
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS,
-                        SDL_GL_CONTEXT_FORWARD_COMPATIBLE_FLAG);
+                        SDL_GL_CONTEXT_FORWARD_COMPATIBLE_FLAG | debugFlag);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK,
                         SDL_GL_CONTEXT_PROFILE_CORE);
     m_GLSLVersion += " core";
     break;
   case OpenGLProfile::Compatibility:
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, 0);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, debugFlag);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK,
                         SDL_GL_CONTEXT_PROFILE_COMPATIBILITY);
     m_GLSLVersion += " compatibility";
     break;
   case OpenGLProfile::ES:
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, 0);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, debugFlag);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_ES);
     m_GLSLVersion += " es";
     break;
@@ -324,23 +469,24 @@ void abcg::OpenGLWindow::create() {
   SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, m_openGLSettings.depthBufferSize);
   SDL_GL_SetAttribute(SDL_GL_STENCIL_SIZE, m_openGLSettings.stencilBufferSize);
 
-  if (m_openGLSettings.samples > 0) {
+  if (getOutputSamples() > 0) {
     // Enable multisampling
     SDL_GL_SetAttribute(SDL_GL_MULTISAMPLEBUFFERS, 1);
     // Can be 2, 4, 8 or 16
-    SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, m_openGLSettings.samples);
+    SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, getOutputSamples());
   } else {
     SDL_GL_SetAttribute(SDL_GL_MULTISAMPLEBUFFERS, 0);
   }
 
+  auto contextPhase{measureStartupPhase("SDL window and OpenGL context")};
   // Create window with graphics context
   while (true) {
-    if (!createSDLWindow(SDL_WINDOW_OPENGL) && m_openGLSettings.samples > 0) {
+    if (!createSDLWindow(SDL_WINDOW_OPENGL) && getOutputSamples() > 0) {
       // Try again, but this time with multisampling disabled
       m_openGLSettings.samples = 0;
       SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, 0);
       SDL_GL_SetAttribute(SDL_GL_MULTISAMPLEBUFFERS, 0);
-      fmt::print("Warning: multisampling requested but not supported!\n");
+      abcg::Log::warning("Multisampling requested but not supported!");
     } else {
       break;
     }
@@ -352,33 +498,87 @@ void abcg::OpenGLWindow::create() {
 
   // Create OpenGL context
   m_GLContext = SDL_GL_CreateContext(abcg::Window::getSDLWindow());
+  if (m_GLContext == nullptr && contextMode == OpenGLContextMode::NoError) {
+    // KHR_no_error not supported
+    abcg::Log::warning("KHR_no_error context not supported!");
+    contextMode = OpenGLContextMode::Regular;
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_NO_ERROR, 0);
+    m_GLContext = SDL_GL_CreateContext(abcg::Window::getSDLWindow());
+  }
   if (m_GLContext == nullptr) {
     throw abcg::SDLError("SDL_GL_CreateContext failed");
   }
 
 #if !defined(__EMSCRIPTEN__)
-  SDL_GL_SetSwapInterval(m_openGLSettings.vSync ? 1 : 0);
+  if (!m_openGLSettings.vSync) {
+    SDL_GL_SetSwapInterval(0);
+  } else if (!m_openGLSettings.adaptiveVSync ||
+             SDL_GL_SetSwapInterval(-1) != 0) {
+    // Adaptive vSync not requested or not supported
+    SDL_GL_SetSwapInterval(1);
+  }
 #endif
+  contextPhase.end();
 
 #if !defined(__EMSCRIPTEN__)
+  auto glewPhase{measureStartupPhase("GLEW")};
   if (auto const err{glewInit()}; GLEW_OK != err) {
     throw abcg::Exception{
         fmt::format("Failed to initialize OpenGL loader: {}",
                     reinterpret_cast<char const *>(glewGetErrorString(err)))};
   }
-  fmt::print("Using GLEW.....: {}\n",
-             reinterpret_cast<char const *>(glewGetString(GLEW_VERSION)));
+  abcg::Log::info("Using GLEW.....: {}",
+                  reinterpret_cast<char const *>(glewGetString(GLEW_VERSION)));
+  glewPhase.end();
 #endif
 
-  fmt::print("OpenGL vendor..: {}\n",
-             reinterpret_cast<char const *>(glGetString(GL_VENDOR)));
-  fmt::print("OpenGL renderer: {}\n",
-             reinterpret_cast<char const *>(glGetString(GL_RENDERER)));
-  fmt::print("OpenGL version.: {}\n",
-             reinterpret_cast<char const *>(glGetString(GL_VERSION)));
-  fmt::print(
-      "GLSL version...: {}\n",
+  OpenGLValidation::setSampleInterval(
+      m_openGLSettings.validationSampleInterval);
+  OpenGLValidation::setLevel(m_openGLSettings.validation);
+  OpenGLValidation::onContextCreated(contextMode == OpenGLContextMode::NoError);
+  OpenGLStateCache::invalidate();
+  if (auto const &capture{m_openGLSettings.capture}; !capture.path.empty()) {
+    auto const windowSize{getWindowSize()};
+    OpenGLCapture::start(capture.path,
+                         {.es = profile == OpenGLProfile::ES,
+                          .majorVersion = majorVersion,
+                          .minorVersion = minorVersion,
+                          .width = windowSize.x,
+                          .height = windowSize.y,
+                          .firstFrame = capture.firstFrame,
+                          .frames = capture.frames});
+  }
+
+  auto driverInfoPhase{measureStartupPhase("Driver info")};
+  abcg::Log::info("OpenGL vendor..: {}",
+                  reinterpret_cast<char const *>(glGetString(GL_VENDOR)));
+  abcg::Log::info("OpenGL renderer: {}",
+                  reinterpret_cast<char const *>(glGetString(GL_RENDERER)));
+  abcg::Log::info("OpenGL version.: {}",
+                  reinterpret_cast<char const *>(glGetString(GL_VERSION)));
+  abcg::Log::info(
+      "GLSL version...: {}",
       reinterpret_cast<char const *>(glGetString(GL_SHADING_LANGUAGE_VERSION)));
+  driverInfoPhase.end();
+
+  if (abcg::Window::getWindowSettings().headless) {
+    createRenderTarget(m_headlessTarget, getWindowSize(), getOutputSamples(),
+                       true);
+  }
+
+  if (m_openGLSettings.dynamicResolution) {
+    m_openGLSettings.minResolutionScale =
+        std::clamp(m_openGLSettings.minResolutionScale, 0.1f, 1.0f);
+    m_openGLSettings.maxResolutionScale =
+        std::clamp(m_openGLSettings.maxResolutionScale,
+                   m_openGLSettings.minResolutionScale, 1.0f);
+    m_resolutionScale = m_openGLSettings.maxResolutionScale;
+  }
+
+  // Timer queries are not available in OpenGL ES 3.0
+  if (profile != OpenGLProfile::ES) {
+    m_gpuTimer.create();
+  }
 
   // Print out extensions
   // GLint numExtensions{};
@@ -389,14 +589,18 @@ void abcg::OpenGLWindow::create() {
   //       reinterpret_cast<char const *>(glGetStringi(GL_EXTENSIONS, index)));
   // }
 
+  auto imGuiPhase{measureStartupPhase("Dear ImGui")};
   // Setup Dear ImGui context
   IMGUI_CHECKVERSION();
   ImGui::CreateContext();
   ImGuiIO &guiIO{ImGui::GetIO()};
   // Enable keyboard controls
   guiIO.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
-  // Enable gamepad controls
-  guiIO.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;
+  // Enable gamepad controls if game controllers are available. Otherwise,
+  // they are enabled by abcg::Application::initSubsystems.
+  if (SDL_WasInit(SDL_INIT_GAMECONTROLLER) != 0U) {
+    guiIO.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;
+  }
 
   // For an Emscripten build we are disabling file-system access, so let's
   // not attempt to do a fopen() of the imgui.ini file. You may manually
@@ -418,19 +622,47 @@ void abcg::OpenGLWindow::create() {
                                         &fontConfig) == nullptr) {
     throw abcg::RuntimeError("Failed to load font file");
   }
+  imGuiPhase.end();
 
-  onCreate();
+  {
+    auto const phase{measureStartupPhase("onCreate")};
+    onCreate();
+  }
 
   onResize(getWindowSize());
 }
 
-void abcg::OpenGLWindow::paint() {
-  onUpdate();
+void abcg::OpenGLWindow::update() { onUpdate(); }
 
-  if (m_hidden || m_minimized)
+void abcg::OpenGLWindow::paint() {
+  if ((m_hidden || m_minimized) && m_headlessTarget.framebuffer == 0)
     return;
 
   SDL_GL_MakeCurrent(abcg::Window::getSDLWindow(), m_GLContext);
+  OpenGLCounters::newFrame();
+  OpenGLValidation::newFrame();
+  OpenGLCapture::newFrame();
+
+  if (m_headlessTarget.framebuffer != 0) {
+    // Follow changes of the window size set by setWindowSettings
+    if (auto const size{getWindowSize()}; size != m_headlessTarget.size) {
+      createRenderTarget(m_headlessTarget, size, getOutputSamples(), true);
+      onResize(size);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, m_headlessTarget.framebuffer);
+  }
+
+  if (m_gpuTimer.beginFrame()) {
+    for (auto const &result : m_gpuTimer.getResults()) {
+      Trace::addGpuZone(result.name, result.start, result.end);
+    }
+    if (auto const sceneTime{m_gpuTimer.getTime("Scene")}) {
+      // Exponential moving average to filter out noise
+      m_sceneGPUTime = m_sceneGPUTime > 0.0
+                           ? std::lerp(m_sceneGPUTime, *sceneTime, 0.1)
+                           : *sceneTime;
+    }
+  }
 
 #if defined(__EMSCRIPTEN__)
   // Force window size in windowed mode
@@ -443,33 +675,86 @@ void abcg::OpenGLWindow::paint() {
   }
 #endif
 
-  ImGui_ImplOpenGL3_NewFrame();
-  ImGui_ImplSDL2_NewFrame();
-  ImGui::NewFrame();
+  Timer phaseTimer;
+  {
+    ABCG_PROFILE_SCOPE("ImGui::NewFrame");
+    ImGui_ImplOpenGL3_NewFrame();
+    ImGui_ImplSDL2_NewFrame();
+    ImGui::NewFrame();
+  }
 
-  onPaintUI();
+  {
+    ABCG_PROFILE_SCOPE("onPaintUI");
+    onPaintUI();
+  }
 
-  ImGui::Render();
+  {
+    ABCG_PROFILE_SCOPE("ImGui::Render");
+    ImGui::Render();
+  }
+  auto uiTime{phaseTimer.restart()};
 
-  onPaint();
+  {
+    ABCG_PROFILE_SCOPE("onPaint");
+    if (m_openGLSettings.dynamicResolution) {
+      beginScenePass();
+    }
+    auto const sceneScope{m_gpuTimer.begin("Scene")};
+    onPaint();
+    m_gpuTimer.end(sceneScope);
+    if (m_openGLSettings.dynamicResolution) {
+      endScenePass();
+    }
+  }
+  addFramePhaseTime(FramePhase::Paint, phaseTimer.restart());
+
+  {
+    ABCG_PROFILE_SCOPE("ImGui_ImplOpenGL3_RenderDrawData");
+    auto const uiScope{m_gpuTimer.begin("UI")};
+    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    m_gpuTimer.end(uiScope);
+    // Dear ImGui changes the state without going through the wrappers
+    OpenGLStateCache::invalidate();
+  }
+  addFramePhaseTime(FramePhase::UI, uiTime + phaseTimer.restart());
 
-  ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-  if (m_openGLSettings.doubleBuffering) {
-    SDL_GL_SwapWindow(abcg::Window::getSDLWindow());
+  if (m_headlessTarget.framebuffer != 0) {
+    // There is nothing to present. Wait for the GPU as a blocking swap would
+    // do, so that frame times account for the GPU work.
+    ABCG_PROFILE_SCOPE("glFinish");
+    glFinish();
+  } else if (m_openGLSettings.doubleBuffering) {
+    {
+      ABCG_PROFILE_SCOPE("SDL_GL_SwapWindow");
+      SDL_GL_SwapWindow(abcg::Window::getSDLWindow());
+    }
+    ABCG_PROFILE_SCOPE("waitForFramesInFlight");
+    waitForFramesInFlight();
   } else {
+    ABCG_PROFILE_SCOPE("glFinish");
     glFinish();
   }
+  addFramePhaseTime(FramePhase::Swap, phaseTimer.elapsed());
+  markFramePresented();
 }
 
 void abcg::OpenGLWindow::destroy() {
   onDestroy();
 
+  destroyRenderTarget(m_headlessTarget);
+  destroyRenderTarget(m_sceneTarget);
+  destroyRenderTarget(m_resolveTarget);
+  m_gpuTimer.destroy();
+  destroyFrameFences();
+
   if (ImGui::GetCurrentContext() != nullptr) {
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplSDL2_Shutdown();
     ImGui::DestroyContext();
   }
   if (m_GLContext != nullptr) {
+    OpenGLValidation::onContextDestroyed();
+    OpenGLCapture::stop();
     SDL_GL_DeleteContext(m_GLContext);
     m_GLContext = nullptr;
   }
@@ -478,7 +763,223 @@ void abcg::OpenGLWindow::destroy() {
 [[nodiscard]] glm::ivec2 abcg::OpenGLWindow::getWindowSize() const {
   glm::ivec2 size{};
   if (auto *window{abcg::Window::getSDLWindow()}; window != nullptr) {
-    SDL_GL_GetDrawableSize(window, &size.x, &size.y);
+    if (abcg::Window::getWindowSettings().headless) {
+      auto const &windowSettings{abcg::Window::getWindowSettings()};
+      size = {std::max(windowSettings.width, 1),
+              std::max(windowSettings.height, 1)};
+    } else {
+      SDL_GL_GetDrawableSize(window, &size.x, &size.y);
+    }
   }
   return size;
 }
+
+void abcg::OpenGLWindow::createRenderTarget(RenderTarget &target,
+                                            glm::ivec2 const &size,
+                                            int samples, bool withDepth) const {
+  abcg::HitchDetector::addNote(fmt::format(
+      "Render target created ({}x{}, {} samples)", size.x, size.y, samples));
+  abcg::Metrics::counter("abcg.render_target_rebuilds").add();
+  destroyRenderTarget(target);
+
+  // All formats used here have 4 bytes per sample
+  auto const allocateStorage{[samples, &size](GLuint renderbuffer,
+                                              GLenum internalFormat,
+                                              char const *formatName) {
+    if (samples > 0) {
+      glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples,
+                                       internalFormat, size.x, size.y);
+    } else {
+      glRenderbufferStorage(GL_RENDERBUFFER, internalFormat, size.x, size.y);
+    }
+    abcg::GpuMemory::track(
+        {.kind = abcg::GpuResourceKind::Renderbuffer,
+         .handle = renderbuffer,
+         .bytes = abcg::GpuMemory::getTextureSize(
+                      gsl::narrow<std::uint32_t>(size.x),
+                      gsl::narrow<std::uint32_t>(size.y), 4) *
+                  gsl::narrow<std::uint64_t>(std::max(samples, 1)),
+         .format = formatName,
+         .label = "Render target"});
+  }};
+
+  glGenFramebuffers(1, &target.framebuffer);
+  glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+
+  // Color buffer
+  glGenRenderbuffers(1, &target.colorRenderbuffer);
+  glBindRenderbuffer(GL_RENDERBUFFER, target.colorRenderbuffer);
+  allocateStorage(target.colorRenderbuffer, GL_RGBA8, "RGBA8");
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                            GL_RENDERBUFFER, target.colorRenderbuffer);
+
+  // Depth/stencil buffer
+  if (withDepth && (m_openGLSettings.depthBufferSize > 0 ||
+                    m_openGLSettings.stencilBufferSize > 0)) {
+    auto const hasStencil{m_openGLSettings.stencilBufferSize > 0};
+    glGenRenderbuffers(1, &target.depthRenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, target.depthRenderbuffer);
+    if (hasStencil) {
+      allocateStorage(target.depthRenderbuffer, GL_DEPTH24_STENCIL8,
+                      "DEPTH24_STENCIL8");
+    } else if (m_openGLSettings.depthBufferSize > 24) {
+      allocateStorage(target.depthRenderbuffer, GL_DEPTH_COMPONENT32F,
+                      "DEPTH_COMPONENT32F");
+    } else {
+      allocateStorage(target.depthRenderbuffer, GL_DEPTH_COMPONENT24,
+                      "DEPTH_COMPONENT24");
+    }
+    glFramebufferRenderbuffer(
+        GL_FRAMEBUFFER,
+        hasStencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT,
+        GL_RENDERBUFFER, target.depthRenderbuffer);
+  }
+  glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    destroyRenderTarget(target);
+    throw abcg::RuntimeError("Failed to create framebuffer object");
+  }
+
+  target.size = size;
+  target.samples = samples;
+}
+
+void abcg::OpenGLWindow::destroyRenderTarget(RenderTarget &target) {
+  if (target.framebuffer == 0)
+    return;
+
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glDeleteFramebuffers(1, &target.framebuffer);
+  glDeleteRenderbuffers(1, &target.colorRenderbuffer);
+  if (target.depthRenderbuffer != 0) {
+    glDeleteRenderbuffers(1, &target.depthRenderbuffer);
+  }
+  target = {};
+}
+
+// Framebuffer presented to the window, regardless of the scene pass
+GLuint abcg::OpenGLWindow::getOutputFramebuffer() const noexcept {
+  return m_headlessTarget.framebuffer;
+}
+
+// Number of samples of the window's framebuffer. With dynamic resolution,
+// multisampling is only used in the scene framebuffer.
+int abcg::OpenGLWindow::getOutputSamples() const noexcept {
+  return m_openGLSettings.dynamicResolution ? 0 : m_openGLSettings.samples;
+}
+
+// Binds the scene framebuffer of the dynamic resolution path, resizing it to
+// the current resolution scale
+void abcg::OpenGLWindow::beginScenePass() {
+  updateResolutionScale();
+
+  auto const windowSize{getWindowSize()};
+  auto const renderSize{glm::max(
+      glm::ivec2{1},
+      glm::ivec2{glm::round(glm::vec2{windowSize} * m_resolutionScale)})};
+  if (renderSize != m_sceneTarget.size) {
+    createRenderTarget(m_sceneTarget, renderSize, m_openGLSettings.samples,
+                       true);
+    if (m_openGLSettings.samples > 0) {
+      createRenderTarget(m_resolveTarget, renderSize, 0, false);
+    }
+  }
+
+  glBindFramebuffer(GL_FRAMEBUFFER, m_sceneTarget.framebuffer);
+  glViewport(0, 0, renderSize.x, renderSize.y);
+  m_inScenePass = true;
+}
+
+// Upscales the scene framebuffer to the window's framebuffer
+void abcg::OpenGLWindow::endScenePass() {
+  m_inScenePass = false;
+  auto const outputFramebuffer{getOutputFramebuffer()};
+  auto const windowSize{getWindowSize()};
+  auto const &size{m_sceneTarget.size};
+
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, m_sceneTarget.framebuffer);
+  if (m_sceneTarget.samples > 0) {
+    // Multisampled buffers must be resolved before they can be scaled
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_resolveTarget.framebuffer);
+    glBlitFramebuffer(0, 0, size.x, size.y, 0, 0, size.x, size.y,
+                      GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_resolveTarget.framebuffer);
+  }
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, outputFramebuffer);
+  glBlitFramebuffer(0, 0, size.x, size.y, 0, 0, windowSize.x, windowSize.y,
+                    GL_COLOR_BUFFER_BIT, GL_LINEAR);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer);
+  glViewport(0, 0, windowSize.x, windowSize.y);
+}
+
+// Adjusts the resolution scale from the measured GPU time of the scene
+void abcg::OpenGLWindow::updateResolutionScale() {
+  if (!m_gpuTimer.isSupported())
+    return;
+
+  // Give the moving average some frames to settle after each change
+  constexpr int framesBetweenChanges{15};
+  if (++m_framesSinceScaleChange < framesBetweenChanges ||
+      m_sceneGPUTime <= 0.0)
+    return;
+
+  // Do nothing while the GPU time is within [80%, 100%] of the budget
+  auto const budget{m_openGLSettings.targetFrameTime};
+  if (m_sceneGPUTime <= budget && m_sceneGPUTime >= budget * 0.8)
+    return;
+
+  // The GPU time of fragment-bound scenes is roughly proportional to the
+  // number of pixels, i.e., to the square of the scale. Limit the change per
+  // step to avoid oscillations, and quantize it to avoid reallocating the
+  // framebuffer for tiny changes. The quantization rounds in the direction of
+  // the change, so that small scales, whose steps are smaller than the
+  // quantum, do not get stuck.
+  auto const scale{gsl::narrow_cast<double>(m_resolutionScale)};
+  auto newScale{scale * std::sqrt(budget / m_sceneGPUTime)};
+  newScale = std::clamp(newScale, scale * 0.9, scale * 1.05);
+  constexpr double quantum{1.0 / 32.0};
+  newScale = (newScale > scale ? std::ceil(newScale / quantum)
+                               : std::floor(newScale / quantum)) *
+             quantum;
+  newScale = std::clamp(
+      newScale,
+      gsl::narrow_cast<double>(m_openGLSettings.minResolutionScale),
+      gsl::narrow_cast<double>(m_openGLSettings.maxResolutionScale));
+
+  if (auto const newScaleFloat{gsl::narrow_cast<float>(newScale)};
+      newScaleFloat != m_resolutionScale) {
+    m_resolutionScale = newScaleFloat;
+    m_framesSinceScaleChange = 0;
+  }
+}
+
+// Bounds the number of frames queued on the GPU when
+// OpenGLSettings::lowLatency is set
+void abcg::OpenGLWindow::waitForFramesInFlight() {
+#if !defined(__EMSCRIPTEN__)
+  if (!m_openGLSettings.lowLatency)
+    return;
+
+  m_frameFences.push_back(abcg::glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+
+  auto const maxFramesInFlight{gsl::narrow<std::size_t>(
+      std::max(m_openGLSettings.maxFramesInFlight, 0))};
+  while (m_frameFences.size() > maxFramesInFlight) {
+    auto *const fence{m_frameFences.front()};
+    m_frameFences.pop_front();
+    // Wait for at most one second so that a lost fence cannot hang the loop
+    constexpr GLuint64 timeout{1'000'000'000};
+    abcg::glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+    abcg::glDeleteSync(fence);
+  }
+#endif
+}
+
+void abcg::OpenGLWindow::destroyFrameFences() {
+  for (auto *const fence : m_frameFences) {
+    abcg::glDeleteSync(fence);
+  }
+  m_frameFences.clear();
+}
@@ -13,13 +13,17 @@
 #ifndef ABCG_OPENGL_WINDOW_HPP_
 #define ABCG_OPENGL_WINDOW_HPP_
 
+#include <array>
+#include <deque>
 #include <string>
 
 #include "abcgExternal.hpp"
 #include "abcgOpenGLFunction.hpp"
+#include "abcgOpenGLGpuTimer.hpp"
 #include "abcgWindow.hpp"
 
 namespace abcg {
+enum class OpenGLContextMode;
 enum class OpenGLProfile;
 class OpenGLWindow;
 struct OpenGLSettings;
@@ -48,6 +52,32 @@ enum class abcg::OpenGLProfile {
   ES
 };
 
+/**
+ * @brief Enumeration of OpenGL context modes.
+ *
+ * @sa abcg::OpenGLSettings.
+ */
+enum class abcg::OpenGLContextMode {
+  /** @brief Debug context if the validation level uses the `KHR_debug`
+   * debug output, regular context otherwise. */
+  Default,
+  /** @brief Regular context. */
+  Regular,
+  /** @brief Debug context.
+   *
+   * Drivers may report more messages through the debug output, at the cost
+   * of some performance.
+   */
+  Debug,
+  /** @brief Context created with `KHR_no_error`.
+   *
+   * The driver may skip error checking, and errors result in undefined
+   * behavior. Validation is disabled. If the extension is not supported, a
+   * regular context is created.
+   */
+  NoError
+};
+
 /**
  * @brief Configuration settings for creating an OpenGL context.
  *
@@ -75,8 +105,79 @@ struct abcg::OpenGLSettings {
   /** @brief Whether the swapping of the front and back frame buffers is
    * synchronized with the vertical retrace. */
   bool vSync{false};
+  /** @brief Whether to use adaptive vSync (swap interval -1) when `vSync` is
+   * set, so that late frames are presented immediately instead of waiting for
+   * the next vertical retrace. If adaptive vSync is not supported, regular
+   * vSync is used. */
+  bool adaptiveVSync{false};
   /** @brief Whether the output is double buffered. */
   bool doubleBuffering{true};
+  /** @brief Mode of the OpenGL context. */
+  OpenGLContextMode contextMode{OpenGLContextMode::Default};
+  /** @brief Initial level of validation of OpenGL calls.
+   *
+   * The default is abcg::OpenGLValidationLevel::DebugOutput in debug builds,
+   * and abcg::OpenGLValidationLevel::Off in release builds.
+   *
+   * @sa abcg::OpenGLValidation::setLevel.
+   */
+#if defined(NDEBUG)
+  OpenGLValidationLevel validation{OpenGLValidationLevel::Off};
+#else
+  OpenGLValidationLevel validation{OpenGLValidationLevel::DebugOutput};
+#endif
+  /** @brief Interval of the frames checked with
+   * abcg::OpenGLValidationLevel::SampledFrames. */
+  int validationSampleInterval{60};
+  /** @brief Whether to limit how far the CPU can run ahead of the GPU.
+   *
+   * When set, a fence is inserted after each buffer swap and the CPU waits
+   * until at most `maxFramesInFlight` presented frames are still being
+   * processed by the GPU. This reduces the input-to-present latency at the
+   * cost of some throughput.
+   *
+   * @remark This is ignored on WebAssembly, where fences cannot be waited on.
+   */
+  bool lowLatency{false};
+  /** @brief Maximum number of frames the GPU may still be processing when the
+   * CPU starts a new frame, if `lowLatency` is set. Zero waits for each frame
+   * to complete before starting the next one. */
+  int maxFramesInFlight{1};
+  /** @brief Whether to render the scene at a dynamically adjusted resolution.
+   *
+   * When set, abcg::OpenGLWindow::onPaint renders into an internal
+   * framebuffer whose size is a fraction of the window size. The fraction is
+   * adjusted from the GPU time of abcg::OpenGLWindow::onPaint to meet
+   * `targetFrameTime`, and the result is upscaled to the window before the UI
+   * is rendered at native resolution. Use abcg::OpenGLWindow::getRenderSize
+   * to set the viewport in abcg::OpenGLWindow::onPaint.
+   *
+   * Multisampling (`samples`) is applied to the internal framebuffer only.
+   *
+   * @remark The resolution is only adjusted on desktop OpenGL, where timer
+   * queries are available. Otherwise, the scene is rendered at
+   * `maxResolutionScale`.
+   */
+  bool dynamicResolution{false};
+  /** @brief GPU time budget of abcg::OpenGLWindow::onPaint, in seconds, when
+   * `dynamicResolution` is set. */
+  double targetFrameTime{1.0 / 60.0};
+  /** @brief Minimum scale factor of the scene resolution when
+   * `dynamicResolution` is set. */
+  float minResolutionScale{0.5f};
+  /** @brief Maximum scale factor of the scene resolution when
+   * `dynamicResolution` is set. */
+  float maxResolutionScale{1.0f};
+  /** @brief Capture of the OpenGL calls of a range of frames.
+   *
+   * If `capture.path` is set, the calls made through the `abcg::gl*`
+   * wrappers are written to that file from the creation of the context to
+   * the end of the last captured frame. The file can be replayed with the
+   * `glreplay` tool.
+   *
+   * @sa abcg::OpenGLCapture.
+   */
+  OpenGLCaptureSettings capture{};
 };
 
 /**
@@ -101,6 +202,10 @@ public:
   [[nodiscard]] OpenGLSettings const &getOpenGLSettings() const noexcept;
   void setOpenGLSettings(OpenGLSettings const &openGLSettings) noexcept;
   void saveScreenshotPNG(std::string_view filename) const;
+  [[nodiscard]] GLuint getDefaultFramebuffer() const noexcept;
+  [[nodiscard]] glm::ivec2 getRenderSize() const;
+  [[nodiscard]] float getResolutionScale() const noexcept;
+  [[nodiscard]] OpenGLGpuTimer &getGpuTimer() noexcept;
 
 protected:
   virtual void onEvent(SDL_Event const &event);
@@ -114,15 +219,54 @@ protected:
 private:
   void handleEvent(SDL_Event const &event) final;
   void create() final;
+  void update() final;
   void paint() final;
   void destroy() final;
   [[nodiscard]] glm::ivec2 getWindowSize() const final;
 
+  // Framebuffer object with renderbuffer attachments
+  struct RenderTarget {
+    GLuint framebuffer{};
+    GLuint colorRenderbuffer{};
+    GLuint depthRenderbuffer{};
+    glm::ivec2 size{};
+    int samples{};
+  };
+
+  void createRenderTarget(RenderTarget &target, glm::ivec2 const &size,
+                          int samples, bool withDepth) const;
+  static void destroyRenderTarget(RenderTarget &target);
+  [[nodiscard]] GLuint getOutputFramebuffer() const noexcept;
+  [[nodiscard]] int getOutputSamples() const noexcept;
+  void beginScenePass();
+  void endScenePass();
+  void updateResolutionScale();
+  void waitForFramesInFlight();
+  void destroyFrameFences();
+
   OpenGLSettings m_openGLSettings;
   std::string m_GLSLVersion;
   SDL_GLContext m_GLContext{};
   bool m_hidden{};
   bool m_minimized{};
+
+  // Backbuffer used in headless mode
+  RenderTarget m_headlessTarget;
+
+  // Scene framebuffer, multisample resolve framebuffer, and controller state
+  // used with dynamic resolution
+  RenderTarget m_sceneTarget;
+  RenderTarget m_resolveTarget;
+  bool m_inScenePass{};
+  float m_resolutionScale{1.0f};
+  double m_sceneGPUTime{};
+  int m_framesSinceScaleChange{};
+
+  // GPU time of the scene and UI passes
+  OpenGLGpuTimer m_gpuTimer;
+
+  // Fences of the presented frames not yet known to be completed by the GPU
+  std::deque<GLsync> m_frameFences;
 };
 
 #endif
@@ -0,0 +1,345 @@
+/**
+ * @file abcgProfiler.cpp
+ * @brief Definition of abcg::Profiler and abcg::ProfileScope members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgProfiler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "abcgExternal.hpp"
+
+namespace {
+// Maximum number of zones a thread can record between two frames
+constexpr std::size_t ringCapacity{4096};
+
+std::int64_t now() noexcept {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Single-producer single-consumer ring of zones. The owner thread advances
+// the head, and abcg::Profiler::newFrame advances the tail.
+struct ThreadBuffer {
+  std::array<abcg::ProfileZone, ringCapacity> zones{};
+  std::atomic<std::uint64_t> head{};
+  std::atomic<std::uint64_t> tail{};
+  std::atomic<bool> exited{};
+  std::uint32_t index{};
+  // Nesting level of the open scopes, only accessed by the owner thread
+  std::uint32_t depth{};
+};
+
+struct ProfilerState {
+  std::mutex mutex;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+  std::vector<std::string> threadNames;
+  abcg::ProfileFrame lastFrame;
+  std::int64_t frameStart{};
+};
+
+ProfilerState &state() {
+  static ProfilerState instance;
+  return instance;
+}
+
+std::atomic<bool> enabled{};
+std::atomic<std::uint64_t> droppedZones{};
+
+thread_local std::string currentThreadName;
+
+// Registers the buffer of a thread, and marks it for removal when the thread
+// ends. The buffer is kept alive until its remaining zones are collected.
+class ThreadBufferHandle {
+public:
+  ThreadBufferHandle() : m_buffer(std::make_shared<ThreadBuffer>()) {
+    auto &profiler{state()};
+    std::lock_guard const lock{profiler.mutex};
+    m_buffer->index = gsl::narrow<std::uint32_t>(profiler.threadNames.size());
+    profiler.threadNames.push_back(
+        currentThreadName.empty()
+            ? fmt::format("Thread {}", m_buffer->index)
+            : currentThreadName);
+    profiler.buffers.push_back(m_buffer);
+  }
+
+  ~ThreadBufferHandle() { m_buffer->exited.store(true); }
+
+  ThreadBufferHandle(ThreadBufferHandle const &) = delete;
+  ThreadBufferHandle(ThreadBufferHandle &&) = delete;
+  ThreadBufferHandle &operator=(ThreadBufferHandle const &) = delete;
+  ThreadBufferHandle &operator=(ThreadBufferHandle &&) = delete;
+
+  [[nodiscard]] ThreadBuffer &get() const noexcept { return *m_buffer; }
+
+private:
+  std::shared_ptr<ThreadBuffer> m_buffer;
+};
+
+thread_local std::unique_ptr<ThreadBufferHandle> currentBuffer;
+
+// Returns the buffer of the calling thread, creating it on first use
+ThreadBuffer &threadBuffer() {
+  if (!currentBuffer) {
+    currentBuffer = std::make_unique<ThreadBufferHandle>();
+  }
+  return currentBuffer->get();
+}
+
+ImU32 zoneColor(char const *name) {
+  auto const hash{std::hash<std::string_view>{}(name)};
+  auto const hue{gsl::narrow_cast<float>(hash % 360) / 360.0f};
+  return ImColor::HSV(hue, 0.45f, 0.85f);
+}
+} // namespace
+
+/**
+ * @brief Enables or disables the recording of zones.
+ *
+ * The profiler is disabled by default. It is enabled by abcg::Window when
+ * abcg::WindowSettings::showProfiler is set.
+ *
+ * @param enabled Whether zones are recorded.
+ */
+void abcg::Profiler::setEnabled(bool enabled) noexcept {
+  ::enabled.store(enabled, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Returns whether zones are recorded.
+ *
+ * @return True if the profiler is enabled.
+ */
+bool abcg::Profiler::isEnabled() noexcept {
+  return enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Sets the name of the calling thread, as shown in the timeline.
+ *
+ * Threads without a name are shown as "Thread <index>".
+ *
+ * @param name Name of the thread.
+ */
+void abcg::Profiler::setThreadName(std::string_view name) {
+  currentThreadName = name;
+  if (currentBuffer) {
+    auto &profiler{state()};
+    std::lock_guard const lock{profiler.mutex};
+    profiler.threadNames.at(currentBuffer->get().index) = name;
+  }
+}
+
+/**
+ * @brief Returns the name of a thread that recorded zones.
+ *
+ * @param threadIndex Value of abcg::ProfileZone::threadIndex.
+ *
+ * @return Name of the thread, or an empty string if the index is invalid.
+ */
+std::string abcg::Profiler::getThreadName(std::uint32_t threadIndex) {
+  auto &profiler{state()};
+  std::lock_guard const lock{profiler.mutex};
+  if (threadIndex >= profiler.threadNames.size())
+    return {};
+  return profiler.threadNames.at(threadIndex);
+}
+
+/**
+ * @brief Ends the current frame and starts a new one.
+ *
+ * The zones recorded by all threads since the last call are moved to the
+ * frame returned by abcg::Profiler::getLastFrame.
+ *
+ * @remark This is called by abcg::Application at the start of each iteration
+ * of the main loop.
+ */
+void abcg::Profiler::newFrame() {
+  auto const time{now()};
+  auto &profiler{state()};
+  std::lock_guard const lock{profiler.mutex};
+
+  auto &frame{profiler.lastFrame};
+  frame.start = profiler.frameStart == 0 ? time : profiler.frameStart;
+  frame.end = time;
+  frame.zones.clear();
+  profiler.frameStart = time;
+
+  std::erase_if(profiler.buffers, [&frame](auto const &buffer) {
+    // Read before draining, so that the last zones of an exited thread are
+    // collected before its buffer is removed
+    auto const exited{buffer->exited.load(std::memory_order_acquire)};
+    auto const head{buffer->head.load(std::memory_order_acquire)};
+    auto tail{buffer->tail.load(std::memory_order_relaxed)};
+    for (; tail != head; ++tail) {
+      frame.zones.push_back(buffer->zones.at(tail % ringCapacity));
+    }
+    buffer->tail.store(tail, std::memory_order_release);
+    return exited;
+  });
+}
+
+/**
+ * @brief Returns the zones collected by the last call to
+ * abcg::Profiler::newFrame.
+ *
+ * @return Reference to the last frame.
+ *
+ * @remark The frame is overwritten by the next call to
+ * abcg::Profiler::newFrame, and must only be accessed from the main thread.
+ */
+abcg::ProfileFrame const &abcg::Profiler::getLastFrame() noexcept {
+  return state().lastFrame;
+}
+
+/**
+ * @brief Returns the number of zones dropped because a thread recorded more
+ * zones in a frame than its ring buffer can hold.
+ *
+ * @return Number of dropped zones since the program started.
+ */
+std::uint64_t abcg::Profiler::getDroppedZoneCount() noexcept {
+  return droppedZones.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Shows a Dear ImGui window with the timeline of the last frame.
+ *
+ * Each thread that recorded zones is shown as a flame graph, with nested
+ * zones stacked below their parents. Hovering a zone shows its duration.
+ *
+ * @remark This must be called between `ImGui::NewFrame` and `ImGui::Render`,
+ * e.g., in abcg::OpenGLWindow::onPaintUI.
+ */
+void abcg::Profiler::showWindow() {
+  static ProfileFrame pausedFrame;
+  static bool paused{};
+
+  ImGui::SetNextWindowPos(ImVec2(190, 5), ImGuiCond_FirstUseEver);
+  ImGui::SetNextWindowSize(ImVec2(480, 200), ImGuiCond_FirstUseEver);
+  if (!ImGui::Begin("Profiler")) {
+    ImGui::End();
+    return;
+  }
+
+  if (ImGui::Checkbox("Pause", &paused) && paused) {
+    pausedFrame = getLastFrame();
+  }
+  auto const &frame{paused ? pausedFrame : getLastFrame()};
+  auto const duration{frame.end - frame.start};
+  ImGui::SameLine();
+  ImGui::Text("Frame %.2f ms, %zu zones", static_cast<double>(duration) * 1e-6,
+              frame.zones.size());
+  if (duration <= 0) {
+    ImGui::End();
+    return;
+  }
+
+  std::vector<std::uint32_t> threads;
+  for (auto const &zone : frame.zones) {
+    threads.push_back(zone.threadIndex);
+  }
+  std::ranges::sort(threads);
+  threads.erase(std::unique(threads.begin(), threads.end()), threads.end());
+
+  auto *const drawList{ImGui::GetWindowDrawList()};
+  auto const rowHeight{ImGui::GetTextLineHeight() + 2.0f};
+  auto const width{std::max(ImGui::GetContentRegionAvail().x, 1.0f)};
+  auto const scale{width / static_cast<float>(duration)};
+  auto const toX{[&](std::int64_t time) {
+    return std::clamp(static_cast<float>(time - frame.start) * scale, 0.0f,
+                      width);
+  }};
+
+  for (auto const thread : threads) {
+    ImGui::TextUnformatted(getThreadName(thread).c_str());
+
+    std::uint32_t maxDepth{};
+    for (auto const &zone : frame.zones) {
+      if (zone.threadIndex == thread) {
+        maxDepth = std::max(maxDepth, zone.depth);
+      }
+    }
+
+    auto const origin{ImGui::GetCursorScreenPos()};
+    for (auto const &zone : frame.zones) {
+      if (zone.threadIndex != thread)
+        continue;
+
+      auto const x0{origin.x + toX(zone.start)};
+      auto const x1{std::max(origin.x + toX(zone.end), x0 + 1.0f)};
+      auto const y0{origin.y + static_cast<float>(zone.depth) * rowHeight};
+      ImVec2 const min{x0, y0};
+      ImVec2 const max{x1, y0 + rowHeight - 1.0f};
+      drawList->AddRectFilled(min, max, zoneColor(zone.name));
+      ImVec4 const clipRect{x0, y0, x1 - 2.0f, max.y};
+      drawList->AddText(nullptr, 0.0f, ImVec2(x0 + 2.0f, y0 + 1.0f),
+                        IM_COL32_BLACK, zone.name, nullptr, 0.0f, &clipRect);
+
+      if (ImGui::IsMouseHoveringRect(min, max)) {
+        ImGui::SetTooltip("%s\n%.3f ms", zone.name,
+                          static_cast<double>(zone.end - zone.start) * 1e-6);
+      }
+    }
+    ImGui::Dummy(
+        ImVec2(width, static_cast<float>(maxDepth + 1) * rowHeight));
+  }
+
+  ImGui::End();
+}
+
+void abcg::Profiler::record(ProfileZone const &zone) noexcept {
+  auto &buffer{threadBuffer()};
+  auto const head{buffer.head.load(std::memory_order_relaxed)};
+  if (head - buffer.tail.load(std::memory_order_acquire) >= ringCapacity) {
+    droppedZones.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  auto &slot{buffer.zones.at(head % ringCapacity)};
+  slot = zone;
+  slot.threadIndex = buffer.index;
+  buffer.head.store(head + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Starts a zone if the profiler is enabled.
+ *
+ * @param name Name of the zone.
+ */
+abcg::ProfileScope::ProfileScope(char const *name) noexcept {
+  if (!Profiler::isEnabled())
+    return;
+
+  m_name = name;
+  ++threadBuffer().depth;
+  m_start = now();
+}
+
+/**
+ * @brief Ends the zone and records it.
+ */
+abcg::ProfileScope::~ProfileScope() {
+  if (m_name == nullptr)
+    return;
+
+  auto const end{now()};
+  auto const depth{--threadBuffer().depth};
+  Profiler::record({.name = m_name,
+                    .start = m_start,
+                    .end = end,
+                    .threadIndex = 0,
+                    .depth = depth});
+}
@@ -0,0 +1,152 @@
+/**
+ * @file abcgProfiler.hpp
+ * @brief Header file of abcg::Profiler and abcg::ProfileScope.
+ *
+ * Declaration of abcg::Profiler, abcg::ProfileScope, abcg::ProfileZone,
+ * abcg::ProfileFrame and the ABCG_PROFILE_SCOPE macro.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_PROFILER_HPP_
+#define ABCG_PROFILER_HPP_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Whether ABCG_PROFILE_SCOPE creates profiling zones.
+ *
+ * Define as 0 to remove all zones at compile time.
+ */
+#if !defined(ABCG_PROFILER)
+#define ABCG_PROFILER 1
+#endif
+
+#define ABCG_PROFILE_CONCAT_IMPL(a, b) a##b
+#define ABCG_PROFILE_CONCAT(a, b) ABCG_PROFILE_CONCAT_IMPL(a, b)
+
+/**
+ * @brief Profiles the enclosing scope as a zone with the given name.
+ *
+ * The name must be a string literal, or otherwise outlive the profiler.
+ *
+ * @code
+ * void Window::onPaint() {
+ *   ABCG_PROFILE_SCOPE("Draw terrain");
+ *   ...
+ * }
+ * @endcode
+ */
+#if ABCG_PROFILER
+#define ABCG_PROFILE_SCOPE(name)                                               \
+  abcg::ProfileScope const ABCG_PROFILE_CONCAT(abcgProfileScope, __LINE__) {   \
+    name                                                                       \
+  }
+#else
+#define ABCG_PROFILE_SCOPE(name) static_cast<void>(0)
+#endif
+
+namespace abcg {
+class Profiler;
+class ProfileScope;
+struct ProfileZone;
+struct ProfileFrame;
+} // namespace abcg
+
+/**
+ * @brief Time interval of a profiled scope.
+ */
+struct abcg::ProfileZone {
+  /** @brief Name given to ABCG_PROFILE_SCOPE. */
+  char const *name{};
+  /** @brief Start time, in nanoseconds of `std::chrono::steady_clock`. */
+  std::int64_t start{};
+  /** @brief End time, in nanoseconds of `std::chrono::steady_clock`. */
+  std::int64_t end{};
+  /** @brief Index of the thread that recorded the zone (see
+   * abcg::Profiler::getThreadName). */
+  std::uint32_t threadIndex{};
+  /** @brief Nesting level of the zone in its thread, starting at 0. */
+  std::uint32_t depth{};
+};
+
+/**
+ * @brief Zones collected in one iteration of the main loop.
+ */
+struct abcg::ProfileFrame {
+  /** @brief Start time, in nanoseconds of `std::chrono::steady_clock`. */
+  std::int64_t start{};
+  /** @brief End time, in nanoseconds of `std::chrono::steady_clock`. */
+  std::int64_t end{};
+  /** @brief Zones that ended during the frame, in no particular order. */
+  std::vector<ProfileZone> zones;
+};
+
+/**
+ * @brief Hierarchical CPU profiler.
+ *
+ * Zones are created with ABCG_PROFILE_SCOPE. When the profiler is enabled,
+ * each zone records its start and end times into a ring buffer owned by the
+ * calling thread, so that threads never contend with each other. At the
+ * start of each iteration of the main loop, abcg::Application calls
+ * abcg::Profiler::newFrame, which moves the zones of all threads into the
+ * frame returned by abcg::Profiler::getLastFrame.
+ *
+ * ABCg profiles its own main loop phases, such as event handling, the update
+ * and paint handlers, Dear ImGui and buffer swapping. The timeline of the last
+ * frame is shown by abcg::Profiler::showWindow when
+ * abcg::WindowSettings::showProfiler is set.
+ *
+ * @remark A disabled profiler costs an atomic load per zone.
+ */
+class abcg::Profiler {
+public:
+  Profiler() = delete;
+
+  static void setEnabled(bool enabled) noexcept;
+  [[nodiscard]] static bool isEnabled() noexcept;
+
+  static void setThreadName(std::string_view name);
+  [[nodiscard]] static std::string getThreadName(std::uint32_t threadIndex);
+
+  static void newFrame();
+  [[nodiscard]] static ProfileFrame const &getLastFrame() noexcept;
+  [[nodiscard]] static std::uint64_t getDroppedZoneCount() noexcept;
+
+  static void showWindow();
+
+private:
+  friend ProfileScope;
+
+  static void record(ProfileZone const &zone) noexcept;
+};
+
+/**
+ * @brief RAII object that records a profiling zone.
+ *
+ * Use the ABCG_PROFILE_SCOPE macro instead of creating objects of this type
+ * directly.
+ */
+class abcg::ProfileScope {
+public:
+  explicit ProfileScope(char const *name) noexcept;
+  ~ProfileScope();
+
+  ProfileScope(ProfileScope const &) = delete;
+  ProfileScope(ProfileScope &&) = delete;
+  ProfileScope &operator=(ProfileScope const &) = delete;
+  ProfileScope &operator=(ProfileScope &&) = delete;
+
+private:
+  // Null if the profiler was disabled when the scope was entered
+  char const *m_name{};
+  std::int64_t m_start{};
+};
+
+#endif
@@ -0,0 +1,138 @@
+/**
+ * @file abcgStartupProfiler.cpp
+ * @brief Definition of abcg::StartupProfiler members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgStartupProfiler.hpp"
+
+#include <algorithm>
+
+#include "abcgExternal.hpp"
+
+/**
+ * @brief Starts measuring a phase.
+ *
+ * @param profiler Profiler that records the phase. If `nullptr`, or if the
+ * profiler has already finished, nothing is recorded.
+ * @param name Name of the phase.
+ */
+abcg::StartupProfiler::Scope::Scope(StartupProfiler *profiler,
+                                    std::string_view name)
+    : m_profiler(profiler != nullptr && !profiler->isFinished() ? profiler
+                                                                : nullptr),
+      m_name(name) {
+  if (m_profiler != nullptr) {
+    m_start = m_profiler->m_timer.elapsed();
+    ++m_profiler->m_depth;
+  }
+}
+
+/**
+ * @brief Stops measuring the phase and records it, if not already ended.
+ */
+abcg::StartupProfiler::Scope::~Scope() { end(); }
+
+/**
+ * @brief Stops measuring the phase and records it.
+ *
+ * Subsequent calls have no effect.
+ */
+void abcg::StartupProfiler::Scope::end() {
+  if (m_profiler == nullptr)
+    return;
+
+  --m_profiler->m_depth;
+  m_profiler->m_phases.push_back(
+      {.name = std::move(m_name),
+       .start = m_start,
+       .duration = m_profiler->m_timer.elapsed() - m_start,
+       .depth = m_profiler->m_depth});
+  m_profiler = nullptr;
+}
+
+/**
+ * @brief Starts measuring a phase that ends when the returned object is
+ * destroyed.
+ *
+ * Phases can be nested.
+ *
+ * @param name Name of the phase.
+ *
+ * @return Scope object that records the phase on destruction.
+ */
+abcg::StartupProfiler::Scope
+abcg::StartupProfiler::measure(std::string_view name) {
+  return Scope{this, name};
+}
+
+/**
+ * @brief Marks the end of the startup.
+ *
+ * This is called by abcg::Application after the first frame is presented.
+ * Phases measured after this call are not recorded.
+ */
+void abcg::StartupProfiler::finish() {
+  if (!m_totalTime.has_value()) {
+    m_totalTime = m_timer.elapsed();
+  }
+}
+
+/**
+ * @brief Returns whether the startup has finished.
+ *
+ * @return True if abcg::StartupProfiler::finish has been called.
+ */
+bool abcg::StartupProfiler::isFinished() const noexcept {
+  return m_totalTime.has_value();
+}
+
+/**
+ * @brief Returns the recorded phases.
+ *
+ * @return Phases in the order they finished.
+ */
+std::vector<abcg::StartupPhase> const &
+abcg::StartupProfiler::getPhases() const noexcept {
+  return m_phases;
+}
+
+/**
+ * @brief Returns the total startup time.
+ *
+ * @return Time in seconds from the construction of the profiler to the call
+ * to abcg::StartupProfiler::finish, or zero if the startup has not finished.
+ */
+double abcg::StartupProfiler::getTotalTime() const noexcept {
+  return m_totalTime.value_or(0.0);
+}
+
+/**
+ * @brief Writes the startup report.
+ *
+ * Phases are listed in the order they started, indented by nesting level,
+ * with their start time and duration in milliseconds.
+ *
+ * @param file Output stream.
+ */
+void abcg::StartupProfiler::writeReport(std::FILE *file) const {
+  auto phases{m_phases};
+  std::stable_sort(phases.begin(), phases.end(),
+                   [](auto const &lhs, auto const &rhs) {
+                     return lhs.start < rhs.start ||
+                            (lhs.start == rhs.start && lhs.depth < rhs.depth);
+                   });
+
+  fmt::print(file, "Startup report (ms)\n");
+  fmt::print(file, "{:>10} {:>10}  phase\n", "start", "duration");
+  for (auto const &phase : phases) {
+    fmt::print(file, "{:10.2f} {:10.2f}  {:{}}{}\n", phase.start * 1000.0,
+               phase.duration * 1000.0, "", phase.depth * 2, phase.name);
+  }
+  fmt::print(file, "{:>10} {:10.2f}  time to first frame\n", "",
+             getTotalTime() * 1000.0);
+}
@@ -0,0 +1,94 @@
+/**
+ * @file abcgStartupProfiler.hpp
+ * @brief Header file of abcg::StartupProfiler.
+ *
+ * Declaration of abcg::StartupProfiler and related types.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_STARTUP_PROFILER_HPP_
+#define ABCG_STARTUP_PROFILER_HPP_
+
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "abcgTimer.hpp"
+
+namespace abcg {
+class StartupProfiler;
+struct StartupPhase;
+} // namespace abcg
+
+/**
+ * @brief Time spent in a phase of the application startup.
+ */
+struct abcg::StartupPhase {
+  /** @brief Name of the phase. */
+  std::string name;
+  /** @brief Time in seconds from the start of the profiler to the start of
+   * the phase. */
+  double start{};
+  /** @brief Duration of the phase in seconds. */
+  double duration{};
+  /** @brief Number of phases enclosing this phase. */
+  int depth{};
+};
+
+/**
+ * @brief Records the time spent in each phase of the application startup,
+ * up to the first presented frame.
+ *
+ * An instance is owned by abcg::Application. The report is printed when the
+ * application is run with the `--startup-report` command-line argument, or
+ * written to a file with `--startup-report=<path>`.
+ *
+ * @sa abcg::Window::measureStartupPhase.
+ */
+class abcg::StartupProfiler {
+public:
+  /**
+   * @brief Measures a phase from its construction to its destruction, or to
+   * the call to abcg::StartupProfiler::Scope::end.
+   */
+  class Scope {
+  public:
+    Scope(StartupProfiler *profiler, std::string_view name);
+    ~Scope();
+
+    void end();
+
+    Scope(Scope const &) = delete;
+    Scope(Scope &&) = delete;
+    Scope &operator=(Scope const &) = delete;
+    Scope &operator=(Scope &&) = delete;
+
+  private:
+    StartupProfiler *m_profiler{};
+    std::string m_name;
+    double m_start{};
+  };
+
+  [[nodiscard]] Scope measure(std::string_view name);
+  void finish();
+
+  [[nodiscard]] bool isFinished() const noexcept;
+  [[nodiscard]] std::vector<StartupPhase> const &getPhases() const noexcept;
+  [[nodiscard]] double getTotalTime() const noexcept;
+
+  void writeReport(std::FILE *file) const;
+
+private:
+  Timer m_timer;
+  std::vector<StartupPhase> m_phases;
+  int m_depth{};
+  std::optional<double> m_totalTime;
+};
+
+#endif
@@ -0,0 +1,308 @@
+/**
+ * @file abcgTrace.cpp
+ * @brief Definition of abcg::Trace members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#include "abcgTrace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "abcgExternal.hpp"
+#include "abcgLog.hpp"
+#include "abcgProfiler.hpp"
+
+namespace {
+// Process IDs of the CPU and GPU timelines
+constexpr std::uint32_t cpuProcess{1};
+constexpr std::uint32_t gpuProcess{2};
+
+struct TraceEvent {
+  std::string name;
+  char const *category{};
+  // 'X' for complete events, 'i' for instant events
+  char phase{};
+  std::int64_t start{};
+  std::int64_t duration{};
+  std::uint32_t process{};
+  std::uint32_t thread{};
+};
+
+struct TraceState {
+  std::mutex mutex;
+  std::string path;
+  std::vector<TraceEvent> events;
+  std::int64_t start{};
+  int frameLimit{};
+  int frameCount{};
+  bool profilerWasEnabled{};
+};
+
+TraceState &state() {
+  static TraceState instance;
+  return instance;
+}
+
+std::atomic<bool> capturing{};
+
+std::int64_t now() noexcept {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void writeJSONString(std::FILE *file, std::string_view string) {
+  std::fputc('"', file);
+  for (auto const character : string) {
+    switch (character) {
+    case '"':
+      std::fputs("\\\"", file);
+      break;
+    case '\\':
+      std::fputs("\\\\", file);
+      break;
+    case '\n':
+      std::fputs("\\n", file);
+      break;
+    default:
+      if (static_cast<unsigned char>(character) < 0x20) {
+        fmt::print(file, "\\u{:04x}", static_cast<int>(character));
+      } else {
+        std::fputc(character, file);
+      }
+    }
+  }
+  std::fputc('"', file);
+}
+
+// Writes a metadata event that names a process or a thread
+void writeMetadata(std::FILE *file, std::string_view type,
+                   std::uint32_t process, std::uint32_t thread,
+                   std::string_view name) {
+  fmt::print(file,
+             "{{\"name\":\"{}\",\"ph\":\"M\",\"pid\":{},\"tid\":{},"
+             "\"args\":{{\"name\":",
+             type, process, thread);
+  writeJSONString(file, name);
+  fmt::print(file, "}}}}");
+}
+
+// Writes the events in the JSON object format of the Chrome Trace Event
+// specification. Timestamps are in microseconds since the capture started.
+bool writeTrace(TraceState const &trace) {
+  std::unique_ptr<std::FILE, decltype(&std::fclose)> const file{
+      std::fopen(trace.path.c_str(), "w"), &std::fclose};
+  if (!file)
+    return false;
+
+  fmt::print(file.get(), "{{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+  // Every event after the first is preceded by a separator
+  writeMetadata(file.get(), "process_name", cpuProcess, 0, "CPU");
+  fmt::print(file.get(), ",\n");
+  writeMetadata(file.get(), "process_name", gpuProcess, 0, "GPU");
+  std::vector<std::uint32_t> threads;
+  for (auto const &event : trace.events) {
+    if (event.process == cpuProcess && event.phase == 'X') {
+      threads.push_back(event.thread);
+    }
+  }
+  std::ranges::sort(threads);
+  threads.erase(std::unique(threads.begin(), threads.end()), threads.end());
+  for (auto const thread : threads) {
+    fmt::print(file.get(), ",\n");
+    writeMetadata(file.get(), "thread_name", cpuProcess, thread,
+                  abcg::Profiler::getThreadName(thread));
+  }
+
+  for (auto const &event : trace.events) {
+    fmt::print(file.get(), ",\n{{\"name\":");
+    writeJSONString(file.get(), event.name);
+    fmt::print(file.get(),
+               ",\"cat\":\"{}\",\"ph\":\"{}\",\"ts\":{:.3f},\"pid\":{},"
+               "\"tid\":{}",
+               event.category, event.phase,
+               static_cast<double>(event.start - trace.start) * 1e-3,
+               event.process, event.thread);
+    if (event.phase == 'X') {
+      fmt::print(file.get(), ",\"dur\":{:.3f}",
+                 static_cast<double>(event.duration) * 1e-3);
+    } else {
+      fmt::print(file.get(), ",\"s\":\"{}\"",
+                 event.category == std::string_view{"frame"} ? 'g' : 'p');
+    }
+    fmt::print(file.get(), "}}");
+  }
+  fmt::print(file.get(), "\n]}}\n");
+
+  return std::ferror(file.get()) == 0;
+}
+} // namespace
+
+/**
+ * @brief Starts a capture.
+ *
+ * Does nothing if a capture is already running.
+ *
+ * @param path Path of the JSON file to be written when the capture stops.
+ * @param frames Number of iterations of the main loop after which the
+ * capture stops automatically. If non-positive, the capture runs until
+ * abcg::Trace::stop is called.
+ */
+void abcg::Trace::start(std::string_view path, int frames) {
+  auto &trace{state()};
+  {
+    std::lock_guard const lock{trace.mutex};
+    if (capturing.load())
+      return;
+
+    trace.path = path;
+    trace.events.clear();
+    trace.start = now();
+    trace.frameLimit = frames;
+    trace.frameCount = 0;
+    trace.profilerWasEnabled = Profiler::isEnabled();
+    capturing.store(true);
+  }
+  Profiler::setEnabled(true);
+
+  abcg::Log::info("Trace capture started");
+}
+
+/**
+ * @brief Stops the capture and writes the trace file.
+ *
+ * Does nothing if no capture is running. Failing to write the file is
+ * reported as a warning.
+ */
+void abcg::Trace::stop() {
+  auto &trace{state()};
+  std::lock_guard const lock{trace.mutex};
+  if (!capturing.exchange(false))
+    return;
+
+  Profiler::setEnabled(trace.profilerWasEnabled);
+
+  if (writeTrace(trace)) {
+    abcg::Log::info("Trace with {} events written to {}", trace.events.size(),
+                    trace.path);
+  } else {
+    abcg::Log::warning("Failed to write trace file {}", trace.path);
+  }
+  trace.events.clear();
+  trace.events.shrink_to_fit();
+}
+
+/**
+ * @brief Returns whether a capture is running.
+ *
+ * @return True between calls to abcg::Trace::start and abcg::Trace::stop.
+ */
+bool abcg::Trace::isCapturing() noexcept { return capturing.load(); }
+
+/**
+ * @brief Adds the zones collected by abcg::Profiler::newFrame to the capture.
+ *
+ * Stops the capture if the number of frames given to abcg::Trace::start is
+ * reached.
+ *
+ * @remark This is called by abcg::Application after abcg::Profiler::newFrame.
+ */
+void abcg::Trace::newFrame() {
+  if (!capturing.load(std::memory_order_relaxed))
+    return;
+
+  auto &trace{state()};
+  bool finished{};
+  {
+    std::lock_guard const lock{trace.mutex};
+    auto const &frame{Profiler::getLastFrame()};
+    for (auto const &zone : frame.zones) {
+      // Skip zones that started before the capture
+      if (zone.start < trace.start)
+        continue;
+      trace.events.push_back({.name = zone.name,
+                              .category = "cpu",
+                              .phase = 'X',
+                              .start = zone.start,
+                              .duration = zone.end - zone.start,
+                              .process = cpuProcess,
+                              .thread = zone.threadIndex});
+    }
+    trace.events.push_back({.name = fmt::format("Frame {}", trace.frameCount),
+                            .category = "frame",
+                            .phase = 'i',
+                            .start = frame.end,
+                            .duration = 0,
+                            .process = cpuProcess,
+                            .thread = 0});
+    ++trace.frameCount;
+    finished = trace.frameLimit > 0 && trace.frameCount >= trace.frameLimit;
+  }
+
+  if (finished) {
+    stop();
+  }
+}
+
+/**
+ * @brief Adds an instant event to the capture.
+ *
+ * Does nothing if no capture is running. This function is thread-safe.
+ *
+ * @param name Description of the event.
+ */
+void abcg::Trace::addEvent(std::string_view name) {
+  if (!capturing.load(std::memory_order_relaxed))
+    return;
+
+  auto const time{now()};
+  auto &trace{state()};
+  std::lock_guard const lock{trace.mutex};
+  trace.events.push_back({.name = std::string{name},
+                          .category = "resource",
+                          .phase = 'i',
+                          .start = time,
+                          .duration = 0,
+                          .process = cpuProcess,
+                          .thread = 0});
+}
+
+/**
+ * @brief Adds a GPU zone to the capture.
+ *
+ * Does nothing if no capture is running.
+ *
+ * @param name Name of the zone.
+ * @param start Start time, in nanoseconds of `std::chrono::steady_clock`.
+ * @param end End time, in nanoseconds of `std::chrono::steady_clock`.
+ *
+ * @sa abcg::OpenGLGpuTimerResult.
+ */
+void abcg::Trace::addGpuZone(std::string_view name, std::int64_t start,
+                             std::int64_t end) {
+  if (!capturing.load(std::memory_order_relaxed))
+    return;
+
+  auto &trace{state()};
+  std::lock_guard const lock{trace.mutex};
+  if (start < trace.start)
+    return;
+  trace.events.push_back({.name = std::string{name},
+                          .category = "gpu",
+                          .phase = 'X',
+                          .start = start,
+                          .duration = end - start,
+                          .process = gpuProcess,
+                          .thread = 0});
+}
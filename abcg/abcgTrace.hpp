@@ -0,0 +1,73 @@
+/**
+ * @file abcgTrace.hpp
+ * @brief Header file of abcg::Trace.
+ *
+ * Declaration of abcg::Trace and abcg::TraceSettings.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_TRACE_HPP_
+#define ABCG_TRACE_HPP_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace abcg {
+class Trace;
+struct TraceSettings;
+} // namespace abcg
+
+/**
+ * @brief Configuration settings of a trace capture started from the command
+ * line.
+ *
+ * @sa abcg::Application::Application for the command-line arguments.
+ */
+struct abcg::TraceSettings {
+  /** @brief Path of the JSON file to be written. */
+  std::string path{"trace.json"};
+  /** @brief Number of iterations of the main loop to capture. */
+  int frames{300};
+};
+
+/**
+ * @brief Captures timelines in the Chrome Trace Event format.
+ *
+ * While a capture is running, the trace collects:
+ *
+ * - The CPU zones of all threads recorded by abcg::Profiler, which is
+ *   enabled for the duration of the capture;
+ * - The GPU times measured by abcg::OpenGLGpuTimer, shown as a separate
+ *   "GPU" process;
+ * - Resource events, such as shader compilations, texture loads and render
+ *   target (re)creations (see abcg::HitchDetector::addNote), and the start of
+ *   each frame, shown as instant events.
+ *
+ * When the capture stops, the events are written to a JSON file that can be
+ * opened in `chrome://tracing` or in the Perfetto UI
+ * (https://ui.perfetto.dev).
+ *
+ * A capture is toggled by pressing F9, in which case the file is written to
+ * abcg::WindowSettings::tracePath, or started at launch for a number of
+ * frames with the `--trace` and `--trace-frames` command-line arguments.
+ */
+class abcg::Trace {
+public:
+  Trace() = delete;
+
+  static void start(std::string_view path, int frames = 0);
+  static void stop();
+  [[nodiscard]] static bool isCapturing() noexcept;
+
+  static void newFrame();
+  static void addEvent(std::string_view name);
+  static void addGpuZone(std::string_view name, std::int64_t start,
+                         std::int64_t end);
+};
+
+#endif
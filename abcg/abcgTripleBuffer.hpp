@@ -0,0 +1,113 @@
+/**
+ * @file abcgTripleBuffer.hpp
+ * @brief Header file of abcg::TripleBuffer.
+ *
+ * Declaration and definition of abcg::TripleBuffer.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * @copyright (c) 2021--2023 Harlen Batagelo. All rights reserved.
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_TRIPLE_BUFFER_HPP_
+#define ABCG_TRIPLE_BUFFER_HPP_
+
+#include <array>
+#include <cstddef>
+#include <mutex>
+
+namespace abcg {
+template <typename T> class TripleBuffer;
+} // namespace abcg
+
+/**
+ * @brief Triple buffer that hands simulation state from an update thread to
+ * the render thread.
+ *
+ * The buffer has three slots: the states of the last two published ticks
+ * (previous and current), which the render thread reads to interpolate
+ * between them, and the state that the update thread writes to. Publishing a
+ * tick rotates the slots instead of copying the states, except for
+ * initializing the next write state from the current one.
+ *
+ * Typical usage with abcg::WindowSettings::threadedUpdate:
+ *
+ * @code
+ * // In onUpdate (update thread)
+ * auto &state{m_state.write()};
+ * state.position += state.velocity * gsl::narrow_cast<float>(getDeltaTime());
+ * m_state.publish();
+ *
+ * // In onPaint (main thread)
+ * m_state.read([&](State const &previous, State const &current) {
+ *   auto const alpha{getInterpolationAlpha()};
+ *   auto const position{glm::mix(previous.position, current.position, alpha)};
+ *   // ...
+ * });
+ * @endcode
+ *
+ * @tparam T Type of the state. Must be copy-assignable.
+ */
+template <typename T> class abcg::TripleBuffer {
+public:
+  /**
+   * @brief Constructs a buffer with all states set to a given value.
+   *
+   * @param initial Initial state.
+   */
+  explicit TripleBuffer(T const &initial = T{})
+      : m_states{initial, initial, initial} {}
+
+  /**
+   * @brief Returns the state being written by the current tick.
+   *
+   * This must only be called from the thread that calls
+   * abcg::TripleBuffer::publish.
+   *
+   * @return Reference to the write state, initialized with the last published
+   * state.
+   */
+  [[nodiscard]] T &write() noexcept { return m_states.at(m_write); }
+
+  /**
+   * @brief Publishes the write state as the current state.
+   *
+   * The old current state becomes the previous state.
+   */
+  void publish() {
+    {
+      std::lock_guard const lock{m_mutex};
+      auto const oldPrevious{m_previous};
+      m_previous = m_current;
+      m_current = m_write;
+      m_write = oldPrevious;
+    }
+    // The reader never accesses the write state, and concurrent reads of the
+    // current state are safe
+    m_states.at(m_write) = m_states.at(m_current);
+  }
+
+  /**
+   * @brief Calls a function with the previous and current states.
+   *
+   * The states are not modified while the function runs. Publishing is
+   * blocked in the meantime, so the function should be short.
+   *
+   * @param function Function to be called with the previous and current
+   * states as `T const &` arguments.
+   */
+  template <typename TFun> void read(TFun &&function) const {
+    std::lock_guard const lock{m_mutex};
+    function(m_states.at(m_previous), m_states.at(m_current));
+  }
+
+private:
+  std::array<T, 3> m_states;
+  std::size_t m_previous{0};
+  std::size_t m_current{1};
+  std::size_t m_write{2};
+  mutable std::mutex m_mutex;
+};
+
+#endif
@@ -15,6 +15,15 @@
 #include <set>
 
 #include "abcgException.hpp"
+#include "abcgGpuMemory.hpp"
+
+namespace {
+std::uint64_t getHandle(vk::Buffer buffer) noexcept {
+  // VkBuffer is a pointer on 64-bit platforms and a 64-bit integer elsewhere
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  return reinterpret_cast<std::uint64_t>(static_cast<VkBuffer>(buffer));
+}
+} // namespace
 
 void abcg::VulkanBuffer::create(VulkanDevice const &device,
                                 VulkanBufferCreateInfo const &createInfo) {
@@ -58,12 +67,15 @@ void abcg::VulkanBuffer::create(VulkanDevice const &device,
         vk::QueueFlagBits::eTransfer);
 
     // Release staging buffer
+    abcg::GpuMemory::untrack(abcg::GpuResourceKind::Buffer,
+                             getHandle(stagingBuffer));
     m_device.destroyBuffer(stagingBuffer);
     m_device.freeMemory(stagingBufferMemory);
   }
 }
 
 void abcg::VulkanBuffer::destroy() {
+  abcg::GpuMemory::untrack(abcg::GpuResourceKind::Buffer, getHandle(m_buffer));
   m_device.destroyBuffer(m_buffer);
   m_device.freeMemory(m_deviceMemory);
 }
@@ -127,6 +139,11 @@ std::pair<vk::Buffer, vk::DeviceMemory> abcg::VulkanBuffer::createBuffer(
   // Associate buffer memory to buffer
   m_device.bindBufferMemory(buffer, bufferMemory, 0);
 
+  abcg::GpuMemory::track({.kind = abcg::GpuResourceKind::Buffer,
+                          .handle = getHandle(buffer),
+                          .bytes = memoryRequirements.size,
+                          .format = vk::to_string(usage)});
+
   return {buffer, bufferMemory};
 }
 
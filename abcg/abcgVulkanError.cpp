@@ -12,6 +12,8 @@
 
 #include <fmt/core.h>
 
+#include "abcgLog.hpp"
+
 #if !defined(NDEBUG)
 
 void abcg::checkVkResult(VkResult retCode,
@@ -73,7 +75,7 @@ void abcg::checkVkResult(VkResult retCode,
     break;
   }
 
-  fmt::print("{}: {}.\n", toYellowString("INFO"), result);
+  abcg::Log::info("{}.", result);
 }
 
 /**
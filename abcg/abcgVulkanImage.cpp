@@ -17,12 +17,26 @@
 #include <gsl/gsl>
 
 #include "abcgException.hpp"
+#include "abcgGpuMemory.hpp"
+#include "abcgHitchDetector.hpp"
+#include "abcgImage.hpp"
+#include "abcgMetrics.hpp"
+
+namespace {
+std::uint64_t getHandle(vk::Image image) noexcept {
+  // VkImage is a pointer on 64-bit platforms and a 64-bit integer elsewhere
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  return reinterpret_cast<std::uint64_t>(static_cast<VkImage>(image));
+}
+} // namespace
 
 void abcg::VulkanImage::create(VulkanDevice const &device,
                                std::string_view path, bool generateMipmaps) {
   m_device = static_cast<vk::Device>(device);
 
   // Load the bitmap
+  abcg::HitchDetector::addNote(fmt::format("Texture loaded: {}", path));
+  abcg::initSDLImage();
   if (SDL_Surface *const surface{IMG_Load(path.data())}) {
     // Enforce RGBA
     SDL_Surface *formattedSurface{
@@ -48,6 +62,7 @@ void abcg::VulkanImage::create(VulkanDevice const &device,
                  .properties = vk::MemoryPropertyFlagBits::eHostVisible |
                                vk::MemoryPropertyFlagBits::eHostCoherent,
                  .data = formattedSurface->pixels});
+    abcg::Metrics::counter("abcg.texture_bytes_uploaded").add(imageSize);
 
     SDL_FreeSurface(formattedSurface);
 
@@ -151,6 +166,7 @@ void abcg::VulkanImage::create(VulkanDevice const &device,
                              .imageView = m_imageView,
                              .imageLayout =
                                  vk::ImageLayout::eShaderReadOnlyOptimal};
+    abcg::Metrics::counter("abcg.textures_loaded").add();
   } else {
     throw abcg::RuntimeError(
         fmt::format("Failed to load texture file {}", path));
@@ -183,6 +199,8 @@ void abcg::VulkanImage::destroy() {
     m_device.destroyImageView(m_imageView);
   }
   if (m_image) {
+    abcg::GpuMemory::untrack(abcg::GpuResourceKind::Texture,
+                             getHandle(m_image));
     m_device.destroyImage(m_image);
   }
   if (m_deviceMemory) {
@@ -264,6 +282,12 @@ abcg::VulkanImage::createImage(VulkanDevice const &device,
   // Associate image memory to image
   m_device.bindImageMemory(image, imageMemory, 0);
 
+  abcg::GpuMemory::track({.kind = abcg::GpuResourceKind::Texture,
+                          .handle = getHandle(image),
+                          .bytes = memoryRequirements.size,
+                          .format = vk::to_string(imageInfo.format),
+                          .mipLevels = imageInfo.mipLevels});
+
   return {image, imageMemory};
 }
 
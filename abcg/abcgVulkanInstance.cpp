@@ -14,6 +14,7 @@
 
 #include "abcgApplication.hpp"
 #include "abcgException.hpp"
+#include "abcgLog.hpp"
 #include "abcgVulkan.hpp"
 
 #if defined(ABCG_VULKAN_DEBUG_REPORT)
@@ -25,7 +26,7 @@ debugReportCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
                     VkDebugUtilsMessengerCallbackDataEXT const *pCallbackData,
                     [[maybe_unused]] void *pUserData) {
 
-  std::string messageTypeName{};
+  std::string_view messageTypeName{};
   switch (messageType) {
   case VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT:
     messageTypeName = "general";
@@ -40,32 +41,25 @@ debugReportCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
     break;
   }
 
-  std::function applyColor{
-      [](std::string_view str) { return std::string{str}; }};
-  std::string messageSeverityName{};
+  // This can be called many times per frame, so messages are logged
+  // asynchronously
   switch (messageSeverity) {
   case VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT:
-    messageSeverityName = "verbose";
+    abcg::Log::debug("[vulkan {}] {}", messageTypeName,
+                     pCallbackData->pMessage);
     break;
   case VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT:
-    messageSeverityName = "info";
-    applyColor = [](std::string_view str) { return abcg::toBlueString(str); };
+    abcg::Log::info("[vulkan {}] {}", messageTypeName, pCallbackData->pMessage);
     break;
   case VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT:
-    messageSeverityName = "warning";
-    applyColor = [](std::string_view str) { return abcg::toYellowString(str); };
-    break;
-  case VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT:
-    messageSeverityName = "error";
-    applyColor = [](std::string_view str) { return abcg::toRedString(str); };
+    abcg::Log::warning("[vulkan {}] {}", messageTypeName,
+                       pCallbackData->pMessage);
     break;
   default:
+    abcg::Log::error("[vulkan {}] {}", messageTypeName,
+                     pCallbackData->pMessage);
     break;
   }
-  auto messageHeader{
-      fmt::format("[vulkan {} {}]:", messageTypeName, messageSeverityName)};
-  fmt::print(stderr, "{} {}\n", applyColor(messageHeader),
-             pCallbackData->pMessage);
   return VK_FALSE;
 }
 
@@ -10,6 +10,9 @@
 
 #include "abcgVulkanShader.hpp"
 #include "abcgException.hpp"
+#include "abcgHitchDetector.hpp"
+#include "abcgLog.hpp"
+#include "abcgMetrics.hpp"
 
 #include <glslang/SPIRV/GlslangToSpv.h>
 
@@ -259,11 +262,13 @@ std::vector<uint32_t> GLSLtoSPV(abcg::ShaderSource shaderSource) {
   // Prints out log info for compiling and linking
   auto printLog{[](glslang::TShader &shader, std::string_view name) {
     if (std::string const log{shader.getInfoLog()}; !log.empty()) {
-      fmt::print("Shader information log ({} shader):\n{}\n", name, log);
+      abcg::Log::error("Shader information log ({} shader):\n{}", name, log);
     }
     if (std::string const log{shader.getInfoDebugLog()}; !log.empty()) {
-      fmt::print("Shader information debug log ({} shader):\n{}\n", name, log);
+      abcg::Log::error("Shader information debug log ({} shader):\n{}", name,
+                       log);
     }
+    abcg::Log::flush();
   }};
 
   auto const *data{shaderSource.source.data()};
@@ -315,6 +320,7 @@ void abcg::VulkanShader::create(VulkanDevice const &device,
                                 ShaderSource const &pathOrSource) {
   m_device = static_cast<vk::Device>(device);
 
+  abcg::HitchDetector::addNote("Shader compiled to SPIR-V");
   ShaderSource const source{.source = toSource(pathOrSource.source),
                             .stage = pathOrSource.stage};
 
@@ -325,6 +331,7 @@ void abcg::VulkanShader::create(VulkanDevice const &device,
 
   m_module = m_device.createShaderModule(
       {.codeSize = shader.size() * sizeof(uint32_t), .pCode = shader.data()});
+  abcg::Metrics::counter("abcg.programs_linked").add();
 }
 
 /**
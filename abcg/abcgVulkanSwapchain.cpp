@@ -15,6 +15,9 @@
 #include <imgui_impl_vulkan.h>
 
 #include "abcgException.hpp"
+#include "abcgHitchDetector.hpp"
+#include "abcgMetrics.hpp"
+#include "abcgProfiler.hpp"
 #include "abcgVulkanDevice.hpp"
 #include "abcgVulkanPhysicalDevice.hpp"
 #include "abcgVulkanWindow.hpp"
@@ -128,6 +131,7 @@ void abcg::VulkanSwapchain::destroy() {
 
 void abcg::VulkanSwapchain::render(
     std::function<void(VulkanFrame const &)> const &fun) {
+  ABCG_PROFILE_SCOPE("VulkanSwapchain::render");
   auto const &device{static_cast<vk::Device>(m_device)};
 
   // Get current set of semaphores
@@ -205,6 +209,8 @@ void abcg::VulkanSwapchain::present() {
   if (m_swapChainRebuild)
     return;
 
+  ABCG_PROFILE_SCOPE("VulkanSwapchain::present");
+
   // Set semaphores to wait
   auto &frameSemaphore{m_frameSemaphores.at(m_currentSemaphore)};
   std::array waitSemaphores{frameSemaphore.renderComplete};
@@ -240,6 +246,10 @@ bool abcg::VulkanSwapchain::checkRebuild(VulkanSettings const &settings,
   if (!m_swapChainRebuild)
     return false;
 
+  abcg::HitchDetector::addNote(fmt::format(
+      "Swapchain rebuilt ({}x{})", windowSize.x, windowSize.y));
+  abcg::Metrics::counter("abcg.swapchain_rebuilds").add();
+
   auto const &device{static_cast<vk::Device>(m_device)};
 
   auto oldSwapchain{m_swapchainKHR};
@@ -18,6 +18,7 @@
 
 #include "abcgEmbeddedFonts.hpp"
 #include "abcgException.hpp"
+#include "abcgGpuMemory.hpp"
 #include "abcgVulkanError.hpp"
 #include "abcgVulkanInstance.hpp"
 #include "abcgWindow.hpp"
@@ -155,38 +156,42 @@ void abcg::VulkanWindow::onPaint([[maybe_unused]] VulkanFrame const &frame) {}
  * This is not called when the window is minimized.
  *
  * Override it for custom behavior. By default, it shows a FPS counter if
- * abcg::WindowSettings::showFPS is set to `true`, and a toggle fullscreen
+ * abcg::WindowSettings::showFPS is set to `true`, the profiler timeline if
+ * abcg::WindowSettings::showProfiler is set to `true`, and a toggle fullscreen
  * button if abcg::WindowSettings::showFullscreenButton is set to `true`.
  */
 void abcg::VulkanWindow::onPaintUI() {
   // FPS counter
   if (abcg::Window::getWindowSettings().showFPS) {
-    auto fps{ImGui::GetIO().Framerate};
-
-    static auto offset{0UL};
-    static auto refreshTime{ImGui::GetTime()};
-    static std::array<float, 150> frames{};
-
-    while (refreshTime < ImGui::GetTime()) {
-      auto const refreshFrequency{60.0};
-      frames.at(offset) = fps;
-      offset = (offset + 1) % frames.size();
-      refreshTime += (1.0 / refreshFrequency);
-    }
-
     ImGui::SetNextWindowPos(ImVec2(5, 5));
     ImGui::Begin("FPS", nullptr,
                  ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoInputs |
                      ImGuiWindowFlags_NoBringToFrontOnFocus |
-                     ImGuiWindowFlags_NoFocusOnAppearing);
-    auto const label{fmt::format("avg {:.1f} FPS", fps)};
-    ImGui::PlotLines("", frames.data(), gsl::narrow<int>(frames.size()),
-                     gsl::narrow<int>(offset), label.c_str(), 0.0f,
-                     *std::ranges::max_element(frames) * 2,
-                     ImVec2(gsl::narrow<float>(frames.size()), 50));
+                     ImGuiWindowFlags_NoFocusOnAppearing |
+                     ImGuiWindowFlags_AlwaysAutoResize);
+    abcg::Window::getFrameStatistics().showPlots();
+    if (auto const latency{abcg::Window::getInputLatency()}; latency > 0.0) {
+      ImGui::Text("input latency %.1f ms", latency * 1000.0);
+    }
+    if constexpr (abcg::AllocationTracker::isEnabled()) {
+      auto const allocations{abcg::AllocationTracker::getLastFrameStats()};
+      ImGui::Text("heap %llu allocs, %.1f KiB",
+                  static_cast<unsigned long long>(allocations.allocations),
+                  static_cast<double>(allocations.bytes) / 1024.0);
+    }
+    constexpr double mebibyte{1024.0 * 1024.0};
+    ImGui::Text(
+        "VRAM %.1f MiB, peak %.1f MiB",
+        static_cast<double>(abcg::GpuMemory::getLiveBytes()) / mebibyte,
+        static_cast<double>(abcg::GpuMemory::getPeakBytes()) / mebibyte);
     ImGui::End();
   }
 
+  // Profiler timeline
+  if (abcg::Window::getWindowSettings().showProfiler) {
+    abcg::Profiler::showWindow();
+  }
+
   // Fullscreen button
   if (abcg::Window::getWindowSettings().showFullscreenButton) {
     auto const windowSize{getWindowSize()};
@@ -267,6 +272,7 @@ void abcg::VulkanWindow::handleEvent(SDL_Event const &event) {
 }
 
 void abcg::VulkanWindow::create() {
+  auto devicePhase{measureStartupPhase("SDL window and Vulkan device")};
   // Create window fol Vulkan graphics
   if (!createSDLWindow(SDL_WINDOW_VULKAN)) {
     throw abcg::SDLError("SDL_CreateWindow failed");
@@ -327,14 +333,20 @@ void abcg::VulkanWindow::create() {
        .poolSizeCount = gsl::narrow<uint32_t>(poolSizes.size()),
        .pPoolSizes = poolSizes.data()});
 
+  devicePhase.end();
+
+  auto imGuiPhase{measureStartupPhase("Dear ImGui")};
   // Setup Dear ImGui context
   IMGUI_CHECKVERSION();
   ImGui::CreateContext();
   ImGuiIO &guiIO{ImGui::GetIO()};
   // Enable keyboard controls
   guiIO.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
-  // Enable gamepad controls
-  guiIO.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;
+  // Enable gamepad controls if game controllers are available. Otherwise,
+  // they are enabled by abcg::Application::initSubsystems.
+  if (SDL_WasInit(SDL_INIT_GAMECONTROLLER) != 0U) {
+    guiIO.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;
+  }
 
   // Disable ini files
   guiIO.IniFilename = nullptr;
@@ -392,15 +404,19 @@ void abcg::VulkanWindow::create() {
 
     ImGui_ImplVulkan_DestroyFontUploadObjects();
   }
+  imGuiPhase.end();
 
-  onCreate();
+  {
+    auto const phase{measureStartupPhase("onCreate")};
+    onCreate();
+  }
 
   onResize();
 }
 
-void abcg::VulkanWindow::paint() {
-  onUpdate();
+void abcg::VulkanWindow::update() { onUpdate(); }
 
+void abcg::VulkanWindow::paint() {
   if (m_hidden || m_minimized)
     return;
 
@@ -411,16 +427,34 @@ void abcg::VulkanWindow::paint() {
   // ImGUI requires at least 2 images in the swapchain
   ImGui_ImplVulkan_SetMinImageCount(2);
 
-  ImGui_ImplVulkan_NewFrame();
-  ImGui_ImplSDL2_NewFrame();
-  ImGui::NewFrame();
+  Timer phaseTimer;
+  {
+    ABCG_PROFILE_SCOPE("ImGui::NewFrame");
+    ImGui_ImplVulkan_NewFrame();
+    ImGui_ImplSDL2_NewFrame();
+    ImGui::NewFrame();
+  }
 
-  onPaintUI();
+  {
+    ABCG_PROFILE_SCOPE("onPaintUI");
+    onPaintUI();
+  }
 
-  ImGui::Render();
+  {
+    ABCG_PROFILE_SCOPE("ImGui::Render");
+    ImGui::Render();
+  }
+  addFramePhaseTime(FramePhase::UI, phaseTimer.restart());
+
+  m_swapchain.render([this](auto const &frame) {
+    ABCG_PROFILE_SCOPE("onPaint");
+    onPaint(frame);
+  });
+  addFramePhaseTime(FramePhase::Paint, phaseTimer.restart());
 
-  m_swapchain.render([this](auto const &frame) { onPaint(frame); });
   m_swapchain.present();
+  addFramePhaseTime(FramePhase::Swap, phaseTimer.elapsed());
+  markFramePresented();
 }
 
 void abcg::VulkanWindow::destroy() {
@@ -97,6 +97,7 @@ protected:
 private:
   void handleEvent(SDL_Event const &event) final;
   void create() final;
+  void update() final;
   void paint() final;
   void destroy() final;
   [[nodiscard]] glm::ivec2 getWindowSize() const final;
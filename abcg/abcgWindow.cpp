@@ -12,9 +12,43 @@
 
 #include <SDL_video.h>
 
+#include <algorithm>
+#include <thread>
+#include <utility>
+
 #include <imgui_impl_sdl2.h>
 
+#include "abcgException.hpp"
+#include "abcgGpuMemory.hpp"
+#include "abcgMetrics.hpp"
+#include "abcgTrace.hpp"
+
 namespace {
+// Number of frames redrawn after each event with RenderPolicy::OnDemand. Dear
+// ImGui needs a couple of frames to settle hovering and focus states.
+constexpr int redrawFramesPerEvent{3};
+
+// Maximum time, in milliseconds, the main loop waits for events while idle
+constexpr Uint32 onDemandIdleTimeout{250};
+constexpr Uint32 hiddenIdleTimeout{100};
+
+// Maps the timestamp of an event, in milliseconds of SDL_GetTicks, to the
+// steady clock. Events pushed without a timestamp are taken as received now.
+std::chrono::steady_clock::time_point getEventTime(SDL_Event const &event) {
+  auto const now{std::chrono::steady_clock::now()};
+  if (event.common.timestamp == 0)
+    return now;
+  // Unsigned difference, so that the wrap-around of the ticks is harmless
+  auto const age{SDL_GetTicks() - event.common.timestamp};
+  return now - std::chrono::milliseconds{age};
+}
+
+// Window whose update thread is the calling thread, and its tick duration.
+// Set by the update thread itself, so that getDeltaTime does not read the
+// state owned by the main thread.
+thread_local abcg::Window const *updateThreadWindow{};
+thread_local double updateThreadTickDuration{};
+
 ImVec4 ColorAlpha(ImVec4 const &color, float const alpha) {
   return {color.x, color.y, color.z, alpha};
 }
@@ -162,16 +196,217 @@ abcg::fullscreenchangeCallback(int eventType,
  * that, zero is returned. Internally, the delta time accumulates for the next
  * frame(s) until at least 2ms have passed.
  *
+ * In benchmark mode (see abcg::BenchmarkSettings), this is a fixed simulated
+ * time step. When called from the update thread (see
+ * abcg::WindowSettings::threadedUpdate), this is the fixed tick duration.
+ *
  * @returns Time in seconds.
  */
-double abcg::Window::getDeltaTime() const noexcept { return m_lastDeltaTime; }
+double abcg::Window::getDeltaTime() const noexcept {
+  if (updateThreadWindow == this) {
+    return updateThreadTickDuration;
+  }
+  return m_lastDeltaTime;
+}
 
 /**
  * @brief Returns the time that have passed since the window was created.
  *
+ * In benchmark mode (see abcg::BenchmarkSettings), this is the sum of the
+ * simulated time steps.
+ *
  * @returns Time in seconds.
  */
-double abcg::Window::getElapsedTime() const { return m_elapsedTime.elapsed(); }
+double abcg::Window::getElapsedTime() const {
+  if (m_fixedDeltaTime.has_value()) {
+    return m_fixedElapsedTime;
+  }
+  return m_elapsedTime.elapsed();
+}
+
+/**
+ * @brief Returns the job system of the application.
+ *
+ * The job system can be used from the window's handlers (e.g.,
+ * abcg::OpenGLWindow::onCreate, abcg::OpenGLWindow::onUpdate) to run work on
+ * multiple threads.
+ *
+ * @returns Reference to the job system owned by abcg::Application.
+ *
+ * @throw abcg::RuntimeError if the window is not being run by an
+ * abcg::Application.
+ */
+abcg::JobSystem &abcg::Window::getJobSystem() const {
+  if (m_jobSystem == nullptr) {
+    throw abcg::RuntimeError("Job system is not available before "
+                             "abcg::Application::run");
+  }
+  return *m_jobSystem;
+}
+
+/**
+ * @brief Starts measuring a phase of the application startup.
+ *
+ * The phase ends when the returned object goes out of scope, and is listed in
+ * the startup report (see abcg::StartupProfiler). Phases measured after the
+ * first frame are ignored.
+ *
+ * @param name Name of the phase.
+ *
+ * @returns Scope object that records the phase on destruction.
+ */
+abcg::StartupProfiler::Scope
+abcg::Window::measureStartupPhase(std::string_view name) const {
+  return StartupProfiler::Scope{m_startupProfiler, name};
+}
+
+/**
+ * @brief Returns the arena for memory that lives for the current frame.
+ *
+ * The arena is reset at the start of each frame, before abcg::Window::update.
+ * It can be used with `std::pmr` containers (e.g., abcg::FrameVector and
+ * abcg::FrameString) to avoid heap allocations in per-frame code.
+ *
+ * @returns Reference to the frame arena.
+ *
+ * @remark The arena must only be used from the main thread.
+ */
+abcg::FrameArena &abcg::Window::getFrameArena() const noexcept {
+  return *m_frameArena;
+}
+
+/**
+ * @brief Returns the input state of the current frame.
+ *
+ * The input state is updated once per frame, before abcg::Window::update, from
+ * the SDL events dispatched since the last frame. Reading the state from the
+ * update and paint handlers is an alternative to reacting to each event in
+ * the event handler.
+ *
+ * @returns Reference to the input snapshot of the frame.
+ */
+abcg::InputState const &abcg::Window::getInputState() const noexcept {
+  return m_inputState;
+}
+
+/**
+ * @brief Returns how far the current frame is between the last two update
+ * ticks.
+ *
+ * This is meant to be used in the paint handlers to interpolate between the
+ * previous and current simulation states when
+ * abcg::WindowSettings::threadedUpdate is set.
+ *
+ * @returns Time since the last tick divided by the tick duration, clamped to
+ * [0, 1]. If updates are not threaded, returns 1.
+ *
+ * @sa abcg::TripleBuffer.
+ */
+float abcg::Window::getInterpolationAlpha() const noexcept {
+  if (!m_updateThread)
+    return 1.0f;
+
+  using clock = std::chrono::steady_clock;
+  auto const lastTick{clock::time_point{
+      clock::duration{m_updateThread->lastTickTime.load()}}};
+  auto const sinceLastTick{
+      std::chrono::duration<double>(clock::now() - lastTick).count()};
+  return gsl::narrow_cast<float>(
+      std::clamp(sinceLastTick / m_updateThread->tickDuration, 0.0, 1.0));
+}
+
+/**
+ * @brief Returns the CPU time spent in each phase of the last complete frame.
+ *
+ * @returns Reference to the abcg::FrameTimes of the last frame.
+ */
+abcg::FrameTimes const &abcg::Window::getFrameTimes() const noexcept {
+  return m_lastFrameTimes;
+}
+
+/**
+ * @brief Returns the statistics of the most recent frame times.
+ *
+ * The statistics are computed from abcg::FrameTimes::total over the last
+ * abcg::WindowSettings::frameStatisticsWindow frames, and can be used, e.g.,
+ * to check frame time budgets in automated tests.
+ *
+ * @returns Reference to the frame statistics.
+ */
+abcg::FrameStatistics const &
+abcg::Window::getFrameStatistics() const noexcept {
+  return m_frameStatistics;
+}
+
+/**
+ * @brief Returns the input-to-present latency of the last frame that had input.
+ *
+ * The latency is measured from the timestamp of the first keyboard, mouse,
+ * touch or game controller event of a frame, i.e., from the moment SDL
+ * received it, to the moment the frame is presented (e.g., after
+ * `SDL_GL_SwapWindow` returns). Time spent in the SDL event queue is
+ * therefore included.
+ *
+ * @returns Latency in seconds, or zero if no input has been received yet.
+ */
+double abcg::Window::getInputLatency() const noexcept { return m_inputLatency; }
+
+/**
+ * @brief Requests the window to be redrawn.
+ *
+ * This is only required when abcg::WindowSettings::renderPolicy is
+ * abcg::RenderPolicy::OnDemand and the content of the window changed for
+ * reasons other than input events (e.g., an animation is running or data
+ * finished loading). The request wakes up the main loop if it is waiting for
+ * events.
+ *
+ * @remark This function can be called from any thread.
+ */
+void abcg::Window::requestRedraw() const {
+  static Uint32 const redrawEventType{SDL_RegisterEvents(1)};
+  if (redrawEventType == static_cast<Uint32>(-1))
+    return;
+
+  SDL_Event event{};
+  event.type = redrawEventType;
+  event.user.windowID = m_windowID;
+  SDL_PushEvent(&event);
+}
+
+/**
+ * @brief Throws if the calling thread allocated heap memory in the current
+ * frame.
+ *
+ * Call this at the end of a frame path that is expected to be
+ * allocation-free, e.g., at the end of abcg::OpenGLWindow::onPaint, to catch
+ * regressions in automated tests. Only the allocations made by the calling
+ * thread since the frame started are considered.
+ *
+ * This does nothing unless ABCg was built with allocation tracking (see
+ * abcg::AllocationTracker).
+ *
+ * @throw abcg::RuntimeError if an allocation was made. The message lists the
+ * sampled call sites of the frame.
+ */
+void abcg::Window::assertNoAllocationsThisFrame() const {
+  if constexpr (AllocationTracker::isEnabled()) {
+    auto const stats{AllocationTracker::getThreadFrameStats()};
+    if (stats.allocations == 0)
+      return;
+
+    auto const frameIndex{AllocationTracker::getFrameIndex()};
+    auto message{fmt::format("{} heap allocation(s) of {} bytes in frame {}",
+                             stats.allocations, stats.bytes, frameIndex)};
+    for (auto const &sample : AllocationTracker::getSamples()) {
+      if (sample.frameIndex == frameIndex) {
+        message += fmt::format(
+            "\n  {} bytes at {}", sample.size,
+            AllocationTracker::describeCallSite(sample.callSite));
+      }
+    }
+    throw abcg::RuntimeError(message);
+  }
+}
 
 /**
  * @brief Returns the current configuration settings of the window.
@@ -206,6 +441,9 @@ void abcg::Window::setWindowSettings(WindowSettings const &windowSettings) {
 #endif
   }
 
+  m_frameStatistics.setWindowSize(windowSettings.frameStatisticsWindow);
+  m_frameStatistics.setStutterThreshold(windowSettings.stutterThreshold);
+
   m_windowSettings = windowSettings;
 }
 
@@ -233,7 +471,8 @@ Uint32 abcg::Window::getSDLWindowID() const noexcept { return m_windowID; }
  * @brief Creates the SDL window.
  *
  * @param extraFlags Extra SDL window flags to be combined with the common
- * flags (`SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI`).
+ * flags (`SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI`). In headless mode,
+ * `SDL_WINDOW_HIDDEN` is used instead of the common flags.
  *
  * @returns `true` on success; `false` on failure.
  */
@@ -241,7 +480,10 @@ bool abcg::Window::createSDLWindow(SDL_WindowFlags extraFlags) {
   if (m_window != nullptr)
     return false;
 
-  auto commonFlags{SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI};
+  auto const commonFlags{
+      m_windowSettings.headless
+          ? SDL_WINDOW_HIDDEN
+          : SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI};
 
   m_window = SDL_CreateWindow(
       m_windowSettings.title.c_str(), SDL_WINDOWPOS_CENTERED,
@@ -314,7 +556,61 @@ void abcg::Window::toggleFullscreen() {
 #endif
 }
 
+/**
+ * @brief Marks the current frame as presented.
+ *
+ * This must be called by the derived window classes just after the frame is
+ * presented, to update the latency reported by abcg::Window::getInputLatency.
+ */
+void abcg::Window::markFramePresented() {
+  if (m_frameInputTime.has_value()) {
+    m_inputLatency = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - *m_frameInputTime)
+                         .count();
+    m_frameInputTime.reset();
+  }
+}
+
+/**
+ * @brief Adds to the CPU time spent in a phase of the current frame.
+ *
+ * This is used by the derived window classes to break down the frame time
+ * reported by abcg::Window::getFrameTimes.
+ *
+ * @param phase Frame phase.
+ * @param seconds Time to be added, in seconds.
+ */
+void abcg::Window::addFramePhaseTime(FramePhase phase,
+                                     double seconds) noexcept {
+  switch (phase) {
+  case FramePhase::Events:
+    m_currentFrameTimes.events += seconds;
+    break;
+  case FramePhase::Update:
+    m_currentFrameTimes.update += seconds;
+    break;
+  case FramePhase::UI:
+    m_currentFrameTimes.ui += seconds;
+    break;
+  case FramePhase::Paint:
+    m_currentFrameTimes.paint += seconds;
+    break;
+  case FramePhase::Swap:
+    m_currentFrameTimes.swap += seconds;
+    break;
+  }
+}
+
 void abcg::Window::templateHandleEvent(SDL_Event const &event, bool &done) {
+  m_pendingRedrawFrames = redrawFramesPerEvent;
+
+  // Keyboard, mouse, joystick, game controller and touch events
+  if (auto const isInputEvent{event.type >= SDL_KEYDOWN &&
+                              event.type < SDL_CLIPBOARDUPDATE};
+      isInputEvent && !m_pendingInputTime.has_value()) {
+    m_pendingInputTime = getEventTime(event);
+  }
+
   ImGui_ImplSDL2_ProcessEvent(&event);
 
   if (event.window.windowID != m_windowID)
@@ -355,6 +651,13 @@ void abcg::Window::templateHandleEvent(SDL_Event const &event, bool &done) {
 #endif
         toggleFullscreen();
     }
+    if (event.key.keysym.sym == SDLK_F9) {
+      if (Trace::isCapturing()) {
+        Trace::stop();
+      } else {
+        Trace::start(m_windowSettings.tracePath);
+      }
+    }
   }
 
   // Won't pass mouse events to the application if ImGUI has captured the
@@ -375,6 +678,8 @@ void abcg::Window::templateHandleEvent(SDL_Event const &event, bool &done) {
     useCustomEventHandler = false;
   }
 
+  m_pendingInputState.accumulate(event, !useCustomEventHandler);
+
   if (useCustomEventHandler) {
     handleEvent(event);
   }
@@ -383,31 +688,213 @@ void abcg::Window::templateHandleEvent(SDL_Event const &event, bool &done) {
 void abcg::Window::templateCreate() {
   m_deltaTime.restart();
   m_elapsedTime.restart();
+  m_pendingRedrawFrames = redrawFramesPerEvent;
+  m_nextFrameTime = std::chrono::steady_clock::now();
+
+  if (m_windowSettings.detectHitches) {
+    m_hitchDetector = std::make_unique<HitchDetector>(
+        m_windowSettings.hitchThreshold, m_windowSettings.hitchReportPath);
+  }
 
   create();
 
   // Set up our own Dear ImGui style
   setupImGuiStyle(true, 1.0f);
+
+  if (isUpdateThreaded()) {
+    startUpdateThread();
+  }
 }
 
 void abcg::Window::templatePaint() {
-  // Cap to 480 Hz
-  if (m_deltaTime.elapsed() >= 1.0 / 480.0) {
+  ABCG_PROFILE_SCOPE("templatePaint");
+  Timer frameTimer;
+  AllocationTracker::newFrame();
+
+  if (m_windowSettings.showProfiler) {
+    Profiler::setEnabled(true);
+  }
+
+  m_frameArena->reset();
+
+  if (m_fixedDeltaTime.has_value()) {
+    m_lastDeltaTime = *m_fixedDeltaTime;
+    m_fixedElapsedTime += m_lastDeltaTime;
+  } else if (m_deltaTime.elapsed() >= 1.0 / 480.0) {
+    // Cap to 480 Hz
     m_lastDeltaTime = m_deltaTime.restart();
   } else {
     m_lastDeltaTime = 0.0;
   }
 
+  m_inputState = m_pendingInputState;
+  m_pendingInputState.beginFrame();
+  m_frameInputTime = std::exchange(m_pendingInputTime, std::nullopt);
+
+  if (m_updateThread) {
+    // Propagate exceptions thrown by the update handler
+    std::lock_guard const lock{m_updateThread->exceptionMutex};
+    if (auto const exception{m_updateThread->exception}) {
+      m_updateThread->exception = nullptr;
+      std::rethrow_exception(exception);
+    }
+  } else {
+    ABCG_PROFILE_SCOPE("onUpdate");
+    Timer updateTimer;
+    update();
+    addFramePhaseTime(FramePhase::Update, updateTimer.elapsed());
+  }
+
   paint();
+
+  m_currentFrameTimes.total = m_currentFrameTimes.events + frameTimer.elapsed();
+  m_lastFrameTimes = m_currentFrameTimes;
+  m_currentFrameTimes = {};
+  m_frameStatistics.record(m_lastFrameTimes.total);
+
+  if (m_hitchDetector) {
+    m_hitchDetector->recordFrame(m_lastFrameTimes);
+  }
+
+  static auto &frameTime{abcg::Metrics::histogram("abcg.frame_time_ms")};
+  static auto &frameArenaBytes{abcg::Metrics::gauge("abcg.frame_arena_bytes")};
+  frameTime.record(m_lastFrameTimes.total * 1000.0);
+  frameArenaBytes.set(static_cast<double>(m_frameArena->getCapacity()));
+  if constexpr (AllocationTracker::isEnabled()) {
+    static auto &frameAllocations{
+        abcg::Metrics::gauge("abcg.frame_allocations")};
+    frameAllocations.set(static_cast<double>(
+        AllocationTracker::getFrameStats().allocations));
+  }
+
+  m_pendingRedrawFrames = std::max(m_pendingRedrawFrames - 1, 0);
 }
 
 void abcg::Window::templateDestroy() {
   if (m_window == nullptr)
     return;
 
+  stopUpdateThread();
+
   destroy();
 
+  // Resources created by the application should have been released in
+  // onDestroy
+  GpuMemory::reportLeaks();
+
+  m_hitchDetector.reset();
+
   SDL_DestroyWindow(m_window);
   m_window = nullptr;
   m_windowID = 0;
-}
\ No newline at end of file
+}
+
+// Returns how long, in milliseconds, the main loop may block waiting for
+// events before the next iteration, or 0 if it must not block
+Uint32 abcg::Window::getIdleTimeout() const {
+  if (m_window == nullptr || m_windowSettings.headless ||
+      m_fixedDeltaTime.has_value())
+    return 0;
+
+  if ((SDL_GetWindowFlags(m_window) &
+       (SDL_WINDOW_HIDDEN | SDL_WINDOW_MINIMIZED)) != 0U)
+    return hiddenIdleTimeout;
+
+  if (m_windowSettings.renderPolicy == RenderPolicy::OnDemand &&
+      m_pendingRedrawFrames == 0)
+    return onDemandIdleTimeout;
+
+  return 0;
+}
+
+bool abcg::Window::isRedrawPending() const noexcept {
+  if (m_windowSettings.renderPolicy != RenderPolicy::OnDemand ||
+      m_fixedDeltaTime.has_value())
+    return true;
+
+  return m_pendingRedrawFrames > 0;
+}
+
+// Sleeps until it is time to start the next frame with
+// RenderPolicy::CappedFPS
+void abcg::Window::waitForNextFrame() {
+  using clock = std::chrono::steady_clock;
+
+  if (m_windowSettings.renderPolicy != RenderPolicy::CappedFPS ||
+      m_windowSettings.maxFPS <= 0 || m_fixedDeltaTime.has_value())
+    return;
+
+  auto const now{clock::now()};
+  if (m_nextFrameTime > now) {
+    std::this_thread::sleep_until(m_nextFrameTime);
+  }
+
+  // If the frame is late, restart the schedule from now instead of trying to
+  // catch up with a burst of frames
+  auto const period{std::chrono::duration_cast<clock::duration>(
+      std::chrono::duration<double>(1.0 / m_windowSettings.maxFPS))};
+  m_nextFrameTime = std::max(m_nextFrameTime, now) + period;
+}
+
+bool abcg::Window::isUpdateThreaded() const noexcept {
+#if defined(__EMSCRIPTEN__)
+  return false;
+#else
+  return m_windowSettings.threadedUpdate && m_windowSettings.updateRate > 0 &&
+         !m_fixedDeltaTime.has_value() && !m_forceSynchronousUpdate;
+#endif
+}
+
+// Calls update() at a fixed rate on a separate thread
+void abcg::Window::startUpdateThread() {
+  using clock = std::chrono::steady_clock;
+
+  m_updateThread = std::make_unique<UpdateThread>();
+  m_updateThread->tickDuration = 1.0 / m_windowSettings.updateRate;
+  m_updateThread->lastTickTime = clock::now().time_since_epoch().count();
+
+  // The thread only accesses its state through this reference, which stays
+  // valid until the thread is joined
+  m_updateThread->thread = std::thread([this, &state = *m_updateThread]() {
+    Profiler::setThreadName("Update");
+    updateThreadWindow = this;
+    updateThreadTickDuration = state.tickDuration;
+    auto const period{std::chrono::duration_cast<clock::duration>(
+        std::chrono::duration<double>(state.tickDuration))};
+    // Ticks behind schedule after which the schedule is reset instead of
+    // running ticks back to back to catch up
+    constexpr int maxLateTicks{5};
+
+    auto nextTick{clock::now()};
+    while (!state.stop.load()) {
+      try {
+        ABCG_PROFILE_SCOPE("onUpdate");
+        update();
+      } catch (...) {
+        std::lock_guard const lock{state.exceptionMutex};
+        state.exception = std::current_exception();
+        return;
+      }
+
+      auto const now{clock::now()};
+      state.lastTickTime = now.time_since_epoch().count();
+      nextTick += period;
+      if (now - nextTick > period * maxLateTicks) {
+        nextTick = now;
+      }
+      std::this_thread::sleep_until(nextTick);
+    }
+  });
+}
+
+void abcg::Window::stopUpdateThread() {
+  if (!m_updateThread)
+    return;
+
+  // Join before releasing the state the thread refers to
+  m_updateThread->stop = true;
+  if (m_updateThread->thread.joinable()) {
+    m_updateThread->thread.join();
+  }
+  m_updateThread.reset();
+}
@@ -13,16 +13,35 @@
 #ifndef ABCG_WINDOW_HPP_
 #define ABCG_WINDOW_HPP_
 
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <thread>
 
+#include "abcgAllocationTracker.hpp"
 #include "abcgExternal.hpp"
+#include "abcgFrameArena.hpp"
+#include "abcgFrameStatistics.hpp"
+#include "abcgFrameTimes.hpp"
+#include "abcgHitchDetector.hpp"
+#include "abcgProfiler.hpp"
+#include "abcgInput.hpp"
+#include "abcgJobSystem.hpp"
+#include "abcgStartupProfiler.hpp"
 #include "abcgTimer.hpp"
+#include "abcgTripleBuffer.hpp"
 
 #if defined(__EMSCRIPTEN__)
 #include "abcgOpenGLExternal.hpp"
 #endif
 
 namespace abcg {
+enum class RenderPolicy;
 struct WindowSettings;
 class Application;
 class Window;
@@ -34,6 +53,23 @@ EM_BOOL fullscreenchangeCallback(int eventType,
 #endif
 } // namespace abcg
 
+/**
+ * @brief Enumeration of the policies that control when a window is redrawn.
+ *
+ * @sa abcg::WindowSettings::renderPolicy.
+ */
+enum class abcg::RenderPolicy {
+  /** @brief Redraw as fast as possible (or at the vSync rate, if enabled). */
+  Continuous,
+  /** @brief Redraw at most abcg::WindowSettings::maxFPS times per second.
+   * The main loop sleeps between frames. */
+  CappedFPS,
+  /** @brief Redraw only after input events or after a call to
+   * abcg::Window::requestRedraw. The main loop waits for events in between.
+   */
+  OnDemand
+};
+
 /**
  * @brief Configuration settings of a window.
  *
@@ -58,8 +94,27 @@ struct abcg::WindowSettings {
    * abcg::Window::getWindowSize.
    */
   int height{600};
-  /** @brief Whether to show an overlay window with a FPS counter. */
+  /** @brief Whether to show an overlay window with a FPS counter, the frame
+   * time percentiles and a frame time histogram.
+   *
+   * @sa abcg::FrameStatistics.
+   */
   bool showFPS{true};
+  /** @brief Number of most recent frames over which the frame statistics are
+   * computed.
+   *
+   * @sa abcg::Window::getFrameStatistics.
+   */
+  std::size_t frameStatisticsWindow{FrameStatistics::defaultWindowSize};
+  /** @brief Multiple of the median frame time above which a frame is counted
+   * as a stutter in the frame statistics. */
+  double stutterThreshold{FrameStatistics::defaultStutterThreshold};
+  /** @brief Whether to show a window with the profiling zones of the last
+   * frame. Setting this enables abcg::Profiler.
+   *
+   * @sa abcg::Profiler::showWindow.
+   */
+  bool showProfiler{false};
   /** @brief Whether to show a button to toggle fullscreen on/off. */
   bool showFullscreenButton{true};
   /** @brief HTML element ID used for registering the fullscreen callback when
@@ -68,6 +123,78 @@ struct abcg::WindowSettings {
   std::string fullscreenElementID{"#canvas"};
   /** @brief String containing the window title. */
   std::string title{"ABCg Window"};
+  /** @brief Whether to render offscreen, without a visible window.
+   *
+   * In headless mode, SDL is initialized with its "offscreen" video driver
+   * (EGL-based) and the window is never shown. abcg::OpenGLWindow renders
+   * to a framebuffer object of size (`width`, `height`) instead of the
+   * default framebuffer. This is useful for running applications on machines
+   * without a display server, e.g., with Mesa's llvmpipe.
+   *
+   * @remark This must be set before calling abcg::Application::run.
+   */
+  bool headless{false};
+  /** @brief Policy that controls when the window is redrawn.
+   *
+   * Regardless of the policy, the main loop sleeps while the window is hidden
+   * or minimized, waking up periodically to update the application.
+   *
+   * @remark On WebAssembly, frames are paced by the browser and
+   * abcg::RenderPolicy::CappedFPS behaves as abcg::RenderPolicy::Continuous.
+   */
+  RenderPolicy renderPolicy{RenderPolicy::Continuous};
+  /** @brief Maximum number of frames per second when `renderPolicy` is
+   * abcg::RenderPolicy::CappedFPS. Non-positive values disable the cap. */
+  int maxFPS{60};
+  /** @brief Whether to merge consecutive mouse motion and mouse wheel events
+   * before dispatching them.
+   *
+   * With high polling rate mice, this reduces the number of calls to the event
+   * handlers to about one per frame, without changing the accumulated motion.
+   *
+   * @sa abcg::coalesceInputEvent.
+   */
+  bool coalesceInputEvents{true};
+  /** @brief Whether to call abcg::Window::update on a separate thread at a
+   * fixed rate of `updateRate` ticks per second, instead of once per frame
+   * on the main thread.
+   *
+   * In this mode, abcg::Window::getDeltaTime returns the fixed tick duration
+   * when called from the update thread, and
+   * abcg::Window::getInterpolationAlpha can be used by the paint handlers to
+   * interpolate between the last two ticks. Use abcg::TripleBuffer to hand
+   * the simulation state from the update thread to the paint handlers.
+   *
+   * @remark The update handler must not issue graphics API or Dear ImGui
+   * calls in this mode, nor call abcg::Window::getInputState, which is
+   * updated by the main thread. On WebAssembly, and in benchmark, input
+   * recording and input replay modes, the update handler is called on the
+   * main thread once per frame.
+   *
+   * @remark This must be set before calling abcg::Application::run.
+   */
+  bool threadedUpdate{false};
+  /** @brief Number of update ticks per second when `threadedUpdate` is set.
+   */
+  int updateRate{60};
+  /** @brief Whether to detect and report frame hitches.
+   *
+   * @remark This must be set before calling abcg::Application::run.
+   *
+   * @sa abcg::HitchDetector.
+   */
+  bool detectHitches{false};
+  /** @brief Multiple of the median frame time above which a frame is
+   * considered a hitch. */
+  double hitchThreshold{2.0};
+  /** @brief Path of the text file to which hitch reports are appended. */
+  std::string hitchReportPath{"hitches.txt"};
+  /** @brief Path of the JSON file written when a trace capture toggled with
+   * F9 stops.
+   *
+   * @sa abcg::Trace.
+   */
+  std::string tracePath{"trace.json"};
 };
 
 /**
@@ -106,6 +233,11 @@ public:
 
   [[nodiscard]] WindowSettings const &getWindowSettings() const noexcept;
   void setWindowSettings(WindowSettings const &windowSettings);
+  [[nodiscard]] FrameTimes const &getFrameTimes() const noexcept;
+  [[nodiscard]] FrameStatistics const &getFrameStatistics() const noexcept;
+  [[nodiscard]] double getInputLatency() const noexcept;
+  void requestRedraw() const;
+  void assertNoAllocationsThisFrame() const;
 
 protected:
   /**
@@ -126,11 +258,18 @@ protected:
    */
   virtual void create() = 0;
 
+  /**
+   * @brief Custom handler for frame updates.
+   *
+   * This is called once per frame just before abcg::Window::paint.
+   */
+  virtual void update() = 0;
+
   /**
    * @brief Custom handler for window repainting.
    *
-   * This is called continuously during the application's loop for redrawing the
-   * window.
+   * This is called during the application's loop for redrawing the window, as
+   * determined by abcg::WindowSettings::renderPolicy.
    */
   virtual void paint() = 0;
 
@@ -152,14 +291,22 @@ protected:
    */
   [[nodiscard]] virtual glm::ivec2 getWindowSize() const = 0;
 
+  [[nodiscard]] JobSystem &getJobSystem() const;
+  [[nodiscard]] FrameArena &getFrameArena() const noexcept;
+  [[nodiscard]] StartupProfiler::Scope
+  measureStartupPhase(std::string_view name) const;
+  [[nodiscard]] InputState const &getInputState() const noexcept;
   [[nodiscard]] double getDeltaTime() const noexcept;
   [[nodiscard]] double getElapsedTime() const;
+  [[nodiscard]] float getInterpolationAlpha() const noexcept;
   [[nodiscard]] SDL_Window *getSDLWindow() const noexcept;
   [[nodiscard]] Uint32 getSDLWindowID() const noexcept;
 
   bool createSDLWindow(SDL_WindowFlags extraFlags);
   void setEnableResizingEventWatcher(bool enabled) noexcept;
   void toggleFullscreen();
+  void addFramePhaseTime(FramePhase phase, double seconds) noexcept;
+  void markFramePresented();
 
 private:
   void templateHandleEvent(SDL_Event const &event, bool &done);
@@ -167,15 +314,78 @@ private:
   void templatePaint();
   void templateDestroy();
 
+  void startUpdateThread();
+  void stopUpdateThread();
+  [[nodiscard]] bool isUpdateThreaded() const noexcept;
+
+  [[nodiscard]] Uint32 getIdleTimeout() const;
+  [[nodiscard]] bool isRedrawPending() const noexcept;
+  void waitForNextFrame();
+
   SDL_Window *m_window{};
   Uint32 m_windowID{};
 
+  // Owned by abcg::Application
+  JobSystem *m_jobSystem{};
+  StartupProfiler *m_startupProfiler{};
+
   WindowSettings m_windowSettings;
 
   Timer m_deltaTime;
   Timer m_elapsedTime;
   double m_lastDeltaTime{};
 
+  // Set by abcg::Application to simulate a fixed frame rate
+  std::optional<double> m_fixedDeltaTime;
+  double m_fixedElapsedTime{};
+  // Set by abcg::Application while recording input, so that the recorded
+  // time steps are the ones passed to onUpdate
+  bool m_forceSynchronousUpdate{};
+
+  FrameTimes m_currentFrameTimes;
+  FrameTimes m_lastFrameTimes;
+  FrameStatistics m_frameStatistics;
+  std::unique_ptr<HitchDetector> m_hitchDetector;
+
+  std::unique_ptr<FrameArena> m_frameArena{std::make_unique<FrameArena>()};
+
+  // State of the update thread used with WindowSettings::threadedUpdate
+  struct UpdateThread {
+    UpdateThread() = default;
+    UpdateThread(UpdateThread const &) = delete;
+    UpdateThread(UpdateThread &&) = delete;
+    UpdateThread &operator=(UpdateThread const &) = delete;
+    UpdateThread &operator=(UpdateThread &&) = delete;
+    ~UpdateThread() {
+      stop = true;
+      if (thread.joinable())
+        thread.join();
+    }
+
+    std::thread thread;
+    std::atomic<bool> stop{};
+    double tickDuration{};
+    // Time of the last tick, in steady_clock ticks
+    std::atomic<std::chrono::steady_clock::rep> lastTickTime{};
+    std::mutex exceptionMutex;
+    std::exception_ptr exception;
+  };
+  std::unique_ptr<UpdateThread> m_updateThread;
+
+  // Snapshot of the current frame and state being accumulated for the next
+  InputState m_inputState;
+  InputState m_pendingInputState;
+
+  // Time of the first input event of the frame being accumulated and of the
+  // frame being painted
+  std::optional<std::chrono::steady_clock::time_point> m_pendingInputTime;
+  std::optional<std::chrono::steady_clock::time_point> m_frameInputTime;
+  double m_inputLatency{};
+
+  // Number of frames to be redrawn with abcg::RenderPolicy::OnDemand
+  int m_pendingRedrawFrames{};
+  std::chrono::steady_clock::time_point m_nextFrameTime;
+
   bool m_enableResizingEventWatcher{true};
 
   friend Application;
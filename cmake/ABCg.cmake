@@ -8,6 +8,12 @@ function(enable_abcg project_target)
     target_link_libraries(${project_target} PUBLIC abcg)
   endif()
 
+  if(ABCG_ENABLE_ALLOCATION_TRACKING)
+    # Export the symbols of the executable so that the call sites of the
+    # sampled allocations can be named
+    set_target_properties(${project_target} PROPERTIES ENABLE_EXPORTS ON)
+  endif()
+
   if(${CMAKE_SYSTEM_NAME} MATCHES "Windows"
      AND NOT ENABLE_CONAN
      AND NOT MSVC)
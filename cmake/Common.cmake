@@ -17,6 +17,10 @@ if(NOT ${CMAKE_SYSTEM_NAME} MATCHES "Emscripten")
     option(ENABLE_MOLD "Enable mold (Modern Linker)" ON)
   endif()
 
+  # Heap allocation tracking
+  option(ABCG_ENABLE_ALLOCATION_TRACKING
+         "Count heap allocations per frame (see abcg::AllocationTracker)" OFF)
+
   # IPO
   if(NOT ENABLE_MOLD)
     option(ENABLE_IPO "Enable Interprocedural Optimization" ON)
@@ -301,7 +301,7 @@ void Model::render(int numTriangles) const {
   abcg::glBindVertexArray(0);
 }
 
-void Model::setupVAO(GLuint program) {
+void Model::setupVAO(abcg::OpenGLProgram const &program) {
   // Release previous VAO
   abcg::glDeleteVertexArrays(1, &m_VAO);
 
@@ -314,15 +314,14 @@ void Model::setupVAO(GLuint program) {
   abcg::glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
 
   // Bind vertex attributes
-  auto const positionAttribute{
-      abcg::glGetAttribLocation(program, "inPosition")};
+  auto const positionAttribute{program.getAttribLocation("inPosition")};
   if (positionAttribute >= 0) {
     abcg::glEnableVertexAttribArray(positionAttribute);
     abcg::glVertexAttribPointer(positionAttribute, 3, GL_FLOAT, GL_FALSE,
                                 sizeof(Vertex), nullptr);
   }
 
-  auto const normalAttribute{abcg::glGetAttribLocation(program, "inNormal")};
+  auto const normalAttribute{program.getAttribLocation("inNormal")};
   if (normalAttribute >= 0) {
     abcg::glEnableVertexAttribArray(normalAttribute);
     auto const offset{offsetof(Vertex, normal)};
@@ -331,8 +330,7 @@ void Model::setupVAO(GLuint program) {
                                 reinterpret_cast<void *>(offset));
   }
 
-  auto const texCoordAttribute{
-      abcg::glGetAttribLocation(program, "inTexCoord")};
+  auto const texCoordAttribute{program.getAttribLocation("inTexCoord")};
   if (texCoordAttribute >= 0) {
     abcg::glEnableVertexAttribArray(texCoordAttribute);
     auto const offset{offsetof(Vertex, texCoord)};
@@ -341,8 +339,7 @@ void Model::setupVAO(GLuint program) {
                                 reinterpret_cast<void *>(offset));
   }
 
-  auto const tangentCoordAttribute{
-      abcg::glGetAttribLocation(program, "inTangent")};
+  auto const tangentCoordAttribute{program.getAttribLocation("inTangent")};
   if (tangentCoordAttribute >= 0) {
     abcg::glEnableVertexAttribArray(tangentCoordAttribute);
     auto const offset{offsetof(Vertex, tangent)};
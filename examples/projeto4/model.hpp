@@ -19,7 +19,7 @@ public:
   void loadNormalTexture(std::string_view path);
   void loadObj(std::string_view path, bool standardize = true);
   void render(int numTriangles = -1) const;
-  void setupVAO(GLuint program);
+  void setupVAO(abcg::OpenGLProgram const &program);
   void destroy();
 
   [[nodiscard]] int getNumTriangles() const {
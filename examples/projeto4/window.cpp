@@ -14,10 +14,9 @@ void Window::onCreate() {
   // Create programs
   for (auto const &name : m_shaderNames) {
     auto const path{assetsPath + "shaders/" + name};
-    auto const program{abcg::createOpenGLProgram(
+    m_programs.emplace_back().create(
         {{.source = path + ".vert", .stage = abcg::ShaderStage::Vertex},
-         {.source = path + ".frag", .stage = abcg::ShaderStage::Fragment}})};
-    m_programs.push_back(program);
+         {.source = path + ".frag", .stage = abcg::ShaderStage::Fragment}});
   }
 
   // Load ship model
@@ -208,59 +207,39 @@ void Window::onPaint() {
 
   abcg::glViewport(0, 0, m_viewportSize.x, m_viewportSize.y);
 
-  // Use currently selected program
-  auto const program{m_programs.at(m_currentProgramIndex)};
-  abcg::glUseProgram(program);
-
-  // Get location of uniform variables
-  auto const viewMatrixLoc{abcg::glGetUniformLocation(program, "viewMatrix")};
-  auto const projMatrixLoc{abcg::glGetUniformLocation(program, "projMatrix")};
-  auto const modelMatrixLoc{abcg::glGetUniformLocation(program, "modelMatrix")};
-  auto const normalMatrixLoc{
-      abcg::glGetUniformLocation(program, "normalMatrix")};
-  auto const lightDirLoc{
-      abcg::glGetUniformLocation(program, "lightDirWorldSpace")};
-  auto const shininessLoc{abcg::glGetUniformLocation(program, "shininess")};
-  auto const IaLoc{abcg::glGetUniformLocation(program, "Ia")};
-  auto const IdLoc{abcg::glGetUniformLocation(program, "Id")};
-  auto const IsLoc{abcg::glGetUniformLocation(program, "Is")};
-  auto const KaLoc{abcg::glGetUniformLocation(program, "Ka")};
-  auto const KdLoc{abcg::glGetUniformLocation(program, "Kd")};
-  auto const KsLoc{abcg::glGetUniformLocation(program, "Ks")};
-  auto const diffuseTexLoc{abcg::glGetUniformLocation(program, "diffuseTex")};
-  auto const normalTexLoc{abcg::glGetUniformLocation(program, "normalTex")};
-  auto const cubeTexLoc{abcg::glGetUniformLocation(program, "cubeTex")};
-  auto const mappingModeLoc{abcg::glGetUniformLocation(program, "mappingMode")};
-  auto const texMatrixLoc{abcg::glGetUniformLocation(program, "texMatrix")};
+  // Use currently selected program. Uniforms whose values did not change
+  // since the last frame are not uploaded again.
+  auto &program{m_programs.at(m_currentProgramIndex)};
+  program.use();
 
   // Set uniform variables that have the same value for every model
-  abcg::glUniformMatrix4fv(viewMatrixLoc, 1, GL_FALSE, &m_viewMatrix[0][0]);
-  abcg::glUniformMatrix4fv(projMatrixLoc, 1, GL_FALSE, &m_projMatrix[0][0]);
-  abcg::glUniform1i(diffuseTexLoc, 0);
-  abcg::glUniform1i(normalTexLoc, 1);
-  abcg::glUniform1i(cubeTexLoc, 2);
-  abcg::glUniform1i(mappingModeLoc, m_mappingMode);
+  program.setUniform("viewMatrix", m_viewMatrix);
+  program.setUniform("projMatrix", m_projMatrix);
+  program.setUniform("diffuseTex", 0);
+  program.setUniform("normalTex", 1);
+  program.setUniform("cubeTex", 2);
+  program.setUniform("mappingMode", m_mappingMode);
 
   glm::mat3 const texMatrix{m_trackBallLight.getRotation()};
-  abcg::glUniformMatrix3fv(texMatrixLoc, 1, GL_TRUE, &texMatrix[0][0]);
+  program.setUniform("texMatrix", glm::transpose(texMatrix));
 
   auto const lightDirRotated{m_trackBallLight.getRotation() * m_lightDir};
-  abcg::glUniform4fv(lightDirLoc, 1, &lightDirRotated.x);
-  abcg::glUniform4fv(IaLoc, 1, &m_Ia.x);
-  abcg::glUniform4fv(IdLoc, 1, &m_Id.x);
-  abcg::glUniform4fv(IsLoc, 1, &m_Is.x);
+  program.setUniform("lightDirWorldSpace", lightDirRotated);
+  program.setUniform("Ia", m_Ia);
+  program.setUniform("Id", m_Id);
+  program.setUniform("Is", m_Is);
 
   // // Set uniform variables for the current model
-  // abcg::glUniformMatrix4fv(modelMatrixLoc, 1, GL_FALSE, &m_modelMatrix[0][0]);
+  // program.setUniform("modelMatrix", m_modelMatrix);
 
   // auto const modelViewMatrix{glm::mat3(m_viewMatrix * m_modelMatrix)};
   // auto const normalMatrix{glm::inverseTranspose(modelViewMatrix)};
-  // abcg::glUniformMatrix3fv(normalMatrixLoc, 1, GL_FALSE, &normalMatrix[0][0]);
+  // program.setUniform("normalMatrix", normalMatrix);
 
-  abcg::glUniform4fv(KaLoc, 1, &m_Ka.x);
-  abcg::glUniform4fv(KdLoc, 1, &m_Kd.x);
-  abcg::glUniform4fv(KsLoc, 1, &m_Ks.x);
-  abcg::glUniform1f(shininessLoc, m_shininess);
+  program.setUniform("Ka", m_Ka);
+  program.setUniform("Kd", m_Kd);
+  program.setUniform("Ks", m_Ks);
+  program.setUniform("shininess", m_shininess);
 
   // Render each star
   for (auto &star : m_stars) {
@@ -271,7 +250,7 @@ void Window::onPaint() {
     modelMatrix = glm::rotate(modelMatrix, m_angle, star.m_rotationAxis);
 
     // Set uniform variable
-    abcg::glUniformMatrix4fv(modelMatrixLoc, 1, GL_FALSE, &modelMatrix[0][0]);
+    program.setUniform("modelMatrix", modelMatrix);
 
     m_model.render();
   }
@@ -286,7 +265,7 @@ void Window::onPaint() {
   // glm::mat4 identityMatrix{1.0f};
 
   // Enviar as matrizes para o shader
-  abcg::glUniformMatrix4fv(modelMatrixLoc, 1, GL_FALSE, &modelMatrix[0][0]);
+  program.setUniform("modelMatrix", modelMatrix);
   // abcg::glUniformMatrix4fv(viewMatrixLoc, 1, GL_FALSE, &identityMatrix[0][0]);
   // abcg::glUniformMatrix4fv(projMatrixLoc, 1, GL_FALSE, &m_projMatrix[0][0]);
   // abcg::glUniformMatrix4fv(modelMatrixLoc, 1, GL_FALSE, &modelMatrix[0][0]);
@@ -615,7 +594,7 @@ void Window::onResize(glm::ivec2 const &size) {
 void Window::onDestroy() {
   m_model.destroy();
   m_model_ship.destroy();
-  for (auto const &program : m_programs) {
-    abcg::glDeleteProgram(program);
+  for (auto &program : m_programs) {
+    program.destroy();
   }
 }
\ No newline at end of file
@@ -54,7 +54,7 @@ private:
   std::vector<char const *> m_shaderNames{
       "cubereflect", "cuberefract", "normalmapping", "texture", "blinnphong",
       "phong",       "gouraud",     "normal",        "depth"};
-  std::vector<GLuint> m_programs;
+  std::vector<abcg::OpenGLProgram> m_programs;
   int m_currentProgramIndex{};
 
   // Mapping mode
@@ -0,0 +1,133 @@
+// Replays an OpenGL capture written by abcg::OpenGLCapture and reports the
+// time of the captured frames.
+//
+// Usage: glreplay <capture> [--iterations=N]
+
+#include <charconv>
+#include <string_view>
+
+#include "abcgFrameStatistics.hpp"
+#include "abcgOpenGL.hpp"
+
+namespace {
+struct Options {
+  std::string path;
+  int iterations{100};
+};
+
+Options parseOptions(int argc, char **argv) {
+  Options options;
+  for (auto const index : iter::range(1, argc)) {
+    std::string_view const arg{argv[index]};
+    if (constexpr std::string_view prefix{"--iterations="};
+        arg.starts_with(prefix)) {
+      auto const value{arg.substr(prefix.size())};
+      if (std::from_chars(value.data(), value.data() + value.size(),
+                          options.iterations)
+                  .ec != std::errc{} ||
+          options.iterations < 1) {
+        throw abcg::RuntimeError(
+            fmt::format("Invalid number of iterations: {}", value));
+      }
+    } else {
+      options.path = arg;
+    }
+  }
+  if (options.path.empty()) {
+    throw abcg::RuntimeError("Usage: glreplay <capture> [--iterations=N]");
+  }
+  return options;
+}
+
+// Creates a hidden window with an OpenGL context compatible with the capture
+SDL_Window *createWindow(abcg::OpenGLCaptureInfo const &info) {
+  SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+  if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+    throw abcg::SDLError("SDL_Init failed");
+  }
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK,
+                      info.es ? SDL_GL_CONTEXT_PROFILE_ES
+                              : SDL_GL_CONTEXT_PROFILE_CORE);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, info.majorVersion);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, info.minorVersion);
+  SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
+
+  auto *window{SDL_CreateWindow("glreplay", SDL_WINDOWPOS_CENTERED,
+                                SDL_WINDOWPOS_CENTERED,
+                                std::max(info.width, 1),
+                                std::max(info.height, 1),
+                                SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN)};
+  if (window == nullptr) {
+    throw abcg::SDLError("SDL_CreateWindow failed");
+  }
+  return window;
+}
+
+void printStatistics(std::string_view label,
+                     abcg::FrameStatisticsSummary const &summary,
+                     double scale) {
+  fmt::print("{:<10} mean {:8.3f} ms  p50 {:8.3f} ms  p95 {:8.3f} ms  "
+             "p99 {:8.3f} ms  max {:8.3f} ms\n",
+             label, summary.average * scale * 1000.0,
+             summary.p50 * scale * 1000.0, summary.p95 * scale * 1000.0,
+             summary.p99 * scale * 1000.0, summary.max * scale * 1000.0);
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  try {
+    auto const options{parseOptions(argc, argv)};
+    abcg::OpenGLReplayer replayer{options.path};
+    auto const &info{replayer.getInfo()};
+    if (info.frames == 0) {
+      throw abcg::RuntimeError(
+          fmt::format("{} has no captured frames", options.path));
+    }
+
+    auto *window{createWindow(info)};
+    auto *context{SDL_GL_CreateContext(window)};
+    if (context == nullptr) {
+      throw abcg::SDLError("SDL_GL_CreateContext failed");
+    }
+    SDL_GL_SetSwapInterval(0);
+    if (auto const err{glewInit()}; err != GLEW_OK) {
+      throw abcg::RuntimeError(
+          fmt::format("Failed to initialize OpenGL loader: {}",
+                      reinterpret_cast<char const *>(glewGetErrorString(err))));
+    }
+    fmt::print("OpenGL renderer: {}\n",
+               reinterpret_cast<char const *>(glGetString(GL_RENDERER)));
+    fmt::print("Capture........: {} frames from frame {}, {} setup calls, {} "
+               "frame calls\n",
+               info.frames, info.firstFrame, replayer.getSetupCallCount(),
+               replayer.getFrameCallCount());
+
+    abcg::Timer timer;
+    replayer.replaySetup();
+    glFinish();
+    fmt::print("Setup..........: {:.3f} ms\n", timer.elapsed() * 1000.0);
+
+    abcg::FrameStatistics statistics{
+        static_cast<std::size_t>(options.iterations)};
+    for ([[maybe_unused]] auto const iteration :
+         iter::range(options.iterations)) {
+      timer.restart();
+      replayer.replayFrames();
+      glFinish();
+      statistics.record(timer.elapsed());
+    }
+
+    auto const &summary{statistics.getSummary()};
+    fmt::print("{} iterations:\n", options.iterations);
+    printStatistics("Iteration", summary, 1.0);
+    printStatistics("Frame", summary, 1.0 / info.frames);
+
+    SDL_GL_DeleteContext(context);
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+  } catch (std::exception const &exception) {
+    fmt::print(stderr, "{}\n", exception.what());
+    return -1;
+  }
+  return 0;
+}